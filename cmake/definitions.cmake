@@ -17,4 +17,8 @@ if(GXZN_OS_FS_SYSTEM)
 	list(APPEND GXZN_OS_FS_DEFINITIONS GXZN_OS_FS_${upper_system}=1)
 endif()
 
+if(GXZN_OS_FS_STATISTICS)
+	list(APPEND GXZN_OS_FS_DEFINITIONS GXZN_OS_FS_STATISTICS=1)
+endif()
+
 unset(__me_suffixes)
@@ -8,6 +8,10 @@ if(GXZN_OS_FS_BUILD_TEST)
 	add_subdirectory(${GXZN_OS_FS_TEST_DIR}) # filesystem tests (only if project is not included as subproject)
 endif()
 
+if(GXZN_OS_FS_BUILD_BENCHMARKS)
+	add_subdirectory(${GXZN_OS_FS_BENCH_DIR}) # filesystem benchmarks (only if project is not included as subproject)
+endif()
+
 if(GXZN_OS_FS_GENERATE_DOCS)
 	include(${GXZN_OS_FS_ROOT}/cmake/automatics/docs.cmake)
 endif()
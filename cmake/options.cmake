@@ -15,9 +15,11 @@ endif()
 
 option(GXZN_OS_FS_SHOW_SUBMODULE_INFO  "Show submodule info"         ${GXZN_OS_FS_IS_TOPLEVEL_PROJECT})
 option(GXZN_OS_FS_BUILD_TEST           "Build filesystem's tests"    ${GXZN_OS_FS_IS_TOPLEVEL_PROJECT})
+option(GXZN_OS_FS_BUILD_BENCHMARKS     "Build filesystem's benchmarks" ${GXZN_OS_FS_IS_TOPLEVEL_PROJECT})
 option(GXZN_OS_FS_DEV_MODE             "Developer mode"              ${GXZN_OS_FS_IS_TOPLEVEL_PROJECT})
 option(GXZN_OS_FS_GENERATE_DOCS        "Generate MCSS documentation" ${GXZN_OS_FS_IS_TOPLEVEL_PROJECT})
 option(GXZN_OS_FS_GENERATE_INFO_HEADER "Generate info header"        OFF)
+option(GXZN_OS_FS_STATISTICS           "Collect I/O statistics"      ON)
 mark_as_advanced(GXZN_OS_FS_DEV_MODE GXZN_OS_FS_GENERATE_INFO_HEADER GXZN_OS_FS_GENERATE_DOCS)
 
 include(GetSystemInfo)
@@ -27,6 +29,7 @@ get_system_info(GXZN_OS_FS_SYSTEM GXZN_OS_FS_ARCH)
 set(GXZN_OS_FS_OUT ${CMAKE_BINARY_DIR})
 set(GXZN_OS_FS_CODE_DIR ${GXZN_OS_FS_ROOT}/code/filesystem CACHE PATH "Code directory")
 set(GXZN_OS_FS_TEST_DIR ${GXZN_OS_FS_ROOT}/code/tests      CACHE PATH "Tests directory")
+set(GXZN_OS_FS_BENCH_DIR ${GXZN_OS_FS_ROOT}/code/benchmarks CACHE PATH "Benchmarks directory")
 set(GXZN_OS_FS_DOCS_DIR ${GXZN_OS_FS_ROOT}/docs            CACHE PATH "Documentation directory")
 set(GXZN_OS_FS_DOCS_PROJECT_NAME "📂 golxzn::os::filesystem 📂")
 
@@ -57,9 +60,11 @@ message(STATUS "Root directory:         ${GXZN_OS_FS_ROOT}")
 message(STATUS "Build directory:        ${GXZN_OS_FS_OUT}")
 message(STATUS "Code directory:         ${GXZN_OS_FS_CODE_DIR}")
 message(STATUS "Top level:              ${GXZN_OS_FS_IS_TOPLEVEL_PROJECT}")
+message(STATUS "I/O statistics:         ${GXZN_OS_FS_STATISTICS}")
 
 if(GXZN_OS_FS_DEV_MODE)
 	message(STATUS "Tests:                  ${GXZN_OS_FS_BUILD_TEST}")
+	message(STATUS "Benchmarks:             ${GXZN_OS_FS_BUILD_BENCHMARKS}")
 	message(STATUS "Generate info header:   ${GXZN_OS_FS_GENERATE_INFO_HEADER}")
 	message(STATUS "Generate documentation: ${GXZN_OS_FS_GENERATE_DOCS}")
 	message(STATUS "Documentation directory:${GXZN_OS_FS_DOCS_DIR}")
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <ctime>
+#include <cstdio>
+#include <string>
+#include <cstdint>
+#include <string_view>
+
+namespace golxzn::os::benchmarks {
+
+/** xorshift64* - tiny, fast and stable across the standard libraries unlike std::*_distribution */
+class generator {
+public:
+	explicit generator(const std::uint64_t seed) noexcept : state{ seed != 0 ? seed : 0x9E3779B97F4A7C15ull } {}
+
+	std::uint64_t operator()() noexcept {
+		state ^= state >> 12;
+		state ^= state << 25;
+		state ^= state >> 27;
+		return state * 0x2545F4914F6CDD1Dull;
+	}
+
+private:
+	std::uint64_t state;
+};
+
+/** JSON string of @p text. The control characters are dropped */
+inline std::string quoted(const std::string_view text) {
+	std::string result{ '"' };
+	for (const auto c : text) {
+		if (c == '"' || c == '\\') result += '\\';
+		if (static_cast<unsigned char>(c) < 0x20) continue;
+		result += c;
+	}
+	result += '"';
+	return result;
+}
+
+inline std::string number(const double value) {
+	char buffer[32];
+	std::snprintf(buffer, sizeof(buffer), "%.1f", value);
+	return buffer;
+}
+
+inline std::string utc_time() {
+	const auto now{ std::time(nullptr) };
+	char buffer[32];
+	std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+	return buffer;
+}
+
+/** The first fields of every JSON report: the library, its version, the system and the date */
+inline std::string json_header() {
+#if defined(GXZN_OS_FS_VERSION)
+	static constexpr std::string_view version{ GXZN_OS_FS_VERSION };
+#else
+	static constexpr std::string_view version{ "unknown" };
+#endif // defined(GXZN_OS_FS_VERSION)
+
+#if defined(GXZN_OS_FS_SYSTEM_NAME)
+	static constexpr std::string_view system{ GXZN_OS_FS_SYSTEM_NAME };
+#else
+	static constexpr std::string_view system{ "unknown" };
+#endif // defined(GXZN_OS_FS_SYSTEM_NAME)
+
+	std::string out;
+	out += "\t\"library\": \"golxzn.os.filesystem\",\n";
+	out += "\t\"version\": " + quoted(version) + ",\n";
+	out += "\t\"system\": " + quoted(system) + ",\n";
+	out += "\t\"date\": " + quoted(utc_time()) + ",\n";
+	return out;
+}
+
+} // namespace golxzn::os::benchmarks
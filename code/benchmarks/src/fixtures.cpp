@@ -0,0 +1,89 @@
+#include <cstring>
+
+#include "common.hpp"
+#include "fixtures.hpp"
+
+namespace golxzn::os::benchmarks {
+
+namespace {
+
+using details::data_view;
+
+data_view<byte> prefix(const std::vector<byte> &data, const std::uint64_t size) {
+	return data_view<byte>{ std::begin(data), std::next(std::begin(data), static_cast<std::ptrdiff_t>(size)) };
+}
+
+} // namespace
+
+fixtures::fixtures(const std::uint64_t max_size, const std::uint64_t seed) {
+	static constexpr std::uint64_t sweep[]{
+		64, 4ull << 10, 64ull << 10, 1ull << 20, 16ull << 20, 256ull << 20, 1ull << 30
+	};
+	for (const auto size : sweep) {
+		if (size <= max_size) file_sizes.push_back(size);
+	}
+	if (file_sizes.empty()) file_sizes.push_back(sweep[0]);
+
+	data.resize(static_cast<std::size_t>(file_sizes.back()));
+	generator random{ seed };
+	for (std::size_t position{}; position < data.size(); position += sizeof(std::uint64_t)) {
+		const auto value{ random() };
+		std::memcpy(data.data() + position, &value, std::min(sizeof(value), data.size() - position));
+	}
+}
+
+std::string fixtures::generate() {
+	remove();
+
+	for (const auto size : file_sizes) {
+		if (const auto status{ fs::write_binary(file(size), prefix(data, size)) }; status.has_error()) {
+			return fs::to_narrow(status.message());
+		}
+	}
+
+	const auto tree_content{ prefix(data, tree_file_size) };
+	for (std::size_t i{}; i < wide_count; ++i) {
+		const auto path{ fs::join(wide, L"file_" + std::to_wstring(i) + L".bin") };
+		if (const auto status{ fs::write_binary(path, tree_content) }; status.has_error()) {
+			return fs::to_narrow(status.message());
+		}
+	}
+
+	std::wstring directory{ deep };
+	for (std::size_t i{}; i < deep_count; ++i) {
+		fs::join(directory, L"level_" + std::to_wstring(i));
+		if (const auto status{ fs::write_binary(fs::join(std::wstring_view{ directory }, L"file.bin"), tree_content) }; status.has_error()) {
+			return fs::to_narrow(status.message());
+		}
+	}
+	return {};
+}
+
+void fixtures::remove() const {
+	[[maybe_unused]] const auto status{ fs::remove(root) };
+}
+
+std::wstring fixtures::file(const std::uint64_t size) {
+	return fs::join(root, L"files/" + std::to_wstring(size) + L".bin");
+}
+
+std::wstring fixtures::deepest() {
+	std::wstring directory{ deep };
+	for (std::size_t i{}; i < deep_count; ++i) {
+		fs::join(directory, L"level_" + std::to_wstring(i));
+	}
+	return directory;
+}
+
+std::string fixtures::size_name(const std::uint64_t size) {
+	static constexpr const char *units[]{ "B", "KiB", "MiB", "GiB" };
+	std::size_t unit{};
+	auto value{ size };
+	while (unit + 1 < std::size(units) && value >= 1024 && value % 1024 == 0) {
+		value /= 1024;
+		++unit;
+	}
+	return std::to_string(value) + units[unit];
+}
+
+} // namespace golxzn::os::benchmarks
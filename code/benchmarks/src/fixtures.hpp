@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <golxzn/os/filesystem.hpp>
+
+namespace golxzn::os::benchmarks {
+
+/**
+ * Reproducible benchmark data in `temp://benchmarks`. The same seed and the same maximal size always
+ * give the same files:
+ *   - `files/<size>.bin` - files of the size sweep from 64 B up to the maximal size;
+ *   - `wide/`            - a single directory with golxzn::os::benchmarks::fixtures::wide_count files;
+ *   - `deep/`            - a chain of golxzn::os::benchmarks::fixtures::deep_count nested directories
+ *                          with a file in each of them.
+ */
+class fixtures {
+public:
+	static constexpr std::wstring_view root{ L"temp://benchmarks" };
+	static constexpr std::wstring_view wide{ L"temp://benchmarks/wide" };
+	static constexpr std::wstring_view deep{ L"temp://benchmarks/deep" };
+	static constexpr std::wstring_view scratch{ L"temp://benchmarks/scratch" };
+	static constexpr std::size_t wide_count{ 1024 };
+	static constexpr std::size_t deep_count{ 64 };
+	static constexpr std::size_t tree_file_size{ 64 };
+
+	fixtures(std::uint64_t max_size, std::uint64_t seed);
+
+	/** Writes every fixture. Returns an error message or an empty string */
+	[[nodiscard]] std::string generate();
+
+	/** Removes everything in golxzn::os::benchmarks::fixtures::root */
+	void remove() const;
+
+	[[nodiscard]] const std::vector<std::uint64_t> &sizes() const noexcept { return file_sizes; }
+
+	/** Content of the largest file. The smaller files are its prefixes */
+	[[nodiscard]] const std::vector<byte> &content() const noexcept { return data; }
+
+	[[nodiscard]] static std::wstring file(std::uint64_t size);
+
+	/** The deepest directory of golxzn::os::benchmarks::fixtures::deep */
+	[[nodiscard]] static std::wstring deepest();
+
+	/** Human readable size: 64B, 4KiB, 1GiB */
+	[[nodiscard]] static std::string size_name(std::uint64_t size);
+
+private:
+	std::vector<std::uint64_t> file_sizes;
+	std::vector<byte> data;
+};
+
+} // namespace golxzn::os::benchmarks
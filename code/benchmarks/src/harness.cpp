@@ -0,0 +1,58 @@
+#include <numeric>
+#include <iostream>
+
+#include "common.hpp"
+#include "harness.hpp"
+
+namespace golxzn::os::benchmarks {
+
+result runner::summarize(const std::string &name, const std::string &parameter, const std::uint64_t bytes,
+		std::vector<double> samples) {
+	std::sort(std::begin(samples), std::end(samples));
+
+	result value{ name, parameter, bytes, samples.size() };
+	if (samples.empty()) return value;
+
+	const auto at = [&samples](const double quantile) {
+		return samples[static_cast<std::size_t>(quantile * static_cast<double>(samples.size() - 1))];
+	};
+	value.min = samples.front();
+	value.max = samples.back();
+	value.mean = std::accumulate(std::begin(samples), std::end(samples), 0.0) / static_cast<double>(samples.size());
+	value.median = at(0.5);
+	value.p99 = at(0.99);
+	return value;
+}
+
+void runner::report(const result &value) {
+	std::cerr << value.name << '[' << value.parameter << "]: median " << number(value.median) << " ns, p99 "
+		<< number(value.p99) << " ns (" << value.iterations << " iterations)" << std::endl;
+}
+
+std::string runner::json() const {
+	std::string out{ "{\n" };
+	out += json_header();
+	out += "\t\"options\": { \"max_size\": " + std::to_string(settings.max_size) +
+		", \"seed\": " + std::to_string(settings.seed) +
+		", \"min_iterations\": " + std::to_string(settings.min_iterations) +
+		", \"min_time_ms\": " + std::to_string(settings.min_time.count()) + " },\n";
+	out += "\t\"results\": [";
+
+	for (std::size_t i{}; i < measured.size(); ++i) {
+		const auto &value{ measured[i] };
+		out += i == 0 ? "\n" : ",\n";
+		out += "\t\t{ \"name\": " + quoted(value.name) +
+			", \"parameter\": " + quoted(value.parameter) +
+			", \"bytes\": " + std::to_string(value.bytes) +
+			", \"iterations\": " + std::to_string(value.iterations) +
+			", \"min_ns\": " + number(value.min) +
+			", \"mean_ns\": " + number(value.mean) +
+			", \"median_ns\": " + number(value.median) +
+			", \"p99_ns\": " + number(value.p99) +
+			", \"max_ns\": " + number(value.max) + " }";
+	}
+	out += "\n\t]\n}\n";
+	return out;
+}
+
+} // namespace golxzn::os::benchmarks
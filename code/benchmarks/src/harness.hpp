@@ -0,0 +1,114 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+
+namespace golxzn::os::benchmarks {
+
+/** Settings of the run. See `filesystem_benchmarks --help` */
+struct options {
+	std::uint64_t max_size{ std::uint64_t{ 1 } << 30 }; ///< The largest file of the size sweeps
+	std::uint64_t seed{ 42 };                           ///< Seed of the fixture content
+	std::size_t min_iterations{ 5 };                    ///< Minimal number of the measured iterations
+	std::size_t max_iterations{ 100'000 };              ///< Maximal number of the measured iterations
+	std::chrono::milliseconds min_time{ 200 };          ///< Minimal time to measure each benchmark
+	std::string output;                                 ///< JSON output file. Empty means stdout
+	std::string filter;                                 ///< Run only the benchmarks containing it
+	bool keep_fixtures{ false };                        ///< Don't remove the fixtures at the end
+};
+
+/** Timings of a single benchmark in nanoseconds */
+struct result {
+	std::string name;
+	std::string parameter;
+	std::uint64_t bytes{}; ///< Bytes processed by a single iteration
+	std::size_t iterations{};
+	double min{};
+	double mean{};
+	double median{};
+	double p99{};
+	double max{};
+};
+
+/** Keeps the compiler from optimizing the measured call away */
+template<class T>
+inline void consume(const T &value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "g"(&value) : "memory");
+#else
+	static volatile const void *sink;
+	sink = &value;
+#endif
+}
+
+class runner {
+	using clock = std::chrono::steady_clock;
+
+public:
+	explicit runner(options settings) : settings{ std::move(settings) } {}
+
+	[[nodiscard]] const options &config() const noexcept { return settings; }
+	[[nodiscard]] const std::vector<result> &results() const noexcept { return measured; }
+
+	[[nodiscard]] bool enabled(const std::string &name) const {
+		return settings.filter.empty() || name.find(settings.filter) != std::string::npos;
+	}
+
+	/**
+	 * Calls @p body until both the minimal number of iterations and the minimal time are reached.
+	 * @p setup runs before every iteration and isn't measured. A single warm up iteration isn't
+	 * measured either.
+	 */
+	template<class Setup, class Body>
+	void run(const std::string &name, const std::string &parameter, const std::uint64_t bytes,
+			Setup &&setup, Body &&body) {
+		if (!enabled(name)) return;
+
+		setup();
+		call(body);
+
+		std::vector<double> samples;
+		const auto started{ clock::now() };
+		while (samples.size() < settings.max_iterations &&
+				(samples.size() < settings.min_iterations || clock::now() - started < settings.min_time)) {
+			setup();
+			const auto begin{ clock::now() };
+			call(body);
+			samples.push_back(std::chrono::duration<double, std::nano>(clock::now() - begin).count());
+		}
+		measured.push_back(summarize(name, parameter, bytes, std::move(samples)));
+		report(measured.back());
+	}
+
+	template<class Body>
+	void run(const std::string &name, const std::string &parameter, const std::uint64_t bytes, Body &&body) {
+		run(name, parameter, bytes, [] {}, std::forward<Body>(body));
+	}
+
+	/** The results as a JSON document */
+	[[nodiscard]] std::string json() const;
+
+private:
+	options settings;
+	std::vector<result> measured;
+
+	template<class Body>
+	static void call(Body &body) {
+		if constexpr (std::is_void_v<std::invoke_result_t<Body &>>) {
+			body();
+		} else {
+			const auto value{ body() };
+			consume(value);
+		}
+	}
+
+	static result summarize(const std::string &name, const std::string &parameter, std::uint64_t bytes,
+		std::vector<double> samples);
+	static void report(const result &value);
+};
+
+} // namespace golxzn::os::benchmarks
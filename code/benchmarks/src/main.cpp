@@ -0,0 +1,290 @@
+#include <array>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+
+#include <golxzn/os/filesystem.hpp>
+
+#include "harness.hpp"
+#include "fixtures.hpp"
+
+namespace {
+
+using namespace golxzn::os;
+using benchmarks::fixtures;
+
+constexpr std::string_view usage{
+R"(Usage: filesystem_benchmarks [options]
+
+Options:
+  --max-size <size>        The largest file of the size sweeps (64B..1G). Default: 1G
+  --seed <number>          Seed of the fixture content. Default: 42
+  --min-iterations <count> Minimal number of the iterations per benchmark. Default: 5
+  --min-time <ms>          Minimal time per benchmark in milliseconds. Default: 200
+  --filter <text>          Run only the benchmarks with <text> in the name
+  --output <file>          Write JSON results to the file instead of stdout
+  --keep-fixtures          Don't remove temp://benchmarks at the end
+  --help                   Show this message
+)" };
+
+/** Parses `64`, `4K`, `16M` or `1G` */
+std::uint64_t parse_size(const std::string &text) {
+	std::size_t end{};
+	auto value{ std::stoull(text, &end) };
+	if (end < text.size()) {
+		switch (text[end]) {
+			case 'k': case 'K': value <<= 10; break;
+			case 'm': case 'M': value <<= 20; break;
+			case 'g': case 'G': value <<= 30; break;
+			default: throw std::invalid_argument{ "Unknown size suffix: " + text };
+		}
+	}
+	return value;
+}
+
+bool parse(const int argc, char **argv, benchmarks::options &settings) {
+	for (int i{ 1 }; i < argc; ++i) {
+		const std::string_view argument{ argv[i] };
+		const auto next = [&]() -> std::string {
+			if (i + 1 >= argc) throw std::invalid_argument{ "Missing value of " + std::string{ argument } };
+			return argv[++i];
+		};
+
+		if (argument == "--max-size") settings.max_size = parse_size(next());
+		else if (argument == "--seed") settings.seed = std::stoull(next());
+		else if (argument == "--min-iterations") settings.min_iterations = std::stoull(next());
+		else if (argument == "--min-time") settings.min_time = std::chrono::milliseconds{ std::stoll(next()) };
+		else if (argument == "--filter") settings.filter = next();
+		else if (argument == "--output") settings.output = next();
+		else if (argument == "--keep-fixtures") settings.keep_fixtures = true;
+		else if (argument == "--help") return false;
+		else throw std::invalid_argument{ "Unknown option: " + std::string{ argument } };
+	}
+	return true;
+}
+
+void read_write(benchmarks::runner &runner, const fixtures &data) {
+	for (const auto size : data.sizes()) {
+		const auto path{ fixtures::file(size) };
+		const auto name{ fixtures::size_name(size) };
+
+		runner.run("read_binary", name, size, [&path] { return fs::read_binary(path).size(); });
+		runner.run("read_text", name, size, [&path] { return fs::read_text(path).size(); });
+
+		const auto target{ fs::join(fixtures::scratch, L"write.bin") };
+		const details::data_view<byte> content{
+			std::begin(data.content()), std::next(std::begin(data.content()), static_cast<std::ptrdiff_t>(size))
+		};
+		runner.run("write_binary", name, size, [&target, &content] {
+			return fs::write_binary(target, content).has_error();
+		});
+
+		// Header, index and payload kept apart, as a serializer produces them
+		const auto third{ size / 3 };
+		const details::data_view<byte> header{ content.data(), third };
+		const details::data_view<byte> index{ content.data() + third, third };
+		const details::data_view<byte> payload{ content.data() + 2 * third, size - 2 * third };
+		runner.run("write_binary_concatenated", name, size, [&target, &header, &index, &payload] {
+			std::vector<byte> joined;
+			joined.reserve(header.size() + index.size() + payload.size());
+			for (const auto &piece : { header, index, payload }) {
+				joined.insert(std::end(joined), std::begin(piece), std::end(piece));
+			}
+			return fs::write_binary(target, joined).has_error();
+		});
+		runner.run("write_binary_gathered", name, size, [&target, &header, &index, &payload] {
+			return fs::write_binary(target, { header, index, payload }).has_error();
+		});
+
+		// A save file rewritten with a single byte changed, as most of the autosaves are
+		std::vector<byte> edited{ std::begin(content), std::end(content) };
+		edited[size / 2] = static_cast<byte>(~edited[size / 2]);
+		bool toggle{};
+		runner.run("write_delta", name, size, [&target, &content, &edited, &toggle] {
+			toggle = !toggle;
+			return fs::write_delta(target, toggle ? details::data_view<byte>{ edited } : content).has_error();
+		});
+	}
+
+	for (const std::size_t size : { 64, 4096 }) {
+		const std::string line(size - 1, 'a');
+		const auto target{ fs::join(fixtures::scratch, L"append.txt") };
+		runner.run("append_text", fixtures::size_name(size), size,
+			[&target] { [[maybe_unused]] const auto status{ fs::remove_file(target) }; },
+			[&target, &line] {
+				for (int i{}; i < 16; ++i) {
+					if (fs::append_text(target, std::string_view{ line + '\n' }).has_error()) return false;
+				}
+				return true;
+			}
+		);
+
+		// The same appends as seen by the caller, while the worker writes them in background
+		runner.run("append_text_write_behind", fixtures::size_name(size), size,
+			[&target] {
+				fs::enable_write_behind();
+				[[maybe_unused]] const auto drained{ fs::drain() };
+				[[maybe_unused]] const auto status{ fs::remove_file(target) };
+			},
+			[&target, &line] {
+				for (int i{}; i < 16; ++i) {
+					if (fs::append_text(target, std::string_view{ line + '\n' }).has_error()) return false;
+				}
+				return true;
+			}
+		);
+		[[maybe_unused]] const auto status{ fs::disable_write_behind() };
+
+		// One positional write per append into the preallocated segment
+		const auto segments{ fs::join(fixtures::scratch, L"segments/append.log") };
+		fs::segment_writer writer;
+		runner.run("append_segment", fixtures::size_name(size), size,
+			[&writer, &segments] {
+				writer = fs::segment_writer{};
+				[[maybe_unused]] const auto removed{ fs::remove_directory(fs::parent_directory(segments)) };
+				writer = fs::segment_writer{ segments };
+				[[maybe_unused]] const auto opened{ writer.append_text(std::string_view{ "\n" }) };
+			},
+			[&writer, &line] {
+				for (int i{}; i < 16; ++i) {
+					if (writer.append_text(std::string_view{ line + '\n' }).has_error()) return false;
+				}
+				return true;
+			}
+		);
+		writer = fs::segment_writer{};
+	}
+}
+
+void paths(benchmarks::runner &runner) {
+	static constexpr std::wstring_view normal{ L"/home/user/.config/application/saves/slot_1.bin" };
+	static constexpr std::wstring_view messy{ L"C:\\Users\\user\\\\AppData/./Roaming/../Roaming/application//saves/./slot_1.bin " };
+
+	runner.run("normalize", "normalized", 0, [] { return fs::normalize(normal); });
+	runner.run("normalize", "messy", 0, [] { return fs::normalize(messy); });
+
+	std::wstring path;
+	runner.run("normalize_in_place", "messy", 0, [&path] { path = messy; }, [&path] {
+		fs::normalize(path);
+		return path.size();
+	});
+	std::array<wchar_t, 256> buffer{};
+	runner.run("normalize_to_buffer", "normalized", 0, [&buffer] {
+		return fs::normalize(normal, buffer.data(), buffer.size());
+	});
+	runner.run("normalize_to_buffer", "messy", 0, [&buffer] {
+		return fs::normalize(messy, buffer.data(), buffer.size());
+	});
+	runner.run("join", "short", 0, [] { return fs::join(std::wstring_view{ L"res://" }, L"test.bin"); });
+	runner.run("join", "long", 0, [] { return fs::join(normal, L"/textures/characters/hero/diffuse.png"); });
+	runner.run("replace_association_prefix", "res", 0, [] { return fs::resolve(L"res://textures/hero.png"); });
+	runner.run("replace_association_prefix", "user", 0, [] { return fs::resolve(L"user://saves/../saves/slot.bin"); });
+
+	// The same operations through fs::path_buffer, which stays in its inline storage
+	fs::path_buffer inline_path;
+	runner.run("normalize_path_buffer", "messy", 0, [&inline_path] { inline_path = messy; }, [&inline_path] {
+		fs::normalize(inline_path);
+		return inline_path.size();
+	});
+	runner.run("join_path_buffer", "long", 0, [&inline_path] { inline_path = normal; }, [&inline_path] {
+		fs::join(inline_path, L"/textures/characters/hero/diffuse.png");
+		return inline_path.size();
+	});
+	runner.run("resolve_path_buffer", "res", 0, [&inline_path] {
+		fs::resolve(L"res://textures/hero.png", inline_path);
+		return inline_path.size();
+	});
+	runner.run("resolve_path_buffer", "user", 0, [&inline_path] {
+		fs::resolve(L"user://saves/../saves/slot.bin", inline_path);
+		return inline_path.size();
+	});
+
+	// Checked at compile time, so only the protocol is replaced
+	static constexpr fs::literal_path literal{ L"user://saves/../saves/slot.bin" };
+	runner.run("resolve_literal_path", "user", 0, [&inline_path] {
+		fs::resolve(literal, inline_path);
+		return inline_path.size();
+	});
+}
+
+void directories(benchmarks::runner &runner) {
+	runner.run("entries", "wide", fixtures::wide_count, [] { return fs::entries(fixtures::wide).size(); });
+	runner.run("entries", "deep", 1, [] { return fs::entries(fixtures::deep).size(); });
+
+	// Optional override files, most of which don't exist
+	const auto missing{ fs::join(fixtures::scratch, L"overrides/hero.png") };
+	runner.run("exists", "missing", 0, [&missing] { return fs::exists(missing); });
+	fs::enable_metadata_cache();
+	runner.run("exists_cached", "missing", 0, [&missing] { return fs::exists(missing); });
+	fs::disable_metadata_cache();
+
+	const auto deepest{ fixtures::deepest() };
+	runner.run("make_directory", "existing", 0, [&deepest] { return fs::make_directory(deepest).has_error(); });
+
+	std::size_t created{};
+	std::wstring fresh;
+	runner.run("make_directory", "new/4", 0,
+		[&created, &fresh] {
+			fresh = fs::join(fixtures::scratch, L"mkdir/" + std::to_wstring(created++) + L"/a/b/c");
+		},
+		[&fresh] { return fs::make_directory(fresh).has_error(); }
+	);
+
+	const auto removed{ fs::join(fixtures::scratch, L"removed") };
+	const auto remove_tree = [&runner, &removed](const std::string &parameter, const std::wstring_view tree,
+			const std::uint64_t count) {
+		runner.run("remove_directory", parameter, count,
+			[&removed, tree] { [[maybe_unused]] const auto status{ fs::copy_directory(tree, removed) }; },
+			[&removed] { return fs::remove_directory(removed).has_error(); }
+		);
+	};
+	remove_tree("wide", fixtures::wide, fixtures::wide_count);
+	remove_tree("deep", fixtures::deep, fixtures::deep_count);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	benchmarks::options settings;
+	try {
+		if (!parse(argc, argv, settings)) {
+			std::cout << usage;
+			return 0;
+		}
+	} catch (const std::exception &ex) {
+		std::cerr << ex.what() << '\n' << usage;
+		return 1;
+	}
+
+	if (const auto status{ fs::initialize(L"filesystem_benchmarks") }; status.has_error()) {
+		std::cerr << "Failed to initialize: " << fs::to_narrow(status.message()) << '\n';
+		return 1;
+	}
+
+	std::cerr << "Generating fixtures up to " << fixtures::size_name(settings.max_size) << "..." << std::endl;
+	fixtures data{ settings.max_size, settings.seed };
+	if (const auto error{ data.generate() }; !error.empty()) {
+		std::cerr << "Failed to generate fixtures: " << error << '\n';
+		data.remove();
+		return 1;
+	}
+
+	benchmarks::runner runner{ settings };
+	read_write(runner, data);
+	paths(runner);
+	directories(runner);
+
+	if (!settings.keep_fixtures) data.remove();
+
+	if (settings.output.empty()) {
+		std::cout << runner.json();
+	} else if (std::ofstream file{ settings.output }; file.is_open()) {
+		file << runner.json();
+	} else {
+		std::cerr << "Failed to open " << settings.output << '\n';
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,162 @@
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+
+#include <golxzn/os/filesystem.hpp>
+
+#include "common.hpp"
+#include "workload.hpp"
+
+namespace {
+
+using namespace golxzn::os;
+using benchmarks::number;
+using benchmarks::quoted;
+
+constexpr std::string_view usage{
+R"(Usage: filesystem_stress [options]
+
+Runs a mixed read/write/list/remove workload on temp://stress from 1, 2, 4, ... up to N threads
+and reports throughput and tail latency of each thread count.
+
+Options:
+  --threads <count>        The largest thread count. Default: hardware concurrency
+  --duration <ms>          Duration of each thread count in milliseconds. Default: 2000
+  --files <count>          Number of files in the shared working set. Default: 256
+  --file-size <bytes>      Size of each file. Default: 4096
+  --mix <r,w,l,d>          Weights of read, write, list and remove. Default: 70,15,10,5
+  --seed <number>          Seed of the workers' random choices. Default: 42
+  --output <file>          Write JSON results to the file instead of stdout
+  --keep-files             Don't remove temp://stress at the end
+  --help                   Show this message
+)" };
+
+std::array<std::uint32_t, stress::operation_names.size()> parse_mix(const std::string &text) {
+	std::array<std::uint32_t, stress::operation_names.size()> mix{};
+	std::size_t position{};
+	for (auto &weight : mix) {
+		std::size_t end{};
+		weight = static_cast<std::uint32_t>(std::stoul(text.substr(position), &end));
+		position += end;
+		if (position < text.size() && text[position] == ',') ++position;
+	}
+	if (position != text.size()) throw std::invalid_argument{ "Invalid mix: " + text };
+	return mix;
+}
+
+bool parse(const int argc, char **argv, stress::options &settings) {
+	for (int i{ 1 }; i < argc; ++i) {
+		const std::string_view argument{ argv[i] };
+		const auto next = [&]() -> std::string {
+			if (i + 1 >= argc) throw std::invalid_argument{ "Missing value of " + std::string{ argument } };
+			return argv[++i];
+		};
+
+		if (argument == "--threads") settings.max_threads = std::stoull(next());
+		else if (argument == "--duration") settings.duration = std::chrono::milliseconds{ std::stoll(next()) };
+		else if (argument == "--files") settings.files = std::max<std::size_t>(1, std::stoull(next()));
+		else if (argument == "--file-size") settings.file_size = std::stoull(next());
+		else if (argument == "--mix") settings.mix = parse_mix(next());
+		else if (argument == "--seed") settings.seed = std::stoull(next());
+		else if (argument == "--output") settings.output = next();
+		else if (argument == "--keep-files") settings.keep_files = true;
+		else if (argument == "--help") return false;
+		else throw std::invalid_argument{ "Unknown option: " + std::string{ argument } };
+	}
+	return true;
+}
+
+void report(const stress::step_result &step) {
+	std::cerr << step.threads << " thread(s): " << number(step.throughput()) << " ops/s" << std::endl;
+	for (std::size_t kind{}; kind < stress::operation_names.size(); ++kind) {
+		const auto &value{ step.per_operation[kind] };
+		if (value.count == 0) continue;
+		std::cerr << "  " << stress::operation_names[kind] << ": " << value.count << " calls, "
+			<< value.failed << " failed, p50 " << number(value.p50) << " ns, p99 " << number(value.p99)
+			<< " ns, p99.9 " << number(value.p999) << " ns, max " << number(value.max) << " ns" << std::endl;
+	}
+}
+
+std::string json(const stress::options &settings, const std::vector<stress::step_result> &steps) {
+	std::string out{ "{\n" };
+	out += benchmarks::json_header();
+	out += "\t\"options\": { \"duration_ms\": " + std::to_string(settings.duration.count()) +
+		", \"files\": " + std::to_string(settings.files) +
+		", \"file_size\": " + std::to_string(settings.file_size) +
+		", \"seed\": " + std::to_string(settings.seed) + ", \"mix\": {";
+	for (std::size_t kind{}; kind < stress::operation_names.size(); ++kind) {
+		out += (kind == 0 ? " " : ", ") + quoted(stress::operation_names[kind]) + ": " +
+			std::to_string(settings.mix[kind]);
+	}
+	out += " } },\n";
+	out += "\t\"steps\": [";
+
+	for (std::size_t i{}; i < steps.size(); ++i) {
+		const auto &step{ steps[i] };
+		out += i == 0 ? "\n" : ",\n";
+		out += "\t\t{ \"threads\": " + std::to_string(step.threads) +
+			", \"seconds\": " + number(step.seconds) +
+			", \"operations\": " + std::to_string(step.operations) +
+			", \"throughput_ops\": " + number(step.throughput()) + ", \"per_operation\": {";
+		for (std::size_t kind{}; kind < stress::operation_names.size(); ++kind) {
+			const auto &value{ step.per_operation[kind] };
+			out += (kind == 0 ? "\n" : ",\n");
+			out += "\t\t\t" + quoted(stress::operation_names[kind]) + ": { \"count\": " +
+				std::to_string(value.count) +
+				", \"failed\": " + std::to_string(value.failed) +
+				", \"p50_ns\": " + number(value.p50) +
+				", \"p99_ns\": " + number(value.p99) +
+				", \"p999_ns\": " + number(value.p999) +
+				", \"max_ns\": " + number(value.max) + " }";
+		}
+		out += "\n\t\t} }";
+	}
+	out += "\n\t]\n}\n";
+	return out;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	stress::options settings;
+	try {
+		if (!parse(argc, argv, settings)) {
+			std::cout << usage;
+			return 0;
+		}
+	} catch (const std::exception &ex) {
+		std::cerr << ex.what() << '\n' << usage;
+		return 1;
+	}
+
+	if (const auto status{ fs::initialize(L"filesystem_stress") }; status.has_error()) {
+		std::cerr << "Failed to initialize: " << fs::to_narrow(status.message()) << '\n';
+		return 1;
+	}
+
+	stress::workload workload{ settings };
+	std::vector<stress::step_result> steps;
+	for (const auto threads : workload.thread_counts()) {
+		// Every step starts from the full working set, since the removes of the previous one drain it
+		if (const auto error{ workload.prepare() }; !error.empty()) {
+			std::cerr << "Failed to prepare the working set: " << error << '\n';
+			workload.remove();
+			return 1;
+		}
+		steps.push_back(workload.run(threads));
+		report(steps.back());
+	}
+
+	if (!settings.keep_files) workload.remove();
+
+	if (settings.output.empty()) {
+		std::cout << json(settings, steps);
+	} else if (std::ofstream file{ settings.output }; file.is_open()) {
+		file << json(settings, steps);
+	} else {
+		std::cerr << "Failed to open " << settings.output << '\n';
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,144 @@
+#include <atomic>
+#include <thread>
+#include <numeric>
+#include <algorithm>
+
+#include "common.hpp"
+#include "workload.hpp"
+
+namespace golxzn::os::stress {
+
+namespace {
+
+using clock = std::chrono::steady_clock;
+using benchmarks::generator; // Each worker owns one, so picking the next operation never contends
+constexpr auto operations_count{ static_cast<std::size_t>(operation::count) };
+
+/** Per worker samples. Merged only after the step, so the measurement itself doesn't contend */
+struct worker_samples {
+	std::array<std::vector<std::uint64_t>, operations_count> latency;
+	std::array<std::uint64_t, operations_count> failed{};
+};
+
+operation_result summarize(std::vector<std::uint64_t> &samples, const std::uint64_t failed) {
+	operation_result result{ samples.size(), failed };
+	if (samples.empty()) return result;
+
+	std::sort(std::begin(samples), std::end(samples));
+	const auto at = [&samples](const double quantile) {
+		return static_cast<double>(samples[static_cast<std::size_t>(quantile * static_cast<double>(samples.size() - 1))]);
+	};
+	result.p50 = at(0.5);
+	result.p99 = at(0.99);
+	result.p999 = at(0.999);
+	result.max = static_cast<double>(samples.back());
+	return result;
+}
+
+} // namespace
+
+workload::workload(options settings) : settings{ std::move(settings) } {
+	paths.reserve(this->settings.files);
+	for (std::size_t i{}; i < this->settings.files; ++i) {
+		paths.emplace_back(fs::join(root, L"shared/file_" + std::to_wstring(i) + L".bin"));
+	}
+
+	content.resize(this->settings.file_size);
+	generator random{ this->settings.seed };
+	std::generate(std::begin(content), std::end(content), [&random] { return static_cast<byte>(random()); });
+}
+
+std::string workload::prepare() {
+	remove();
+	for (const auto &path : paths) {
+		if (const auto status{ fs::write_binary(path, content) }; status.has_error()) {
+			return fs::to_narrow(status.message());
+		}
+	}
+	return {};
+}
+
+void workload::remove() const {
+	[[maybe_unused]] const auto status{ fs::remove(root) };
+}
+
+std::vector<std::size_t> workload::thread_counts() const {
+	auto max_threads{ settings.max_threads };
+	if (max_threads == 0) max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+	std::vector<std::size_t> counts;
+	for (std::size_t threads{ 1 }; threads < max_threads; threads *= 2) {
+		counts.push_back(threads);
+	}
+	counts.push_back(max_threads);
+	return counts;
+}
+
+step_result workload::run(const std::size_t threads) {
+	const auto total_weight{ std::accumulate(std::begin(settings.mix), std::end(settings.mix), std::uint64_t{}) };
+	const auto shared_directory{ fs::join(root, L"shared") };
+
+	std::vector<worker_samples> samples(threads);
+	std::atomic_size_t ready{};
+	std::atomic_bool started{ false };
+	std::atomic_bool stopped{ false };
+
+	const auto worker = [&](const std::size_t index) {
+		auto &local{ samples[index] };
+		generator random{ settings.seed + index + 1 };
+		for (auto &latency : local.latency) latency.reserve(1 << 16);
+
+		ready.fetch_add(1, std::memory_order_release);
+		while (!started.load(std::memory_order_acquire)) std::this_thread::yield();
+
+		while (!stopped.load(std::memory_order_relaxed)) {
+			auto choice{ total_weight != 0 ? random() % total_weight : 0 };
+			std::size_t kind{};
+			while (kind + 1 < operations_count && choice >= settings.mix[kind]) {
+				choice -= settings.mix[kind++];
+			}
+			const auto &path{ paths[random() % paths.size()] };
+
+			bool failed{ false };
+			const auto begin{ clock::now() };
+			switch (static_cast<operation>(kind)) {
+				case operation::read: failed = fs::read_binary(path).empty(); break;
+				case operation::write: failed = fs::write_binary(path, content).has_error(); break;
+				case operation::list: failed = fs::entries(shared_directory).empty(); break;
+				case operation::remove: failed = fs::remove_file(path).has_error(); break;
+				default: break;
+			}
+			const auto elapsed{ std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - begin) };
+
+			local.latency[kind].push_back(static_cast<std::uint64_t>(elapsed.count()));
+			local.failed[kind] += failed ? 1 : 0;
+		}
+	};
+
+	std::vector<std::thread> workers;
+	workers.reserve(threads);
+	for (std::size_t i{}; i < threads; ++i) workers.emplace_back(worker, i);
+	while (ready.load(std::memory_order_acquire) < threads) std::this_thread::yield();
+
+	const auto begin{ clock::now() };
+	started.store(true, std::memory_order_release);
+	std::this_thread::sleep_for(settings.duration);
+	stopped.store(true, std::memory_order_relaxed);
+	for (auto &thread : workers) thread.join();
+	const auto seconds{ std::chrono::duration<double>(clock::now() - begin).count() };
+
+	step_result result{ threads, seconds };
+	for (std::size_t kind{}; kind < operations_count; ++kind) {
+		std::vector<std::uint64_t> merged;
+		std::uint64_t failed{};
+		for (auto &local : samples) {
+			merged.insert(std::end(merged), std::begin(local.latency[kind]), std::end(local.latency[kind]));
+			failed += local.failed[kind];
+		}
+		result.per_operation[kind] = summarize(merged, failed);
+		result.operations += result.per_operation[kind].count;
+	}
+	return result;
+}
+
+} // namespace golxzn::os::stress
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <golxzn/os/filesystem.hpp>
+
+namespace golxzn::os::stress {
+
+enum class operation : std::uint8_t { read, write, list, remove, count };
+
+inline constexpr std::array<std::string_view, static_cast<std::size_t>(operation::count)> operation_names{
+	"read", "write", "list", "remove"
+};
+
+/** Settings of the run. See `filesystem_stress --help` */
+struct options {
+	std::size_t max_threads{ 0 };               ///< The largest thread count. 0 means std::thread::hardware_concurrency
+	std::chrono::milliseconds duration{ 2000 }; ///< Duration of each thread count step
+	std::size_t files{ 256 };                   ///< Number of files in the shared working set
+	std::size_t file_size{ 4096 };              ///< Size of each file of the working set
+	std::array<std::uint32_t, static_cast<std::size_t>(operation::count)> mix{ 70, 15, 10, 5 }; ///< Weights
+	std::uint64_t seed{ 42 };                   ///< Seed of the workers' random choices
+	std::string output;                         ///< JSON output file. Empty means stdout
+	bool keep_files{ false };                   ///< Don't remove the working set at the end
+};
+
+/** Latency distribution of a single operation in nanoseconds */
+struct operation_result {
+	std::uint64_t count{};
+	std::uint64_t failed{}; ///< Failed calls. Races between remove and the others are expected here
+	double p50{};
+	double p99{};
+	double p999{};
+	double max{};
+};
+
+/** Result of a single thread count step */
+struct step_result {
+	std::size_t threads{};
+	double seconds{};
+	std::uint64_t operations{};
+	std::array<operation_result, static_cast<std::size_t>(operation::count)> per_operation{};
+
+	[[nodiscard]] double throughput() const noexcept {
+		return seconds > 0.0 ? static_cast<double>(operations) / seconds : 0.0;
+	}
+};
+
+/**
+ * Shared working set in `temp://stress` hammered by a number of threads. Every worker picks the
+ * operation by the weights of golxzn::os::stress::options::mix and a random file of the working set,
+ * so the threads contend on the same files and on the library's shared state (associations etc.).
+ */
+class workload {
+public:
+	static constexpr std::wstring_view root{ L"temp://stress" };
+
+	explicit workload(options settings);
+
+	/** Writes every file of the working set. Returns an error message or an empty string */
+	[[nodiscard]] std::string prepare();
+
+	/** Removes everything in golxzn::os::stress::workload::root */
+	void remove() const;
+
+	/** Runs every worker for golxzn::os::stress::options::duration */
+	[[nodiscard]] step_result run(std::size_t threads);
+
+	[[nodiscard]] const options &config() const noexcept { return settings; }
+
+	/** Thread counts of the scaling curve: powers of two up to the maximum and the maximum itself */
+	[[nodiscard]] std::vector<std::size_t> thread_counts() const;
+
+private:
+	options settings;
+	std::vector<std::wstring> paths;
+	std::vector<byte> content;
+};
+
+} // namespace golxzn::os::stress
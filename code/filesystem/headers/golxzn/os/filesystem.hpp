@@ -13,11 +13,26 @@
 #endif // !defined(GOLXZN_OS_FILESYSTEM)
 
 #include <span>
+#include <array>
+#include <mutex>
+#include <chrono>
 #include <string>
+#include <vector>
+#include <future>
 #include <memory>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
 #include <string_view>
 #include <unordered_map>
 
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#define GXZN_OS_FS_PMR
+#endif // __has_include(<memory_resource>)
+
 #if defined(GOLXZN_OS_ALIASES)
 #include <golxzn/os/aliases.hpp>
 #endif // defined(GOLXZN_OS_ALIASES)
@@ -27,6 +42,8 @@ namespace golxzn::os {
 #if !defined(GOLXZN_OS_ALIASES)
 
 using u16 = uint16_t;
+using u32 = uint32_t;
+using u64 = uint64_t;
 using byte = std::byte;
 using usize = std::size_t;
 
@@ -40,8 +57,14 @@ public:
 	using value_type = T;
 	using const_pointer = const T *;
 
+	constexpr data_view() noexcept = default;
+
+	constexpr data_view(const_pointer data, const usize length) noexcept
+		: m_data{ data }, m_length{ length } {}
+
 	template<class Iterator>
-	constexpr data_view(Iterator begin, Iterator end) noexcept : m_data{ &*begin }, m_length{ end - begin } {}
+	constexpr data_view(Iterator begin, Iterator end) noexcept
+		: m_data{ &*begin }, m_length{ static_cast<usize>(std::distance(begin, end)) } {}
 
 	template<class Container>
 	constexpr data_view(const Container &container) noexcept
@@ -58,8 +81,492 @@ private:
 	const usize m_length{};
 };
 
+/**
+ * @brief Null terminated path with the inline storage
+ * @details Keeps up to `Capacity - 1` characters inside of the object and spills to the heap only
+ * for longer paths, so resolving a usual path and passing it to the system doesn't allocate.
+ */
+template<class Char, usize Capacity = 256>
+class basic_path_buffer {
+public:
+	static_assert(Capacity > 1, "The inline storage has to fit at least one character and the terminator");
+
+	using value_type = Char;
+	using traits_type = std::char_traits<Char>;
+	using view_type = std::basic_string_view<Char>;
+	using string_type = std::basic_string<Char>;
+
+	static constexpr usize inline_capacity{ Capacity - 1 }; ///< Characters that fit without allocation
+	static constexpr usize npos{ view_type::npos };
+
+	basic_path_buffer() noexcept = default;
+	basic_path_buffer(const view_type path) { assign(path); }
+	basic_path_buffer(const Char *path) { assign(view_type{ path }); }
+	basic_path_buffer(const basic_path_buffer &other) { assign(other.view()); }
+	basic_path_buffer(basic_path_buffer &&other) noexcept { take(other); }
+
+	basic_path_buffer &operator=(const basic_path_buffer &other) {
+		if (this != &other) assign(other.view());
+		return *this;
+	}
+	basic_path_buffer &operator=(basic_path_buffer &&other) noexcept {
+		if (this != &other) take(other);
+		return *this;
+	}
+	basic_path_buffer &operator=(const view_type path) { return assign(path); }
+
+	[[nodiscard]] Char *data() noexcept { return m_heap ? m_heap.get() : m_inline; }
+	[[nodiscard]] const Char *data() const noexcept { return m_heap ? m_heap.get() : m_inline; }
+	[[nodiscard]] const Char *c_str() const noexcept { return data(); }
+	[[nodiscard]] usize size() const noexcept { return m_size; }
+	[[nodiscard]] usize length() const noexcept { return m_size; }
+	[[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+	/** @brief Characters that fit without a reallocation */
+	[[nodiscard]] usize capacity() const noexcept { return m_heap ? m_heap_capacity - 1 : inline_capacity; }
+	/** @brief Whether the path is still in the inline storage */
+	[[nodiscard]] bool is_inline() const noexcept { return m_heap == nullptr; }
+
+	[[nodiscard]] view_type view() const noexcept { return view_type{ data(), m_size }; }
+	[[nodiscard]] operator view_type() const noexcept { return view(); }
+	[[nodiscard]] string_type str() const { return string_type{ view() }; }
+
+	[[nodiscard]] Char *begin() noexcept { return data(); }
+	[[nodiscard]] Char *end() noexcept { return data() + m_size; }
+	[[nodiscard]] const Char *begin() const noexcept { return data(); }
+	[[nodiscard]] const Char *end() const noexcept { return data() + m_size; }
+
+	[[nodiscard]] Char &operator[](const usize index) noexcept { return data()[index]; }
+	[[nodiscard]] Char operator[](const usize index) const noexcept { return data()[index]; }
+	[[nodiscard]] Char &front() noexcept { return data()[0]; }
+	[[nodiscard]] Char front() const noexcept { return data()[0]; }
+	[[nodiscard]] Char &back() noexcept { return data()[m_size - 1]; }
+	[[nodiscard]] Char back() const noexcept { return data()[m_size - 1]; }
+
+	void clear() noexcept { set_size(0); }
+
+	void reserve(const usize length) {
+		if (length <= capacity()) [[likely]] return;
+
+		const auto new_capacity{ std::max(length + 1, m_heap_capacity * 2) };
+		auto heap{ std::make_unique<Char[]>(new_capacity) };
+		traits_type::copy(heap.get(), data(), m_size + 1);
+		m_heap = std::move(heap);
+		m_heap_capacity = new_capacity;
+	}
+
+	void resize(const usize length, const Char c = Char{}) {
+		if (length > m_size) {
+			reserve(length);
+			traits_type::assign(data() + m_size, length - m_size, c);
+		}
+		set_size(length);
+	}
+
+	basic_path_buffer &assign(const view_type path) {
+		if (path.size() > capacity()) [[unlikely]] {
+			m_heap.reset();
+			m_heap_capacity = 0;
+			reserve(path.size());
+		}
+		traits_type::move(data(), path.data(), path.size());
+		set_size(path.size());
+		return *this;
+	}
+
+	basic_path_buffer &append(const view_type path) {
+		reserve(m_size + path.size());
+		traits_type::copy(data() + m_size, path.data(), path.size());
+		set_size(m_size + path.size());
+		return *this;
+	}
+
+	basic_path_buffer &insert(const usize position, const usize count, const Char c) {
+		reserve(m_size + count);
+		auto *const at{ data() + position };
+		traits_type::move(at + count, at, m_size - position);
+		traits_type::assign(at, count, c);
+		set_size(m_size + count);
+		return *this;
+	}
+
+	void push_back(const Char c) {
+		reserve(m_size + 1);
+		data()[m_size] = c;
+		set_size(m_size + 1);
+	}
+
+	void pop_back() noexcept { set_size(m_size - 1); }
+
+	basic_path_buffer &operator+=(const view_type path) { return append(path); }
+	basic_path_buffer &operator+=(const Char c) { push_back(c); return *this; }
+
+	[[nodiscard]] usize find_last_of(const view_type characters, const usize position = npos) const noexcept {
+		return view().find_last_of(characters, position);
+	}
+	[[nodiscard]] usize rfind(const Char c, const usize position = npos) const noexcept {
+		return view().rfind(c, position);
+	}
+
+	[[nodiscard]] friend bool operator==(const basic_path_buffer &left, const view_type right) noexcept {
+		return left.view() == right;
+	}
+	[[nodiscard]] friend bool operator!=(const basic_path_buffer &left, const view_type right) noexcept {
+		return !(left == right);
+	}
+
+private:
+	std::unique_ptr<Char[]> m_heap;
+	usize m_heap_capacity{};
+	usize m_size{};
+	Char m_inline[Capacity]{};
+
+	void set_size(const usize length) noexcept {
+		m_size = length;
+		data()[m_size] = Char{};
+	}
+
+	void take(basic_path_buffer &other) noexcept {
+		if (other.m_heap) {
+			m_heap = std::move(other.m_heap);
+			m_heap_capacity = std::exchange(other.m_heap_capacity, 0);
+			m_size = other.m_size;
+		} else {
+			m_heap.reset();
+			m_heap_capacity = 0;
+			traits_type::copy(m_inline, other.m_inline, other.m_size);
+			set_size(other.m_size);
+		}
+		other.set_size(0);
+	}
+};
+
+inline constexpr u64 fnv1a_offset{ 0xCBF29CE484222325ull };
+inline constexpr u64 fnv1a_prime{ 0x00000100000001B3ull };
+
+/** FNV-1a 64 of the bytes filesystem::to_narrow() would produce, so narrow and wide paths hash the same */
+template<class Char>
+constexpr u64 hash_bytes(u64 hash, const Char c) noexcept {
+	constexpr u16 bits_per_char{ 8 };
+	const auto int_c{ static_cast<u16>(c) };
+	if constexpr (sizeof(Char) > 1) {
+		if (const auto left_part{ static_cast<u16>(int_c >> bits_per_char) }; left_part != u16{}) {
+			hash = (hash ^ left_part) * fnv1a_prime;
+		}
+	}
+	return (hash ^ static_cast<u16>(int_c & 0x00FFu)) * fnv1a_prime;
+}
+
+/** Continues the hash with the raw characters of @p text */
+template<class Char>
+constexpr u64 hash_text(u64 hash, const std::basic_string_view<Char> text) noexcept {
+	for (const auto c : text) hash = hash_bytes(hash, c);
+	return hash;
+}
+
+/**
+ * Reads a relative path one character at a time as the same asset names it. Backslashes count as
+ * slashes, while the leading, doubled and trailing separators are skipped, so `a\\b/`, `/a//b` and
+ * `a/b` are read the same.
+ */
+template<class Char>
+class relative_path_reader {
+public:
+	constexpr explicit relative_path_reader(const std::basic_string_view<Char> path) noexcept : m_path{ path } {}
+
+	/** The next character with the separators normalized to a single `/`, or `Char{}` at the end */
+	constexpr Char next() noexcept {
+		bool separator{ false };
+		for (; m_position < m_path.size(); ++m_position) {
+			const auto c{ m_path[m_position] };
+			if (c == Char('/') || c == Char('\\')) {
+				separator = m_written;
+				continue;
+			}
+			if (separator) return Char('/'); // The character itself is read by the next call
+			++m_position;
+			m_written = true;
+			return c;
+		}
+		return Char{};
+	}
+
+private:
+	std::basic_string_view<Char> m_path;
+	usize m_position{};
+	bool m_written{ false };
+};
+
+/** Continues the hash with the relative path as relative_path_reader reads it */
+template<class Char>
+constexpr u64 hash_relative_path(u64 hash, const std::basic_string_view<Char> path) noexcept {
+	relative_path_reader<Char> reader{ path };
+	for (auto c{ reader.next() }; c != Char{}; c = reader.next()) {
+		hash = hash_bytes(hash, c);
+	}
+	return hash;
+}
+
+/** Whether the relative paths name the same asset, e.g. `a\\b/` and `a/b` */
+template<class Char>
+constexpr bool same_relative_path(const std::basic_string_view<Char> left, const std::basic_string_view<Char> right) noexcept {
+	relative_path_reader<Char> left_reader{ left };
+	relative_path_reader<Char> right_reader{ right };
+	for (auto c{ left_reader.next() }; c == right_reader.next(); c = left_reader.next()) {
+		if (c == Char{}) return true;
+	}
+	return false;
+}
+
+/**
+ * @brief Path hashed at compile time
+ * @details The protocol and the relative path are split in the constructor and the hash of both is
+ * computed right away, so `constexpr` ids cost nothing at runtime. It only keeps a view of the path,
+ * so build it from literals or strings which outlive it.
+ */
+template<class Char>
+class basic_asset_id {
+public:
+	using value_type = Char;
+	using view_type = std::basic_string_view<Char>;
+
+	static constexpr Char protocol_separator[]{ Char(':'), Char('/'), Char('/'), Char{} };
+
+	constexpr explicit basic_asset_id(const view_type path) noexcept
+		: m_path{ path }, m_protocol_size{ split(path) }
+		, m_hash{ hash_relative_path(hash_text(fnv1a_offset, protocol()), relative()) } {}
+
+	template<usize Length>
+	constexpr explicit basic_asset_id(const Char (&path)[Length]) noexcept
+		: basic_asset_id{ view_type{ path, Length - 1 } } {}
+
+	/** @brief The whole path, e.g. "res://textures/hero.png" */
+	[[nodiscard]] constexpr view_type path() const noexcept { return m_path; }
+	/** @brief The protocol with its separator, e.g. "res://". Empty if the path has no protocol */
+	[[nodiscard]] constexpr view_type protocol() const noexcept { return m_path.substr(0, m_protocol_size); }
+	/** @brief The path after the protocol, e.g. "textures/hero.png" */
+	[[nodiscard]] constexpr view_type relative() const noexcept { return m_path.substr(m_protocol_size); }
+	/** @brief FNV-1a 64 of the protocol and the relative path */
+	[[nodiscard]] constexpr u64 hash() const noexcept { return m_hash; }
+
+	/** @brief The same protocol and relative path, where the separators are compared as the hash sees them */
+	[[nodiscard]] friend constexpr bool operator==(const basic_asset_id &left, const basic_asset_id &right) noexcept {
+		return left.m_hash == right.m_hash && left.protocol() == right.protocol()
+			&& same_relative_path(left.relative(), right.relative());
+	}
+	[[nodiscard]] friend constexpr bool operator!=(const basic_asset_id &left, const basic_asset_id &right) noexcept {
+		return !(left == right);
+	}
+
+private:
+	view_type m_path;
+	usize m_protocol_size;
+	u64 m_hash;
+
+	static constexpr usize split(const view_type path) noexcept {
+		const auto found{ path.find(protocol_separator) };
+		return found == view_type::npos ? 0 : found + view_type{ protocol_separator }.size();
+	}
+};
+
+/** Offsets of the parts of a path parsed by details::parse_literal_path() */
+struct literal_parts {
+	usize size{};     ///< Length of the whole path
+	usize protocol{}; ///< Length of the protocol with its separator
+	usize parent{};   ///< Length of the parent directory path
+};
+
+template<class Char>
+constexpr bool is_literal_separator(const Char c) noexcept {
+	return c == Char('/') || c == Char('\\');
+}
+
+template<class Char>
+constexpr bool is_protocol_character(const Char c) noexcept {
+	return (c >= Char('a') && c <= Char('z')) || (c >= Char('A') && c <= Char('Z')) ||
+		(c >= Char('0') && c <= Char('9')) || c == Char('_') || c == Char('-') || c == Char('.') || c == Char('+');
+}
+
+/** Characters which aren't portable in a file name: the control ones and `<>:"|?*` */
+template<class Char>
+constexpr bool is_forbidden_character(const Char c) noexcept {
+	return (c >= Char{} && c < Char(0x20)) || c == Char('<') || c == Char('>') || c == Char(':') ||
+		c == Char('"') || c == Char('|') || c == Char('?') || c == Char('*');
+}
+
+/**
+ * Validates the path and writes its normalized wide version to @p out, which needs room for
+ * `path.size()` characters. The result is what filesystem::normalize() makes of the relative part:
+ * `\\` becomes `/`, the empty and `.` components are dropped, `..` removes the previous component
+ * and the trailing spaces are trimmed. Throws std::invalid_argument, so it doesn't compile in a
+ * constant expression, if the path has no protocol, `..` leaves the association, or a component
+ * has forbidden characters or ends with a space.
+ */
+template<class Char>
+constexpr literal_parts parse_literal_path(std::basic_string_view<Char> path, wchar_t *out) {
+	literal_parts parts{};
+	for (usize i{}; i + 2 < path.size() && parts.protocol == 0; ++i) {
+		if (path[i] == Char(':') && path[i + 1] == Char('/') && path[i + 2] == Char('/')) parts.protocol = i + 3;
+	}
+	if (parts.protocol == 0) throw std::invalid_argument{ "[filesystem::literal_path] The protocol is missing" };
+	if (parts.protocol == 3) throw std::invalid_argument{ "[filesystem::literal_path] The protocol is empty" };
+
+	for (usize i{}; i < parts.protocol - 3; ++i) {
+		if (!is_protocol_character(path[i])) {
+			throw std::invalid_argument{ "[filesystem::literal_path] The protocol has invalid characters" };
+		}
+	}
+	for (; parts.size < parts.protocol; ++parts.size) out[parts.size] = static_cast<wchar_t>(path[parts.size]);
+	parts.parent = parts.protocol;
+
+	while (path.size() > parts.protocol && path.back() == Char(' ')) path.remove_suffix(1);
+
+	for (usize begin{ parts.protocol }; begin < path.size(); ) {
+		usize end{ begin };
+		while (end < path.size() && !is_literal_separator(path[end])) ++end;
+		const auto component{ path.substr(begin, end - begin) };
+		begin = end + 1;
+
+		if (component.empty() || (component.size() == 1 && component[0] == Char('.'))) continue;
+		if (component.size() == 2 && component[0] == Char('.') && component[1] == Char('.')) {
+			if (parts.size == parts.protocol) {
+				throw std::invalid_argument{ "[filesystem::literal_path] The path leaves its association" };
+			}
+			parts.size = parts.parent;
+			usize slash{ parts.size };
+			while (slash > parts.protocol && out[slash - 1] != L'/') --slash;
+			parts.parent = slash > parts.protocol ? slash - 1 : parts.protocol;
+			continue;
+		}
+
+		if (component.back() == Char(' ')) {
+			throw std::invalid_argument{ "[filesystem::literal_path] A component ends with a space" };
+		}
+		for (const auto c : component) {
+			if (is_forbidden_character(c)) {
+				throw std::invalid_argument{ "[filesystem::literal_path] A component has forbidden characters" };
+			}
+		}
+
+		parts.parent = parts.size;
+		if (parts.size != parts.protocol) out[parts.size++] = L'/';
+		for (const auto c : component) out[parts.size++] = static_cast<wchar_t>(c);
+	}
+	return parts;
+}
+
 } // namespace
 
+class filesystem;
+
+/**
+ * @brief Read-only memory mapping of a whole file. See golxzn::os::filesystem::map
+ * @details Move only, the destructor releases the mapping. It's empty if the file is empty or
+ * cannot be mapped.
+ */
+class mapped_file {
+public:
+	mapped_file() noexcept = default;
+	mapped_file(mapped_file &&other) noexcept;
+	mapped_file &operator=(mapped_file &&other) noexcept;
+	mapped_file(const mapped_file &) = delete;
+	mapped_file &operator=(const mapped_file &) = delete;
+	~mapped_file();
+
+	[[nodiscard]] const byte *data() const noexcept { return m_data; }
+	[[nodiscard]] usize size() const noexcept { return m_size; }
+	[[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+	[[nodiscard]] const byte *begin() const noexcept { return m_data; }
+	[[nodiscard]] const byte *end() const noexcept { return m_data + m_size; }
+	[[nodiscard]] details::data_view<byte> view() const noexcept { return details::data_view<byte>{ m_data, m_size }; }
+
+	/** @brief Release the mapping */
+	void reset() noexcept;
+
+private:
+	friend class filesystem;
+
+	const byte *m_data{};
+	usize m_size{};
+
+	mapped_file(const byte *data, const usize size) noexcept : m_data{ data }, m_size{ size } {}
+};
+
+/** @brief How golxzn::os::filesystem::read_binary<Custom> and the others build `Custom`. See golxzn::os::loader_traits */
+enum class load_strategy : u16 {
+	vector,   ///< `Custom(std::vector<byte>)` with a copy of the file
+	view,     ///< `Custom(details::data_view<byte>)` with the bytes of the mapped file. The view is valid only in the constructor
+	mapping,  ///< `Custom(mapped_file)` which keeps the mapping
+	in_place, ///< `Custom()` and then the file is read right to `loader_traits<Custom>::destination(custom, size)`
+};
+
+namespace details {
+
+template<class Custom, class = void>
+struct has_load_destination : std::false_type {};
+
+template<class Custom>
+struct has_load_destination<Custom, std::void_t<
+	decltype(static_cast<byte *>(std::declval<Custom &>().load_destination(usize{})))
+>> : std::true_type {};
+
+template<class Custom>
+constexpr load_strategy default_load_strategy() noexcept {
+	// The types built from a copy keep it until they opt in by loader_traits, whatever else they have
+	if constexpr (std::is_constructible_v<Custom, std::vector<byte>>) return load_strategy::vector;
+	// A mapped_file converts to data_view, so the view constructor is checked first
+	else if constexpr (std::is_constructible_v<Custom, data_view<byte>>) return load_strategy::view;
+	else if constexpr (std::is_constructible_v<Custom, mapped_file>) return load_strategy::mapping;
+	else if constexpr (std::is_default_constructible_v<Custom> && has_load_destination<Custom>::value) {
+		return load_strategy::in_place;
+	}
+	return load_strategy::vector;
+}
+
+} // namespace details
+
+/**
+ * @brief Customization point of golxzn::os::filesystem::read_binary<Custom>,
+ * golxzn::os::filesystem::read_shared_binary<Custom> and golxzn::os::filesystem::read_unique_binary<Custom>
+ * @details By default the strategy is picked by what `Custom` has, in this order: a constructor
+ * from `std::vector<byte>`, a constructor from `details::data_view<byte>`, a constructor from
+ * golxzn::os::mapped_file, a default constructor with the `byte *load_destination(usize size)` member.
+ * A `details::data_view<byte>` is built from any container, so a view constructor alone is enough
+ * for the first one. Specialize it to choose the strategy or to tell the destination without touching `Custom`:
+ * @code{.cpp}
+ * template<> struct gxzn::os::loader_traits<texture> {
+ *     static constexpr gxzn::os::load_strategy strategy{ gxzn::os::load_strategy::in_place };
+ *     static gxzn::os::byte *destination(texture &value, const gxzn::os::usize size) {
+ *         value.pixels.resize(size);
+ *         return value.pixels.data();
+ *     }
+ * };
+ * @endcode
+ * The mapping and view strategies ignore golxzn::os::filesystem::read_mode::buffered, since the mapped
+ * pages are the page cache. With golxzn::os::filesystem::read_mode::direct the view is over a read copy.
+ * A failed in_place read leaves a default constructed `Custom`. golxzn::os::filesystem::load_into
+ * tells why it failed.
+ */
+template<class Custom, class = void>
+struct loader_traits {
+	static constexpr load_strategy strategy{ details::default_load_strategy<Custom>() };
+
+	/** @brief Room for @p size bytes in @p custom. Used by golxzn::os::load_strategy::in_place */
+	static byte *destination(Custom &custom, const usize size) { return custom.load_destination(size); }
+};
+
+namespace details {
+
+template<class Custom>
+inline constexpr bool is_loadable_v{
+	loader_traits<Custom>::strategy != load_strategy::vector || std::is_constructible_v<Custom, std::vector<byte>>
+};
+
+template<class T> T &loaded_object(T &value) noexcept { return value; }
+template<class T> T &loaded_object(std::shared_ptr<T> &value) noexcept { return *value; }
+template<class T> T &loaded_object(std::unique_ptr<T> &value) noexcept { return *value; }
+
+} // namespace details
+
 /**
  * @brief Golxzn Resource Manager
  * @details Use this class to load resources from the program's directory.
@@ -69,253 +576,1309 @@ class filesystem final {
 public:
 	/** @brief Map of the protocol extensions and their prefixes */
 	using associations_type = std::unordered_map<std::wstring, std::wstring>;
+	/** @brief Path with the inline storage. See golxzn::os::details::basic_path_buffer */
+	using path_buffer = details::basic_path_buffer<wchar_t>;
+	/** @brief Narrow version of golxzn::os::filesystem::path_buffer */
+	using path_buffer_narrow = details::basic_path_buffer<char>;
+	/** @brief Path hashed at compile time. See golxzn::os::details::basic_asset_id */
+	using asset_id = details::basic_asset_id<wchar_t>;
+	/** @brief Narrow version of golxzn::os::filesystem::asset_id. Both hash the same path the same */
+	using asset_id_narrow = details::basic_asset_id<char>;
+	/** @brief Read-only memory mapping of a file. See golxzn::os::mapped_file */
+	using mapped_file = os::mapped_file;
+
+	/**
+	 * @brief Path which is already validated and normalized, e.g. by golxzn::os::filesystem::literal_path
+	 * @details The methods taking it only replace the protocol with its association.
+	 */
+	struct checked_path {
+		std::wstring_view path;  ///< The whole path, e.g. "res://textures/hero.png"
+		usize protocol_size{};   ///< Length of the protocol with its separator
+		usize parent_size{};     ///< Length of the parent directory path, e.g. "res://textures"
+
+		[[nodiscard]] constexpr std::wstring_view protocol() const noexcept { return path.substr(0, protocol_size); }
+		[[nodiscard]] constexpr std::wstring_view relative() const noexcept { return path.substr(protocol_size); }
+		[[nodiscard]] constexpr std::wstring_view parent() const noexcept { return path.substr(0, parent_size); }
+	};
+
+	/**
+	 * @brief Path literal validated and normalized at compile time
+	 * @details Declare it `constexpr` and an invalid path doesn't compile:
+	 * @code{.cpp}
+	 * static constexpr gxzn::os::fs::literal_path texture{ L"res://textures/../models/hero.png" };
+	 * static_assert(texture.path() == L"res://models/hero.png");
+	 * const auto content{ gxzn::os::fs::read_binary(texture) }; // No validation and normalization
+	 * @endcode
+	 * The path is always stored as a wide string, narrow literals are widened like
+	 * golxzn::os::filesystem::to_wide does. See details::parse_literal_path() for the rules.
+	 */
+	template<usize Length>
+	class literal_path {
+	public:
+		constexpr literal_path(const wchar_t (&path)[Length]) : literal_path{ std::wstring_view{ path, Length - 1 } } {}
+		constexpr literal_path(const char (&path)[Length]) : literal_path{ std::string_view{ path, Length - 1 } } {}
+
+		[[nodiscard]] constexpr std::wstring_view path() const noexcept { return std::wstring_view{ m_path, m_parts.size }; }
+		[[nodiscard]] constexpr std::wstring_view protocol() const noexcept { return path().substr(0, m_parts.protocol); }
+		[[nodiscard]] constexpr std::wstring_view relative() const noexcept { return path().substr(m_parts.protocol); }
+		[[nodiscard]] constexpr std::wstring_view parent() const noexcept { return path().substr(0, m_parts.parent); }
+		[[nodiscard]] constexpr const wchar_t *c_str() const noexcept { return m_path; }
+
+		[[nodiscard]] constexpr operator checked_path() const noexcept {
+			return checked_path{ path(), m_parts.protocol, m_parts.parent };
+		}
+
+	private:
+		wchar_t m_path[Length]{};
+		details::literal_parts m_parts{};
+
+		template<class Char>
+		constexpr explicit literal_path(const std::basic_string_view<Char> path)
+			: m_parts{ details::parse_literal_path(path, m_path) } {}
+	};
 
 	static constexpr std::wstring_view none{ L"" }; ///< Empty wide string
 	static constexpr std::wstring::value_type separator{ L'/' }; ///< Path separator
 	static constexpr std::wstring_view default_application_name{ L"unknown_application" }; ///< Default application name
 	static constexpr std::wstring_view default_assets_directory_name{ L"assets" }; ///< Default assets directory name
 	static constexpr std::wstring_view protocol_separator{ L"://" }; ///< Protocol separator
+	static constexpr std::wstring_view default_trace_path{ L"user://access.trace" }; ///< Default access trace path
+	static constexpr usize default_write_behind_limit{ 64 * 1024 * 1024 }; ///< Default limit of the bytes queued by golxzn::os::filesystem::enable_write_behind
+	static constexpr std::chrono::milliseconds wait_forever{ std::chrono::milliseconds::max() }; ///< golxzn::os::filesystem::lock waits until the range is free
+	static constexpr usize default_delta_block_size{ 64 * 1024 }; ///< Default block compared by golxzn::os::filesystem::write_delta
+	static constexpr std::chrono::milliseconds default_metadata_ttl{ 1000 }; ///< Default lifetime of the results cached by golxzn::os::filesystem::enable_metadata_cache
 
 	static constexpr std::string_view none_narrow{ "" }; ///< Narrow version of golxzn::os::filesystem::none
 	static constexpr std::string::value_type separator_narrow{ '/' }; ///< Narrow version of golxzn::os::filesystem::separator
 	static constexpr std::string_view default_application_name_narrow{ "unknown_application" }; ///< Narrow version of golxzn::os::filesystem::default_application_name
 	static constexpr std::string_view default_assets_directory_name_narrow{ "assets" }; ///< Narrow version of golxzn::os::filesystem::default_assets_directory_name
 	static constexpr std::string_view protocol_separator_narrow{ "://" }; ///< Narrow version of golxzn::os::filesystem::protocol_separator
+	static constexpr std::string_view default_trace_path_narrow{ "user://access.trace" }; ///< Narrow version of golxzn::os::filesystem::default_trace_path
+
 
 
+	/**
+	 * @brief What went wrong. See golxzn::os::filesystem::error
+	 */
+	enum class error_code : u16 {
+		ok,                    ///< No error
+		missing_protocol,      ///< The path has no protocol prefix (ex. "res://")
+		empty_path,            ///< The path is empty
+		invalid_argument,      ///< Invalid or empty parameters
+		not_a_file,            ///< The path isn't a file
+		not_a_directory,       ///< The path isn't a directory
+		path_is_file,          ///< A directory is expected, but the path is a file
+		open_failed,           ///< The file cannot be opened
+		write_failed,          ///< The file cannot be written
+		make_directory_failed, ///< The directory (or the parent directory of a file) cannot be created
+		remove_failed,         ///< The file or the directory cannot be removed
+		move_failed,           ///< The file cannot be moved
+		copy_failed,           ///< The file or the directory tree cannot be copied
+		copy_into_itself,      ///< The destination of the directory copy is inside of the source
+		read_failed,           ///< The directory tree cannot be read
+		trace_not_started,     ///< golxzn::os::filesystem::stop_trace is called without a started trace
+		setup_failed,          ///< The assets or the user data directory cannot be set up
+		exception,             ///< The standard library has thrown an exception
+		locked,                ///< The range of the file is locked by someone else
+		lock_failed,           ///< The range of the file cannot be locked or unlocked
+
+		count ///< Number of the codes
+	};
 
 	/**
 	 * @brief Struct returned by some methods to tell if there's an error
+	 * @details It doesn't allocate: the message is formatted only on demand by
+	 * golxzn::os::filesystem::error::message.
 	 * @warning This struct has unexplicit conversion to bool! Use carefully!
 	 */
-	struct error {
-		std::wstring message; ///< Error message. If it's golxzn::os::filesystem::none, everything is OK.
-
-		/**
-		 * @brief Checks if there's an error
-		 *
-		 * @return `true` - Something wrong (error message is not empty)
-		 * @return `false` - All right (error message is empty)
-		 */
-		bool has_error() const noexcept;
+	struct error {
+		error_code code{ error_code::ok }; ///< Error code. If it's golxzn::os::filesystem::error_code::ok, everything is OK.
+		int system{};                      ///< `errno` (`GetLastError()` on Windows) captured at the failure or 0
+		const char *operation{ nullptr };  ///< Name of the failed method (ex. "write_binary") or `nullptr`
+
+		/**
+		 * @brief Checks if there's an error
+		 *
+		 * @return `true` - Something wrong (error code is not golxzn::os::filesystem::error_code::ok)
+		 * @return `false` - All right (error code is golxzn::os::filesystem::error_code::ok)
+		 */
+		constexpr bool has_error() const noexcept { return code != error_code::ok; }
+
+		/**
+		 * @brief Non-implicit conversion to bool
+		 *
+		 * @return `true` - All right. There's no error
+		 * @return `false` - An error occurred
+		 */
+		constexpr operator bool() const noexcept { return !has_error(); }
+
+		/**
+		 * @brief Description of the error code
+		 *
+		 * @return `std::wstring_view` - Static description (ex. "Not a directory")
+		 */
+		std::wstring_view description() const noexcept;
+
+		/**
+		 * @brief Format the message into the caller's buffer without any allocation
+		 * @details The message looks like `[filesystem::write_binary] Cannot write to the file: No space left on device`.
+		 * It's truncated to fit into the buffer and it's always null terminated.
+		 *
+		 * @param buffer Destination buffer
+		 * @param capacity Size of the buffer in characters including the null terminator
+		 * @return `usize` - Length of the message without the null terminator
+		 */
+		usize message(wchar_t *buffer, const usize capacity) const noexcept;
+
+		/// @brief Narrow string alias for golxzn::os::filesystem::error::message(wchar_t *buffer, const usize capacity)
+		usize message(char *buffer, const usize capacity) const noexcept;
+
+		/**
+		 * @brief Format the message into a new string
+		 * @warning Allocates. Use golxzn::os::filesystem::error::message(wchar_t *buffer, const usize capacity)
+		 * on the hot paths.
+		 *
+		 * @return `std::wstring` - The message or an empty string if there's no error
+		 */
+		std::wstring message() const;
+	};
+	static constexpr error OK{ error_code::ok, 0, nullptr }; ///< OK struct
+
+	/**
+	 * @brief Durability guarantee of the atomic writes
+	 * @details See golxzn::os::filesystem::write_binary_atomic
+	 */
+	enum class durability {
+		none, ///< Don't flush anything. The file is replaced atomically, but it may be lost on power failure
+		data, ///< Flush the file content before it replaces the destination file
+		full, ///< Flush the content and the directory entry, so the replacement itself survives a crash
+	};
+
+	/** @brief How golxzn::os::filesystem::write_delta updates the file */
+	enum class delta_mode {
+		in_place, ///< Write the changed blocks into the file itself. A crash may leave it partially updated
+		atomic,   ///< Update a clone of the file, flush it and rename it over the file. The clone shares the
+		          ///< unchanged blocks on the copy-on-write filesystems (btrfs, XFS, APFS, ReFS) and copies them elsewhere
+	};
+
+	/** @brief Write of the write-behind queue which has failed in background */
+	struct write_failure {
+		std::wstring path; ///< Resolved path of the file
+		error status;      ///< The error of the write
+	};
+
+	/** @brief Mode of the byte-range lock. See golxzn::os::filesystem::lock */
+	enum class lock_mode {
+		shared,    ///< Many shared locks of a range can be held at once, e.g. by the readers
+		exclusive, ///< Only one exclusive lock and no shared ones can be held, e.g. by the writer
+	};
+
+	/** @brief How the files are read */
+	enum class read_mode {
+		buffered, ///< Read through the page cache
+		direct,   ///< Bypass the page cache (`O_DIRECT`, `F_NOCACHE` or `FILE_FLAG_NO_BUFFERING`). Use it for
+		          ///< large streaming files which shouldn't evict the hot data from the cache. Falls back to
+		          ///< golxzn::os::filesystem::read_mode::buffered if the filesystem doesn't support it
+	};
+
+	/** @brief Progress of golxzn::os::filesystem::copy_directory */
+	struct copy_progress {
+		usize files_total{};  ///< Number of files to copy
+		usize files_copied{}; ///< Number of files already copied
+		usize bytes_total{};  ///< Total size of the files to copy
+		usize bytes_copied{}; ///< Size of the files already copied
+	};
+
+	/** @brief Callback which receives golxzn::os::filesystem::copy_progress */
+	using copy_progress_callback = std::function<void(const copy_progress &)>;
+
+	/** @brief Public operations tracked by golxzn::os::filesystem::stats */
+	enum class io_operation {
+		read,           ///< golxzn::os::filesystem::read_binary and golxzn::os::filesystem::read_text
+		write,          ///< golxzn::os::filesystem::write_binary and golxzn::os::filesystem::write_text
+		append,         ///< golxzn::os::filesystem::append_binary and golxzn::os::filesystem::append_text
+		write_atomic,   ///< golxzn::os::filesystem::write_binary_atomic and golxzn::os::filesystem::write_text_atomic
+		stat,           ///< golxzn::os::filesystem::exists, golxzn::os::filesystem::is_file and golxzn::os::filesystem::is_directory
+		make_directory, ///< golxzn::os::filesystem::make_directory
+		remove,         ///< golxzn::os::filesystem::remove_directory and golxzn::os::filesystem::remove_file
+		copy_file,      ///< golxzn::os::filesystem::copy_file
+		copy_directory, ///< golxzn::os::filesystem::copy_directory
+		move_file,      ///< golxzn::os::filesystem::move_file
+		entries,        ///< golxzn::os::filesystem::entries
+		prefetch,       ///< golxzn::os::filesystem::prefetch and golxzn::os::filesystem::evict
+		lock,           ///< golxzn::os::filesystem::lock, golxzn::os::filesystem::try_lock and golxzn::os::filesystem::is_locked
+		write_delta,    ///< golxzn::os::filesystem::write_delta
+
+		count           ///< Number of the operations
+	};
+
+	/** @brief Public call passed to golxzn::os::filesystem::trace_sink */
+	struct span {
+		io_operation operation{};                     ///< Kind of the call
+		std::string_view name;                        ///< Name of the public method, e.g. `read_binary`
+		std::wstring_view path;                       ///< Path the method was called with. Valid only during the sink call
+		u64 thread{};                                 ///< Small sequential number of the calling thread
+		u64 size{};                                   ///< Number of read or written bytes. Known only in trace_sink::end
+		bool failed{};                                ///< The call has failed. Known only in trace_sink::end
+		std::chrono::steady_clock::time_point begin;  ///< Time the call has started
+		std::chrono::steady_clock::time_point end;    ///< Time the call has finished. Known only in trace_sink::end
+	};
+
+	/**
+	 * @brief Receiver of the spans of the public calls
+	 * @details The methods are called on the thread which makes the call, so they have to be thread
+	 * safe and fast. The nested public calls (e.g. golxzn::os::filesystem::make_directory inside
+	 * golxzn::os::filesystem::write_binary) have their own spans.
+	 */
+	class trace_sink {
+	public:
+		virtual ~trace_sink() = default;
+
+		/** @brief Called when the public call starts */
+		virtual void begin([[maybe_unused]] const span &call) noexcept {}
+
+		/** @brief Called when the public call finishes */
+		virtual void end(const span &call) noexcept = 0;
+	};
+
+	/**
+	 * @brief Sink which collects the spans in the Chrome trace event format
+	 * @details The saved file can be opened in Perfetto or `chrome://tracing`.
+	 */
+	class chrome_trace_sink final : public trace_sink {
+	public:
+		chrome_trace_sink();
+
+		void end(const span &call) noexcept override;
+
+		/**
+		 * @brief Save the collected spans as JSON
+		 *
+		 * @param path Path to the trace file
+		 * @return `error` - Error if the file cannot be written
+		 */
+		[[nodiscard]] error save(const std::wstring_view path);
+
+		/// @brief Narrow string alias for golxzn::os::filesystem::chrome_trace_sink::save(const std::wstring_view path)
+		[[nodiscard]] error save(const std::string_view path);
+
+	private:
+		const std::chrono::steady_clock::time_point origin;
+		std::mutex guard;
+		std::string events;
+	};
+
+	/**
+	 * @brief Append-only writer which spreads the records over preallocated segment files
+	 * @details The segments are named `<path>.000000`, `<path>.000001` and so on, continuing after
+	 * the segments already in the directory. The whole segment is preallocated at once (`fallocate`,
+	 * `F_PREALLOCATE` or `FileAllocationInfo`) and has its final size from the beginning, so an
+	 * append is a single positional write which neither allocates nor grows the file. The records
+	 * aren't split: the segment is rotated once the next record doesn't fit, and a record larger
+	 * than the segment gets a segment of its own. Closing a segment truncates its unused space.
+	 *
+	 * A segment which wasn't closed (e.g. after a crash) ends with zeros up to the segment size.
+	 * The writer isn't thread safe.
+	 */
+	class segment_writer {
+	public:
+		static constexpr usize default_segment_size{ 16 * 1024 * 1024 }; ///< Default size of a segment
+
+		segment_writer() noexcept = default;
+
+		/**
+		 * @brief Nothing is created until the first append
+		 *
+		 * @param path Path of the segments without the index, e.g. `user://logs/game.log`
+		 * @param segment_size Size of a segment
+		 */
+		explicit segment_writer(const std::wstring_view path, const usize segment_size = default_segment_size);
+
+		/// @brief Narrow string alias for golxzn::os::filesystem::segment_writer::segment_writer(const std::wstring_view path, const usize segment_size)
+		explicit segment_writer(const std::string_view path, const usize segment_size = default_segment_size);
+
+		segment_writer(segment_writer &&other) noexcept;
+		segment_writer &operator=(segment_writer &&other) noexcept;
+		segment_writer(const segment_writer &) = delete;
+		segment_writer &operator=(const segment_writer &) = delete;
+
+		/** @brief Closes the segment. Call golxzn::os::filesystem::segment_writer::close to get its error */
+		~segment_writer();
+
+		/**
+		 * @brief Append the record to the segment, opening or rotating it if needed
+		 *
+		 * @param data Record to append
+		 * @return `error` - Error or golxzn::os::filesystem::OK
+		 */
+		[[nodiscard]] error append_binary(const details::data_view<byte> &data);
+
+		/**
+		 * @brief Append the text to the segment, opening or rotating it if needed
+		 *
+		 * @param text Text to append
+		 * @return `error` - Error or golxzn::os::filesystem::OK
+		 */
+		[[nodiscard]] error append_text(const std::string_view text);
+
+		/**
+		 * @brief Truncate the unused space and close the segment
+		 * @details The next append opens the next segment.
+		 *
+		 * @return `error` - Error if the segment cannot be truncated or closed
+		 */
+		error close();
+
+		/** @brief Check if a segment is open */
+		[[nodiscard]] bool is_open() const noexcept { return m_file != closed_file; }
+
+		/** @brief Index of the open segment or the next one to open. Known after the first append */
+		[[nodiscard]] usize segment() const noexcept { return m_segment; }
+
+		/** @brief Number of bytes appended to the open segment */
+		[[nodiscard]] usize size() const noexcept { return m_size; }
+
+		/** @brief Path of golxzn::os::filesystem::segment_writer::segment, e.g. `user://logs/game.log.000002` */
+		[[nodiscard]] std::wstring segment_path() const;
+
+	private:
+		static constexpr std::intptr_t closed_file{ -1 };
+
+		std::wstring m_path;
+		usize m_segment_size{ default_segment_size };
+		usize m_segment{};
+		usize m_size{};
+		std::intptr_t m_file{ closed_file };
+		bool m_indexed{ false };
+
+		error open(const char *operation);
+	};
+
+	/**
+	 * @brief Byte-range lock of a file taken by golxzn::os::filesystem::lock
+	 * @details Move only, the destructor releases the lock. The lock belongs to its own open file
+	 * description (`F_OFD_SETLK` on Linux, `LockFileEx` on Windows), so it conflicts with the other
+	 * locks of the same process too, and closing other descriptors of the file doesn't release it.
+	 * MacOS has only the process-wide POSIX locks: they don't conflict within the process and closing
+	 * any descriptor of the file releases them.
+	 */
+	class file_lock {
+	public:
+		file_lock() noexcept = default;
+		file_lock(file_lock &&other) noexcept;
+		file_lock &operator=(file_lock &&other) noexcept;
+		file_lock(const file_lock &) = delete;
+		file_lock &operator=(const file_lock &) = delete;
+		~file_lock();
+
+		/** @brief Check if the range is locked by this object */
+		[[nodiscard]] bool is_locked() const noexcept { return m_file != closed_file; }
+
+		/** @brief First byte of the locked range */
+		[[nodiscard]] usize offset() const noexcept { return m_offset; }
+
+		/** @brief Size of the locked range. 0 means up to the end of the file, including what is appended later */
+		[[nodiscard]] usize size() const noexcept { return m_size; }
+
+		/** @brief Mode of the lock */
+		[[nodiscard]] lock_mode mode() const noexcept { return m_mode; }
+
+		/**
+		 * @brief Write into the file through the locked description without changing its size otherwise
+		 * @details Writing through another descriptor works too, but golxzn::os::filesystem::write_binary
+		 * replaces the whole file, so the regions are written by this method.
+		 *
+		 * @param offset Position in the file, usually inside of the locked range
+		 * @param data Data to write
+		 * @return `error` - Error or golxzn::os::filesystem::OK
+		 */
+		[[nodiscard]] error write(const usize offset, const details::data_view<byte> &data);
+
+		/**
+		 * @brief Release the lock
+		 *
+		 * @return `error` - Error if the range cannot be unlocked. The lock is released anyway once the file is closed
+		 */
+		error unlock();
+
+	private:
+		friend class filesystem;
+
+		static constexpr std::intptr_t closed_file{ -1 };
+
+		std::intptr_t m_file{ closed_file };
+		usize m_offset{};
+		usize m_size{};
+		lock_mode m_mode{ lock_mode::exclusive };
+	};
+
+#if defined(GXZN_OS_FS_STATISTICS)
+
+	/** @brief Counters of a single golxzn::os::filesystem::io_operation */
+	struct operation_statistics {
+		static constexpr usize latency_buckets{ 48 }; ///< Number of the latency histogram buckets
+
+		u64 calls{};         ///< Number of calls
+		u64 errors{};        ///< Number of failed calls
+		u64 bytes_read{};    ///< Number of read bytes
+		u64 bytes_written{}; ///< Number of written bytes
+		u64 syscalls{};      ///< Number of system calls issued by the calling thread
+		std::array<u64, latency_buckets> latency{}; ///< Bucket `i` counts calls which took [2^(i-1), 2^i) nanoseconds
+	};
+
+	/** @brief Statistics of every golxzn::os::filesystem::io_operation of a protocol */
+	using protocol_statistics = std::array<operation_statistics, static_cast<usize>(io_operation::count)>;
+
+	/** @brief Statistics keyed by the protocol (`res://`, `user://`, etc.). Paths without protocol have the empty key */
+	using statistics = std::unordered_map<std::wstring, protocol_statistics>;
+
+#endif // defined(GXZN_OS_FS_STATISTICS)
+
+	filesystem() = delete;
+
+	/** @addtogroup initialization Initialization and setting up
+	 * @{
+	 */
+
+	/**
+	 * @brief Initialize the Resource Manager
+	 *
+	 * @param application_name Your application name or the name of the user assets directory
+	 * @param assets_path The name of the assets directory or the full path to the directory.
+	 * If there's [LETTER]:/ or / at the beginning of the string, the path will be used as it is.
+	 * Otherwise the path is relative to the program's directory.
+	 * @return golxzn::os::filesystem::error - filesystem::OK or the error
+	 */
+	[[nodiscard]] static error initialize(const std::wstring_view application_name,
+		const std::wstring_view assets_path = default_assets_directory_name);
+
+	/**
+	 * @brief Sets the application name object
+	 * @details Sets the name of the application which is used in the directory path for user data.
+	 * If the name is empty, the default name will be used.
+	 * @warning This method doesn't change the name of the user data directory!
+	 * @param application_name application name
+	 */
+	static void set_application_name(const std::wstring_view application_name) noexcept;
+
+	/**
+	 * @brief Add the association between the protocol and the prefix. (ex. L"res://" and L"user://")
+	 * @details Add custom protocol to your application. For example, you could have a L"ab-test://"
+	 * association with your own separated assets directory.
+	 * @warning L"res://", L"user://", L"temp://" are reserved and cannot be used.
+	 * @param protocol Protocol extension (ex. "res://"). Has to end with "://"
+	 * @param prefix Prefix of the path. Has to end with a slash!
+	 */
+	static void associate(std::wstring_view protocol, std::wstring &&prefix) noexcept;
+
+	/** @} */
+
+	/** @addtogroup read Reading files
+	 * @{
+	 */
+
+	/**
+	 * @brief Read whole binary file
+	 *
+	 * @warning This method throws an exception `std::invalid_argument` if the path has no protocol!
+	 * @param path Path to the file
+	 * @param mode Read through the page cache or bypass it
+	 * @return `std::vector<byte>` - The data or an empty vector if there's an reading error.
+	 */
+	[[nodiscard]] static std::vector<byte> read_binary(const std::wstring_view path,
+		const read_mode mode = read_mode::buffered);
+
+	/**
+	 * @brief Read a range of a binary file
+	 *
+	 * @warning This method throws an exception `std::invalid_argument` if the path has no protocol!
+	 * @param path Path to the file
+	 * @param offset Offset of the first byte to read
+	 * @param size Number of bytes to read. The range is clipped by the end of the file
+	 * @param mode Read through the page cache or bypass it
+	 * @return `std::vector<byte>` - The data or an empty vector if there's an reading error.
+	 */
+	[[nodiscard]] static std::vector<byte> read_binary(const std::wstring_view path, const usize offset,
+		const usize size, const read_mode mode = read_mode::buffered);
+
+	/**
+	 * @brief Read whole text file
+	 *
+	 * @warning This method throws an exception `std::invalid_argument` if the path has no protocol!
+	 * @param path Path to the file
+	 * @param mode Read through the page cache or bypass it
+	 * @return `std::string` - The data or an empty string if there's an reading error.
+	 */
+	[[nodiscard]] static std::string read_text(const std::wstring_view path,
+		const read_mode mode = read_mode::buffered);
+
+	/**
+	 * @brief Read a range of a text file
+	 *
+	 * @warning This method throws an exception `std::invalid_argument` if the path has no protocol!
+	 * @param path Path to the file
+	 * @param offset Offset of the first character to read
+	 * @param size Number of characters to read. The range is clipped by the end of the file
+	 * @param mode Read through the page cache or bypass it
+	 * @return `std::string` - The data or an empty string if there's an reading error.
+	 */
+	[[nodiscard]] static std::string read_text(const std::wstring_view path, const usize offset,
+		const usize size, const read_mode mode = read_mode::buffered);
+
+	/**
+	 * @brief Read whole binary file by its id
+	 * @details If the association of the id is indexed (see golxzn::os::filesystem::build_index),
+	 * the native path is found by a single hash probe. Otherwise the path is resolved as usual.
+	 *
+	 * @warning This method throws an exception `std::invalid_argument` if the path has no protocol!
+	 * @param id Id of the file, e.g. `fs::asset_id{ L"res://textures/hero.png" }`
+	 * @param mode Read through the page cache or bypass it
+	 * @return `std::vector<byte>` - The data or an empty vector if there's an reading error.
+	 */
+	[[nodiscard]] static std::vector<byte> read_binary(const asset_id &id,
+		const read_mode mode = read_mode::buffered);
+
+	/**
+	 * @brief Read whole text file by its id. See golxzn::os::filesystem::read_binary(const asset_id &id, const read_mode mode)
+	 *
+	 * @warning This method throws an exception `std::invalid_argument` if the path has no protocol!
+	 * @param id Id of the file
+	 * @param mode Read through the page cache or bypass it
+	 * @return `std::string` - The data or an empty string if there's an reading error.
+	 */
+	[[nodiscard]] static std::string read_text(const asset_id &id,
+		const read_mode mode = read_mode::buffered);
+
+	/**
+	 * @brief Read whole binary file by the checked path, e.g. golxzn::os::filesystem::literal_path
+	 * @details The path isn't validated and normalized again, only its protocol is replaced.
+	 *
+	 * @param path Path to the file
+	 * @param mode Read through the page cache or bypass it
+	 * @return `std::vector<byte>` - The data or an empty vector if there's an reading error.
+	 */
+	[[nodiscard]] static std::vector<byte> read_binary(const checked_path path,
+		const read_mode mode = read_mode::buffered);
+
+	/**
+	 * @brief Read whole text file by the checked path, e.g. golxzn::os::filesystem::literal_path
+	 *
+	 * @param path Path to the file
+	 * @param mode Read through the page cache or bypass it
+	 * @return `std::string` - The data or an empty string if there's an reading error.
+	 */
+	[[nodiscard]] static std::string read_text(const checked_path path,
+		const read_mode mode = read_mode::buffered);
+
+	/**
+	 * @brief Read whole binary file right into the caller's memory
+	 * @details @p destination is called once with the file size before anything is read, so the
+	 * bytes land in their final storage without an intermediate buffer.
+	 *
+	 * @param path Path to the file
+	 * @param destination Returns room for the given number of bytes. It must not return `nullptr`
+	 * @param mode Read through the page cache or bypass it
+	 * @return `error` - Error or golxzn::os::filesystem::OK
+	 */
+	[[nodiscard]] static error read_into(const std::wstring_view path,
+		const std::function<byte *(usize)> &destination, const read_mode mode = read_mode::buffered);
+
+	/**
+	 * @brief Map whole file into the memory for reading
+	 * @details The pages are read on the first access and shared with the page cache, so nothing is
+	 * copied. The mapping stays valid until the golxzn::os::mapped_file is destroyed.
+	 *
+	 * @warning This method throws an exception `std::invalid_argument` if the path has no protocol!
+	 * @param path Path to the file
+	 * @return `mapped_file` - The mapping or an empty one if the file is empty or cannot be mapped.
+	 */
+	[[nodiscard]] static mapped_file map(const std::wstring_view path);
+
+#if defined(GXZN_OS_FS_PMR)
+	/**
+	 * @brief Read whole binary file into the memory of @p resource
+	 * @details The resolved path is built in @p resource as well, so a load into a
+	 * std::pmr::monotonic_buffer_resource arena doesn't touch the global heap until the platform call.
+	 *
+	 * @warning This method throws an exception `std::invalid_argument` if the path has no protocol!
+	 * @param path Path to the file
+	 * @param resource Memory resource of the result. `nullptr` means std::pmr::get_default_resource()
+	 * @param mode Read through the page cache or bypass it
+	 * @return `std::pmr::vector<byte>` - The data or an empty vector if there's an reading error.
+	 */
+	[[nodiscard]] static std::pmr::vector<byte> read_binary(const std::wstring_view path,
+		std::pmr::memory_resource *resource, const read_mode mode = read_mode::buffered);
+
+	/**
+	 * @brief Read a range of a binary file into the memory of @p resource
+	 *
+	 * @warning This method throws an exception `std::invalid_argument` if the path has no protocol!
+	 * @param path Path to the file
+	 * @param offset Offset of the first byte to read
+	 * @param size Number of bytes to read. The range is clipped by the end of the file
+	 * @param resource Memory resource of the result. `nullptr` means std::pmr::get_default_resource()
+	 * @param mode Read through the page cache or bypass it
+	 * @return `std::pmr::vector<byte>` - The data or an empty vector if there's an reading error.
+	 */
+	[[nodiscard]] static std::pmr::vector<byte> read_binary(const std::wstring_view path, const usize offset,
+		const usize size, std::pmr::memory_resource *resource, const read_mode mode = read_mode::buffered);
+
+	/**
+	 * @brief Read whole text file into the memory of @p resource
+	 *
+	 * @warning This method throws an exception `std::invalid_argument` if the path has no protocol!
+	 * @param path Path to the file
+	 * @param resource Memory resource of the result. `nullptr` means std::pmr::get_default_resource()
+	 * @param mode Read through the page cache or bypass it
+	 * @return `std::pmr::string` - The data or an empty string if there's an reading error.
+	 */
+	[[nodiscard]] static std::pmr::string read_text(const std::wstring_view path,
+		std::pmr::memory_resource *resource, const read_mode mode = read_mode::buffered);
+
+	/**
+	 * @brief Read a range of a text file into the memory of @p resource
+	 *
+	 * @warning This method throws an exception `std::invalid_argument` if the path has no protocol!
+	 * @param path Path to the file
+	 * @param offset Offset of the first character to read
+	 * @param size Number of characters to read. The range is clipped by the end of the file
+	 * @param resource Memory resource of the result. `nullptr` means std::pmr::get_default_resource()
+	 * @param mode Read through the page cache or bypass it
+	 * @return `std::pmr::string` - The data or an empty string if there's an reading error.
+	 */
+	[[nodiscard]] static std::pmr::string read_text(const std::wstring_view path, const usize offset,
+		const usize size, std::pmr::memory_resource *resource, const read_mode mode = read_mode::buffered);
+#endif // defined(GXZN_OS_FS_PMR)
+
+	/**
+	 * @brief Construct @p Custom class by binary data from file
+	 *
+	 * @tparam Custom Class to construct. See golxzn::os::loader_traits for the ways to build it
+	 * @param path Path to the file
+	 * @param mode Read through the page cache or bypass it
+	 * @return `Custom` - Constructed class
+	 */
+	template<class Custom>
+	[[nodiscard]] static auto read_binary(const std::wstring_view path,
+		const read_mode mode = read_mode::buffered)
+		-> std::enable_if_t<details::is_loadable_v<Custom>, Custom>;
+
+	/**
+	 * @brief Construct @p Custom class by text data from file
+	 *
+	 * @tparam Custom Class to construct. Has to have a constructor with std::string argument
+	 * @param path Path to the file
+	 * @param mode Read through the page cache or bypass it
+	 * @return `Custom` - Constructed class
+	 */
+	template<class Custom>
+	[[nodiscard]] static auto read_text(const std::wstring_view path,
+		const read_mode mode = read_mode::buffered)
+		-> std::enable_if_t<std::is_constructible_v<Custom, std::string>, Custom>;
+
+	/**
+	 * @brief Construct @p std::shared_ptr<Custom> by binary data from file
+	 *
+	 * @tparam Custom Class to construct. See golxzn::os::loader_traits for the ways to build it
+	 * @param path Path to the file
+	 * @param mode Read through the page cache or bypass it
+	 * @return `std::shared_ptr<Custom>` - Constructed shared class
+	 */
+	template<class Custom>
+	[[nodiscard]] static auto read_shared_binary(const std::wstring_view path,
+		const read_mode mode = read_mode::buffered)
+		-> std::enable_if_t<details::is_loadable_v<Custom>, std::shared_ptr<Custom>>;
+
+	/**
+	 * @brief Construct @p std::shared_ptr<Custom> by binary data from file
+	 *
+	 * @tparam Custom Class to construct. Has to have a public constructor with std::string argument
+	 * @param path Path to the file
+	 * @param mode Read through the page cache or bypass it
+	 * @return `std::shared_ptr<Custom>` - Constructed shared class
+	 */
+	template<class Custom>
+	[[nodiscard]] static auto read_shared_text(const std::wstring_view path,
+		const read_mode mode = read_mode::buffered)
+		-> std::enable_if_t<std::is_constructible_v<Custom, std::string>, std::shared_ptr<Custom>>;
+
+	/**
+	 * @brief Construct @p std::shared_ptr<Custom> by binary data from file
+	 *
+	 * @tparam Custom Class to construct. See golxzn::os::loader_traits for the ways to build it
+	 * @param path Path to the file
+	 * @param mode Read through the page cache or bypass it
+	 * @return `std::unique_ptr<Custom>` - Constructed unique class
+	 */
+	template<class Custom>
+	[[nodiscard]] static auto read_unique_binary(const std::wstring_view path,
+		const read_mode mode = read_mode::buffered)
+		-> std::enable_if_t<details::is_loadable_v<Custom>, std::unique_ptr<Custom>>;
+
+	/**
+	 * @brief Construct @p std::shared_ptr<Custom> by binary data from file
+	 *
+	 * @tparam Custom Class to construct. Has to have a public constructor with std::string argument
+	 * @param path Path to the file
+	 * @param mode Read through the page cache or bypass it
+	 * @return `std::unique_ptr<Custom>` - Constructed unique class
+	 */
+	template<class Custom>
+	[[nodiscard]] static auto read_unique_text(const std::wstring_view path,
+		const read_mode mode = read_mode::buffered)
+		-> std::enable_if_t<std::is_constructible_v<Custom, std::string>, std::unique_ptr<Custom>>;
+
+	/**
+	 * @brief Read whole binary file right into @p custom
+	 * @details The golxzn::os::load_strategy::in_place loading of an existing object, which tells
+	 * the error. The room is given by `loader_traits<Custom>::destination`.
+	 *
+	 * @tparam Custom Class to fill. See golxzn::os::loader_traits
+	 * @param path Path to the file
+	 * @param custom Object to read into. It's left as it was if the file cannot be opened
+	 * @param mode Read through the page cache or bypass it
+	 * @return `error` - Error or golxzn::os::filesystem::OK
+	 */
+	template<class Custom>
+	[[nodiscard]] static error load_into(const std::wstring_view path, Custom &custom,
+		const read_mode mode = read_mode::buffered);
+
+	/** @} */
+
+	/** @addtogroup write Writing files
+	 * @{
+	 */
+
+	/**
+	 * @brief Write binary data to a file
+	 *
+	 * @param path Path to the file
+	 * @param data Data to write to the file
+	 * @return golxzn::os::filesystem::error - filesystem::OK or the error
+	 */
+	[[nodiscard]] static error write_binary(const std::wstring_view path, const details::data_view<byte> &data);
+
+	/**
+	 * @brief Write binary data to a file
+	 *
+	 * @param path Path to the file
+	 * @param data Data to write to the file
+	 * @return golxzn::os::filesystem::error - filesystem::OK or the error
+	 */
+	[[nodiscard]] static error write_binary(const std::wstring_view path, const std::initializer_list<byte> data);
+
+	/**
+	 * @brief Append binary data to a file
+	 *
+	 * @param path Path to the file
+	 * @param data Data to write to the file
+	 * @return golxzn::os::filesystem::error - filesystem::OK or the error
+	 */
+	[[nodiscard]] static error append_binary(const std::wstring_view path, const details::data_view<byte> &data);
+
+	/**
+	 * @brief Append binary data to a file
+	 *
+	 * @param path Path to the file
+	 * @param data Data to write to the file
+	 * @return golxzn::os::filesystem::error - filesystem::OK or the error
+	 */
+	[[nodiscard]] static error append_binary(const std::wstring_view path, const std::initializer_list<byte> data);
+
+	/**
+	 * @brief Write several buffers to a file one after another without concatenating them
+	 * @details Useful for serialized objects kept in separate buffers, e.g. header, index and payload.
+	 * The pieces are passed to `writev` in batches of `IOV_MAX`. Windows writes them one by one
+	 * through the same handle, since `WriteFileGather` needs unbuffered, page-aligned memory.
+	 * Empty pieces are skipped, but the pieces mustn't be all empty.
+	 *
+	 * @param path Path to the file
+	 * @param pieces Buffers to write in order
+	 * @return golxzn::os::filesystem::error - filesystem::OK or the error
+	 */
+	[[nodiscard]] static error write_binary(const std::wstring_view path,
+		const std::initializer_list<details::data_view<byte>> pieces);
+
+	/**
+	 * @brief Write several buffers to a file one after another without concatenating them
+	 * @details The same as the std::initializer_list overload for the pieces counted at runtime.
+	 * See golxzn::os::filesystem::write_binary(const std::wstring_view, const std::initializer_list<details::data_view<byte>>)
+	 *
+	 * @param path Path to the file
+	 * @param pieces Buffers to write in order
+	 * @return golxzn::os::filesystem::error - filesystem::OK or the error
+	 */
+	[[nodiscard]] static error write_binary(const std::wstring_view path,
+		const std::vector<details::data_view<byte>> &pieces);
+
+	/**
+	 * @brief Append several buffers to a file one after another without concatenating them
+	 * @details See golxzn::os::filesystem::write_binary(const std::wstring_view, const std::initializer_list<details::data_view<byte>>)
+	 *
+	 * @param path Path to the file
+	 * @param pieces Buffers to append in order
+	 * @return golxzn::os::filesystem::error - filesystem::OK or the error
+	 */
+	[[nodiscard]] static error append_binary(const std::wstring_view path,
+		const std::initializer_list<details::data_view<byte>> pieces);
+
+	/**
+	 * @brief Append several buffers to a file one after another without concatenating them
+	 * @details See golxzn::os::filesystem::write_binary(const std::wstring_view, const std::vector<details::data_view<byte>> &)
+	 *
+	 * @param path Path to the file
+	 * @param pieces Buffers to append in order
+	 * @return golxzn::os::filesystem::error - filesystem::OK or the error
+	 */
+	[[nodiscard]] static error append_binary(const std::wstring_view path,
+		const std::vector<details::data_view<byte>> &pieces);
+
+	/**
+	 * @brief Write text data to a file
+	 *
+	 * @param path Path to the file
+	 * @param text Text to write to the file
+	 * @return golxzn::os::filesystem::error - filesystem::OK or the error
+	 */
+	[[nodiscard]] static error write_text(const std::wstring_view path, const std::string_view text);
+
+	/**
+	 * @brief Write binary data by the checked path, e.g. golxzn::os::filesystem::literal_path
+	 * @details The path isn't validated and normalized again, only its protocol is replaced.
+	 *
+	 * @param path Path to the file
+	 * @param data Data to write
+	 * @return `error` - Error or golxzn::os::filesystem::OK
+	 */
+	[[nodiscard]] static error write_binary(const checked_path path, const details::data_view<byte> &data);
+
+	/**
+	 * @brief Write text by the checked path, e.g. golxzn::os::filesystem::literal_path
+	 *
+	 * @param path Path to the file
+	 * @param text Text to write
+	 * @return `error` - Error or golxzn::os::filesystem::OK
+	 */
+	[[nodiscard]] static error write_text(const checked_path path, const std::string_view text);
+
+	/**
+	 * @brief Append text data to a file
+	 *
+	 * @param path Path to the file
+	 * @param text Text to write to the file
+	 * @return golxzn::os::filesystem::error - filesystem::OK or the error
+	 */
+	[[nodiscard]] static error append_text(const std::wstring_view path, const std::string_view text);
+
+	/**
+	 * @brief Write text data to a file
+	 *
+	 * @param path Path to the file
+	 * @param text Text to write to the file
+	 * @return golxzn::os::filesystem::error - filesystem::OK or the error
+	 */
+	[[nodiscard]] static error write_text(const std::wstring_view path, const std::wstring_view text);
+
+	/**
+	 * @brief Append text data to a file
+	 *
+	 * @param path Path to the file
+	 * @param text Text to write to the file
+	 * @return golxzn::os::filesystem::error - filesystem::OK or the error
+	 */
+	[[nodiscard]] static error append_text(const std::wstring_view path, const std::wstring_view text);
+
+	/**
+	 * @brief Atomically replace a file with binary data
+	 * @details The data is written to a temporary file in the same directory, flushed according
+	 * to @p level and renamed over the destination. A crash or a power loss leaves either the old
+	 * or the new content, never a torn file. Concurrent writers with golxzn::os::filesystem::durability::full
+	 * share a single directory flush instead of serializing on their own ones.
+	 *
+	 * @param path Path to the file
+	 * @param data Data to write to the file
+	 * @param level Durability level
+	 * @return golxzn::os::filesystem::error - filesystem::OK or the error
+	 */
+	[[nodiscard]] static error write_binary_atomic(const std::wstring_view path,
+		const details::data_view<byte> &data, const durability level = durability::data);
+
+	/**
+	 * @brief Atomically replace a file with binary data
+	 *
+	 * @param path Path to the file
+	 * @param data Data to write to the file
+	 * @param level Durability level
+	 * @return golxzn::os::filesystem::error - filesystem::OK or the error
+	 */
+	[[nodiscard]] static error write_binary_atomic(const std::wstring_view path,
+		const std::initializer_list<byte> data, const durability level = durability::data);
+
+	/**
+	 * @brief Atomically replace a file with text
+	 *
+	 * @param path Path to the file
+	 * @param text Text to write to the file
+	 * @param level Durability level
+	 * @return golxzn::os::filesystem::error - filesystem::OK or the error
+	 */
+	[[nodiscard]] static error write_text_atomic(const std::wstring_view path,
+		const std::string_view text, const durability level = durability::data);
+
+	/**
+	 * @brief Atomically replace a file with text
+	 *
+	 * @param path Path to the file
+	 * @param text Text to write to the file
+	 * @param level Durability level
+	 * @return golxzn::os::filesystem::error - filesystem::OK or the error
+	 */
+	[[nodiscard]] static error write_text_atomic(const std::wstring_view path,
+		const std::wstring_view text, const durability level = durability::data);
+
+	/**
+	 * @brief Write only the blocks of the file which have changed
+	 * @details The file is compared with @p data block by block through a read-only mapping, and
+	 * only the changed blocks are written. Then the file is cut or extended to the size of @p data.
+	 * Large files with small changes, like the save files, cost a read of the old content instead
+	 * of a rewrite. The write doesn't go through the write-behind queue, so call
+	 * golxzn::os::filesystem::flush first if the file may be queued.
+	 *
+	 * @param path Path to the file
+	 * @param data New content of the file
+	 * @param mode Whether the file is updated in place or atomically through its clone
+	 * @param block_size Size of the compared blocks
+	 * @return golxzn::os::filesystem::error - filesystem::OK or the error
+	 */
+	[[nodiscard]] static error write_delta(const std::wstring_view path, const details::data_view<byte> &data,
+		const delta_mode mode = delta_mode::in_place, const usize block_size = default_delta_block_size);
+
+	/** @} */
+
+	/** @addtogroup write_behind Write-behind queue
+	 * @{
+	 */
+
+	/**
+	 * @brief Write the files in background instead of the calling thread
+	 * @details While it's enabled, golxzn::os::filesystem::write_binary, golxzn::os::filesystem::write_text,
+	 * golxzn::os::filesystem::append_binary and golxzn::os::filesystem::append_text copy the data into
+	 * the queue and return immediately. A single worker writes the files in the order of their first
+	 * queued write. Successive writes of a file which is still queued are coalesced: a write replaces
+	 * the queued content (the last writer wins), an append is concatenated to it.
+	 *
+	 * Reads don't see the queued writes and removing or moving a queued file races with the worker,
+	 * so call golxzn::os::filesystem::flush first. The atomic writes always go straight to the disk.
+	 * Enabling it again only changes the limit.
+	 *
+	 * @param max_queued_bytes Writers wait for the worker while the queue holds more bytes. A single
+	 * larger write is still accepted into the empty queue
+	 */
+	static void enable_write_behind(const usize max_queued_bytes = default_write_behind_limit);
+
+	/**
+	 * @brief Write everything queued and go back to writing in the calling thread
+	 *
+	 * @return `error` - The earliest failure which hasn't been taken by golxzn::os::filesystem::take_write_failures
+	 */
+	static error disable_write_behind();
+
+	/**
+	 * @brief Check if the writes are queued
+	 *
+	 * @return `bool` - True between golxzn::os::filesystem::enable_write_behind and golxzn::os::filesystem::disable_write_behind
+	 */
+	[[nodiscard]] static bool is_writing_behind() noexcept;
+
+	/**
+	 * @brief Wait until the writes queued before this call are written
+	 * @details Writes queued by other threads during the wait aren't waited for.
+	 *
+	 * @return `error` - The earliest failure which hasn't been taken by golxzn::os::filesystem::take_write_failures
+	 */
+	static error flush();
+
+	/**
+	 * @brief Wait until the queue is empty, including the writes queued during the wait
+	 *
+	 * @return `error` - The earliest failure which hasn't been taken by golxzn::os::filesystem::take_write_failures
+	 */
+	static error drain();
 
-		/**
-		 * @brief Non-implicit conversion to bool
-		 *
-		 * @return `true` - All right. There's no error
-		 * @return `false` - An error occurred
-		 */
-		operator bool() const noexcept;
-	};
-	static inline const error OK{ std::wstring{ none } }; ///< OK struct
+	/**
+	 * @brief Take the failures of the background writes
+	 * @details The failures are kept in their order until they're taken.
+	 *
+	 * @return `std::vector<write_failure>` - Failed writes with their resolved paths
+	 */
+	[[nodiscard]] static std::vector<write_failure> take_write_failures();
 
-	filesystem() = delete;
+	/** @} */
 
-	/** @addtogroup initialization Initialization and setting up
+	/** @addtogroup metadata_cache Metadata cache
 	 * @{
 	 */
 
 	/**
-	 * @brief Initialize the Resource Manager
+	 * @brief Cache the results of exists, is_file and is_directory, the missing paths included
+	 * @details The results are kept by the resolved path for @p ttl, and golxzn::os::filesystem::make_directory
+	 * trusts the cached directories. The writes, copies, moves and removals made through this library
+	 * drop the results of their paths and parents at once. On Linux the directories of the cached paths
+	 * are watched with inotify, so the changes made by everyone else are dropped too. Elsewhere they're
+	 * seen once the result expires. Enabling it again only changes the TTL of the new results.
 	 *
-	 * @param application_name Your application name or the name of the user assets directory
-	 * @param assets_path The name of the assets directory or the full path to the directory.
-	 * If there's [LETTER]:/ or / at the beginning of the string, the path will be used as it is.
-	 * Otherwise the path is relative to the program's directory.
-	 * @return golxzn::os::filesystem::error - The error message or an empty string if there's no error
+	 * @param ttl How long a result is trusted
 	 */
-	[[nodiscard]] static error initialize(const std::wstring_view application_name,
-		const std::wstring_view assets_path = default_assets_directory_name);
+	static void enable_metadata_cache(const std::chrono::milliseconds ttl = default_metadata_ttl);
 
 	/**
-	 * @brief Sets the application name object
-	 * @details Sets the name of the application which is used in the directory path for user data.
-	 * If the name is empty, the default name will be used.
-	 * @warning This method doesn't change the name of the user data directory!
-	 * @param application_name application name
+	 * @brief Stop caching and drop every cached result
 	 */
-	static void set_application_name(const std::wstring_view application_name) noexcept;
+	static void disable_metadata_cache();
 
 	/**
-	 * @brief Add the association between the protocol and the prefix. (ex. L"res://" and L"user://")
-	 * @details Add custom protocol to your application. For example, you could have a L"ab-test://"
-	 * association with your own separated assets directory.
-	 * @warning L"res://", L"user://", L"temp://" are reserved and cannot be used.
-	 * @param protocol Protocol extension (ex. "res://"). Has to end with "://"
-	 * @param prefix Prefix of the path. Has to end with a slash!
+	 * @brief Check if the metadata is cached
+	 *
+	 * @return `bool` - True between golxzn::os::filesystem::enable_metadata_cache and golxzn::os::filesystem::disable_metadata_cache
 	 */
-	static void associate(std::wstring_view protocol, std::wstring &&prefix) noexcept;
+	[[nodiscard]] static bool is_caching_metadata() noexcept;
+
+	/**
+	 * @brief Drop the cached results of the path, its parents and everything under it
+	 * @details For the changes made behind the library's back which cannot be watched.
+	 *
+	 * @param path Path with protocol
+	 */
+	static void invalidate_metadata(const std::wstring_view path);
 
 	/** @} */
 
-	/** @addtogroup read Reading files
+	/** @addtogroup locking Byte-range locks
 	 * @{
 	 */
 
 	/**
-	 * @brief Read whole binary file
+	 * @brief Lock the range of the file, so several processes can work on the different regions at once
+	 * @details The file and its parent directories are created if they're missing. Waiting forever
+	 * blocks in the kernel, a finite timeout polls with a growing pause of up to 10 milliseconds.
 	 *
-	 * @warning This method throws an exception `std::invalid_argument` if the path has no protocol!
 	 * @param path Path to the file
-	 * @return `std::vector<byte>` - The data or an empty vector if there's an reading error.
+	 * @param lock Receives the lock. The lock it held before is released
+	 * @param offset First byte of the range
+	 * @param size Size of the range. 0 means up to the end of the file, including what is appended later
+	 * @param mode Shared or exclusive lock
+	 * @param timeout How long to wait for the conflicting locks to be released
+	 * @return `error` - golxzn::os::filesystem::error_code::locked if the timeout has expired, another error
+	 * or golxzn::os::filesystem::OK
 	 */
-	[[nodiscard]] static std::vector<byte> read_binary(const std::wstring_view path);
+	[[nodiscard]] static error lock(const std::wstring_view path, file_lock &lock, const usize offset = 0,
+		const usize size = 0, const lock_mode mode = lock_mode::exclusive,
+		const std::chrono::milliseconds timeout = wait_forever);
 
 	/**
-	 * @brief Read whole text file
+	 * @brief Lock the range of the file if it's free right now
+	 * @details See golxzn::os::filesystem::lock
 	 *
-	 * @warning This method throws an exception `std::invalid_argument` if the path has no protocol!
 	 * @param path Path to the file
-	 * @return `std::string` - The data or an empty string if there's an reading error.
+	 * @param lock Receives the lock. The lock it held before is released
+	 * @param offset First byte of the range
+	 * @param size Size of the range. 0 means up to the end of the file
+	 * @param mode Shared or exclusive lock
+	 * @return `error` - golxzn::os::filesystem::error_code::locked if the range is busy, another error
+	 * or golxzn::os::filesystem::OK
 	 */
-	[[nodiscard]] static std::string read_text(const std::wstring_view path);
+	[[nodiscard]] static error try_lock(const std::wstring_view path, file_lock &lock, const usize offset = 0,
+		const usize size = 0, const lock_mode mode = lock_mode::exclusive);
 
 	/**
-	 * @brief Construct @p Custom class by binary data from file
+	 * @brief Release the lock. Same as golxzn::os::filesystem::file_lock::unlock
 	 *
-	 * @tparam Custom Class to construct. Has to have a constructor with std::vector<byte> argument
-	 * @param path Path to the file
-	 * @return `Custom` - Constructed class
+	 * @param lock The lock to release
+	 * @return `error` - Error if the range cannot be unlocked
 	 */
-	template<class Custom>
-	[[nodiscard]] static auto read_binary(const std::wstring_view path)
-		-> std::enable_if_t<std::is_constructible_v<Custom, std::vector<byte>>, Custom>;
+	static error unlock(file_lock &lock);
 
 	/**
-	 * @brief Construct @p Custom class by text data from file
+	 * @brief Check if a lock of the range in @p mode would have to wait
+	 * @details Any lock conflicts with golxzn::os::filesystem::lock_mode::exclusive, only the
+	 * exclusive ones conflict with golxzn::os::filesystem::lock_mode::shared. The locks held by
+	 * the calling process count too, except on MacOS. Missing file isn't locked.
 	 *
-	 * @tparam Custom Class to construct. Has to have a constructor with std::string argument
 	 * @param path Path to the file
-	 * @return `Custom` - Constructed class
+	 * @param offset First byte of the range
+	 * @param size Size of the range. 0 means up to the end of the file
+	 * @param mode The mode of the lock to check
+	 * @return `bool` - True if a conflicting lock is held
 	 */
-	template<class Custom>
-	[[nodiscard]] static auto read_text(const std::wstring_view path)
-		-> std::enable_if_t<std::is_constructible_v<Custom, std::string>, Custom>;
+	[[nodiscard]] static bool is_locked(const std::wstring_view path, const usize offset = 0,
+		const usize size = 0, const lock_mode mode = lock_mode::exclusive);
 
 	/**
-	 * @brief Construct @p std::shared_ptr<Custom> by binary data from file
+	 * @brief Check if the range can be locked in @p mode right now
+	 * @details Opposite of golxzn::os::filesystem::is_locked
 	 *
-	 * @tparam Custom Class to construct. Has to have a public constructor with std::vector<byte> argument
 	 * @param path Path to the file
-	 * @return `std::shared_ptr<Custom>` - Constructed shared class
+	 * @param offset First byte of the range
+	 * @param size Size of the range. 0 means up to the end of the file
+	 * @param mode The mode of the lock to check
+	 * @return `bool` - True if no conflicting lock is held
+	 */
+	[[nodiscard]] static bool is_unlocked(const std::wstring_view path, const usize offset = 0,
+		const usize size = 0, const lock_mode mode = lock_mode::exclusive);
+
+	/** @} */
+
+	/** @addtogroup cache Page cache hints
+	 * @{
 	 */
-	template<class Custom>
-	[[nodiscard]] static auto read_shared_binary(const std::wstring_view path)
-		-> std::enable_if_t<std::is_constructible_v<Custom, std::vector<byte>>, std::shared_ptr<Custom>>;
 
 	/**
-	 * @brief Construct @p std::shared_ptr<Custom> by binary data from file
+	 * @brief Warm the page cache up with the files in background
+	 * @details The paths are resolved on the calling thread and read ahead (`readahead`, `F_RDADVISE`
+	 * or reading through the cache manager on Windows) by the background workers, so the calling
+	 * thread doesn't wait for the disk. Missing files are skipped.
 	 *
-	 * @tparam Custom Class to construct. Has to have a public constructor with std::string argument
-	 * @param path Path to the file
-	 * @return `std::shared_ptr<Custom>` - Constructed shared class
+	 * @param paths Paths to the files
+	 * @return `std::future<usize>` - Number of bytes of the files which are in the page cache after prefetching
 	 */
-	template<class Custom>
-	[[nodiscard]] static auto read_shared_text(const std::wstring_view path)
-		-> std::enable_if_t<std::is_constructible_v<Custom, std::string>, std::shared_ptr<Custom>>;
+	[[nodiscard]] static std::future<usize> prefetch(std::vector<std::wstring> paths);
 
 	/**
-	 * @brief Construct @p std::shared_ptr<Custom> by binary data from file
+	 * @brief Warm the page cache up with the files in background
 	 *
-	 * @tparam Custom Class to construct. Has to have a public constructor with std::vector<byte> argument
-	 * @param path Path to the file
-	 * @return `std::unique_ptr<Custom>` - Constructed unique class
+	 * @param paths Paths to the files
+	 * @return `std::future<usize>` - Number of bytes of the files which are in the page cache after prefetching
 	 */
-	template<class Custom>
-	[[nodiscard]] static auto read_unique_binary(const std::wstring_view path)
-		-> std::enable_if_t<std::is_constructible_v<Custom, std::vector<byte>>, std::unique_ptr<Custom>>;
+	[[nodiscard]] static std::future<usize> prefetch(const std::initializer_list<std::wstring_view> paths);
 
 	/**
-	 * @brief Construct @p std::shared_ptr<Custom> by binary data from file
+	 * @brief Drop the files from the page cache in background
+	 * @details Uses `posix_fadvise(POSIX_FADV_DONTNEED)`. Only the clean pages are dropped. MacOS and
+	 * Windows don't support it, so nothing is dropped there.
 	 *
-	 * @tparam Custom Class to construct. Has to have a public constructor with std::string argument
-	 * @param path Path to the file
-	 * @return `std::unique_ptr<Custom>` - Constructed unique class
+	 * @param paths Paths to the files
+	 * @return `std::future<usize>` - Number of bytes dropped from the page cache
 	 */
-	template<class Custom>
-	[[nodiscard]] static auto read_unique_text(const std::wstring_view path)
-		-> std::enable_if_t<std::is_constructible_v<Custom, std::string>, std::unique_ptr<Custom>>;
+	[[nodiscard]] static std::future<usize> evict(std::vector<std::wstring> paths);
 
-	/** @} */
+	/**
+	 * @brief Drop the files from the page cache in background
+	 *
+	 * @param paths Paths to the files
+	 * @return `std::future<usize>` - Number of bytes dropped from the page cache
+	 */
+	[[nodiscard]] static std::future<usize> evict(const std::initializer_list<std::wstring_view> paths);
 
-	/** @addtogroup write Writing files
-	 * @{
+	/**
+	 * @brief Start recording the reads into the access trace
+	 * @details Every successful golxzn::os::filesystem::read_binary and golxzn::os::filesystem::read_text
+	 * call appends the resolved path, the offset and the number of read bytes to the trace in memory.
+	 * Recording a trace which was already started drops the previous records.
 	 */
+	static void start_trace() noexcept;
 
 	/**
-	 * @brief Write binary data to a file
+	 * @brief Stop recording and save the access trace
+	 * @details The trace is a compact versioned binary file. Repeated records are stored once, in the
+	 * order of the first access.
 	 *
-	 * @param path Path to the file
-	 * @param data Data to write to the file
-	 * @return golxzn::os::filesystem::error - The error message or an empty string if there's no error
+	 * @param path Path to the trace file
+	 * @return `error` - Error if the trace wasn't started or cannot be written
 	 */
-	[[nodiscard]] static error write_binary(const std::wstring_view path, const details::data_view<byte> &data);
+	static error stop_trace(const std::wstring_view path = default_trace_path);
 
 	/**
-	 * @brief Write binary data to a file
+	 * @brief Check if the access trace is recording
 	 *
-	 * @param path Path to the file
-	 * @param data Data to write to the file
-	 * @return golxzn::os::filesystem::error - The error message or an empty string if there's no error
+	 * @return `bool` - True if golxzn::os::filesystem::start_trace was called and the trace isn't stopped yet
 	 */
-	[[nodiscard]] static error write_binary(const std::wstring_view path, const std::initializer_list<byte> data);
+	[[nodiscard]] static bool is_tracing() noexcept;
 
 	/**
-	 * @brief Append binary data to a file
+	 * @brief Prefetch everything recorded in the access trace in background
+	 * @details The records are enqueued in the recorded order, so the earliest accesses are warmed up
+	 * first. Missing trace, unknown trace version or missing files aren't errors - they are just skipped.
 	 *
-	 * @param path Path to the file
-	 * @param data Data to write to the file
-	 * @return golxzn::os::filesystem::error - The error message or an empty string if there's no error
+	 * @param path Path to the trace file
+	 * @return `std::future<usize>` - Number of bytes of the recorded ranges which are in the page cache
+	 */
+	[[nodiscard]] static std::future<usize> replay_trace(const std::wstring_view path = default_trace_path);
+
+	/** @} */
+
+	/** @addtogroup index Asset index
+	 * @{
 	 */
-	[[nodiscard]] static error append_binary(const std::wstring_view path, const details::data_view<byte> &data);
 
 	/**
-	 * @brief Append binary data to a file
+	 * @brief Index every file of the association by its golxzn::os::filesystem::asset_id hash
+	 * @details Walks the association's directory once. After that every read and exists by an id of
+	 * this association is an integer hash probe instead of the path resolution. Files created later
+	 * are still found through the usual resolution. The index is dropped when the protocol is
+	 * associated again.
 	 *
-	 * @param path Path to the file
-	 * @param data Data to write to the file
-	 * @return golxzn::os::filesystem::error - The error message or an empty string if there's no error
+	 * @param protocol Protocol of the association, e.g. "res://"
+	 * @return `error` - Error or golxzn::os::filesystem::OK
 	 */
-	[[nodiscard]] static error append_binary(const std::wstring_view path, const std::initializer_list<byte> data);
+	[[nodiscard]] static error build_index(const std::wstring_view protocol);
 
 	/**
-	 * @brief Write text data to a file
+	 * @brief Drop the index of the association
 	 *
-	 * @param path Path to the file
-	 * @param text Text to write to the file
-	 * @return golxzn::os::filesystem::error - The error message or an empty string if there's no error
+	 * @param protocol Protocol of the association, e.g. "res://"
+	 */
+	static void drop_index(const std::wstring_view protocol);
+
+	/** @} */
+
+	/** @addtogroup tracing Tracing
+	 * @{
 	 */
-	[[nodiscard]] static error write_text(const std::wstring_view path, const std::string_view text);
 
 	/**
-	 * @brief Append text data to a file
+	 * @brief Set the sink which receives the spans of the public calls
+	 * @details Pass `nullptr` to stop tracing. Without a sink the tracing costs a single atomic load
+	 * per call. The sink isn't owned, so keep it alive until the calls started with it are finished.
 	 *
-	 * @param path Path to the file
-	 * @param text Text to write to the file
-	 * @return golxzn::os::filesystem::error - The error message or an empty string if there's no error
+	 * @param sink Sink or `nullptr`
 	 */
-	[[nodiscard]] static error append_text(const std::wstring_view path, const std::string_view text);
+	static void set_trace_sink(trace_sink *sink) noexcept;
 
 	/**
-	 * @brief Write text data to a file
+	 * @brief Get the current trace sink
 	 *
-	 * @param path Path to the file
-	 * @param text Text to write to the file
-	 * @return golxzn::os::filesystem::error - The error message or an empty string if there's no error
+	 * @return `trace_sink *` - Sink set by golxzn::os::filesystem::set_trace_sink or `nullptr`
+	 */
+	[[nodiscard]] static trace_sink *get_trace_sink() noexcept;
+
+	/** @} */
+
+#if defined(GXZN_OS_FS_STATISTICS)
+
+	/** @addtogroup statistics I/O statistics
+	 * @details Available only when the library is built with the `GXZN_OS_FS_STATISTICS` CMake option.
+	 * Every thread counts into its own counters, so the operations don't contend with each other.
+	 * Only the outermost public call is counted, e.g. golxzn::os::filesystem::write_binary doesn't
+	 * count the golxzn::os::filesystem::make_directory it does inside.
+	 * @{
 	 */
-	[[nodiscard]] static error write_text(const std::wstring_view path, const std::wstring_view text);
 
 	/**
-	 * @brief Append text data to a file
+	 * @brief Snapshot of the I/O statistics
+	 * @details Merges the counters of every thread since the start or the last
+	 * golxzn::os::filesystem::reset_stats call.
 	 *
-	 * @param path Path to the file
-	 * @param text Text to write to the file
-	 * @return golxzn::os::filesystem::error - The error message or an empty string if there's no error
+	 * @return `statistics` - Statistics per protocol
 	 */
-	[[nodiscard]] static error append_text(const std::wstring_view path, const std::wstring_view text);
+	[[nodiscard]] static statistics stats();
+
+	/** @brief Start counting the I/O statistics from scratch */
+	static void reset_stats();
 
 	/** @} */
 
+#endif // defined(GXZN_OS_FS_STATISTICS)
+
 	/**
 	 * @brief Get the association object
 	 *
@@ -376,6 +1939,14 @@ public:
 	 */
 	[[nodiscard]] static std::wstring join(std::wstring_view left, std::wstring_view right) noexcept;
 
+	/**
+	 * @brief Join two paths with a slash without leaving the inline storage of the buffer.
+	 *
+	 * @param left Path that will be changed
+	 * @param right Path to append
+	 */
+	static void join(path_buffer &left, std::wstring_view right);
+
 	/**
 	 * @brief Remove the last path component.
 	 *
@@ -391,6 +1962,13 @@ public:
 	 */
 	[[nodiscard]] static std::wstring parent_directory(std::wstring_view path) noexcept;
 
+	/**
+	 * @brief Remove the last path component of the buffer.
+	 *
+	 * @param path path
+	 */
+	static void parent_directory(path_buffer &path) noexcept;
+
 	/**
 	 * @brief Fix the path separators to the '/' and remove the trailing slash.
 	 *
@@ -399,6 +1977,61 @@ public:
 	 */
 	[[nodiscard]] static std::wstring normalize(std::wstring_view path);
 
+	/**
+	 * @brief Normalize the path in place.
+	 * @details Already normalized paths are detected by a single scan and left untouched. Others are
+	 * rewritten in a single pass over the same buffer. It only allocates to insert the missing root slash.
+	 *
+	 * @param path Path that will be changed
+	 */
+	static void normalize(std::wstring &path);
+
+	/**
+	 * @brief Normalize the path into the caller's buffer without any allocation.
+	 *
+	 * @param path std::wstring_view path
+	 * @param destination Buffer for the null terminated result. It may be `path.data()` itself
+	 * @param capacity Size of the buffer in characters. Has to be at least `path.size() + 2`
+	 * @return `usize` - Length of the result or `std::wstring_view::npos` if the buffer is too small
+	 */
+	[[nodiscard]] static usize normalize(const std::wstring_view path, wchar_t *destination,
+		const usize capacity) noexcept;
+
+	/**
+	 * @brief Normalize the buffer in place. Doesn't allocate while the path fits the inline storage.
+	 *
+	 * @param path Path that will be changed
+	 */
+	static void normalize(path_buffer &path);
+
+	/**
+	 * @brief Replace the protocol with its association and normalize the path
+	 * @details That's what every method does with its path before touching the filesystem.
+	 *
+	 * @param path Path with or without the protocol prefix
+	 * @return `std::wstring` - Native path
+	 */
+	[[nodiscard]] static std::wstring resolve(const std::wstring_view path);
+
+	/**
+	 * @brief Resolve the path into the buffer
+	 * @details Doesn't allocate while the native path fits the inline storage of the buffer.
+	 *
+	 * @param path Path with or without the protocol prefix
+	 * @param result Buffer for the native path
+	 */
+	static void resolve(const std::wstring_view path, path_buffer &result);
+
+	/**
+	 * @brief Resolve the checked path into the buffer
+	 * @details Only the protocol is replaced with its association. The path is normalized again only
+	 * if the association isn't normalized itself.
+	 *
+	 * @param path Path checked by golxzn::os::filesystem::literal_path
+	 * @param result Buffer for the native path
+	 */
+	static void resolve(const checked_path path, path_buffer &result);
+
 	/** @addtogroup fdmanip Files and directories manipulation
 	 * @{
 	 */
@@ -411,6 +2044,23 @@ public:
 	 */
 	[[nodiscard]] static bool exists(const std::wstring_view path) noexcept;
 
+	/**
+	 * @brief Check if an entry exists by its id
+	 * @details An indexed id costs a hash probe and a single `stat` of the native path.
+	 *
+	 * @param id Id of the directory or the file
+	 * @return `true` if exists, `false` otherwise
+	 */
+	[[nodiscard]] static bool exists(const asset_id &id) noexcept;
+
+	/**
+	 * @brief Check if an entry exists by the checked path, e.g. golxzn::os::filesystem::literal_path
+	 *
+	 * @param path directory or file path
+	 * @return `true` if exists, `false` otherwise
+	 */
+	[[nodiscard]] static bool exists(const checked_path path) noexcept;
+
 	/**
 	 * @brief Check if an entry is a file.
 	 *
@@ -431,7 +2081,7 @@ public:
 	 * @brief Create a directory (recursively).
 	 *
 	 * @param path path to the directory
-	 * @return golxzn::os::filesystem::error - filesystem::OK or the error message
+	 * @return golxzn::os::filesystem::error - filesystem::OK or the error
 	 */
 	[[nodiscard]] static error make_directory(const std::wstring_view path);
 
@@ -439,7 +2089,7 @@ public:
 	 * @brief Remove a directory (recursively).
 	 *
 	 * @param path path to the directory
-	 * @return golxzn::os::filesystem::error - filesystem::OK or the error message
+	 * @return golxzn::os::filesystem::error - filesystem::OK or the error
 	 */
 	[[nodiscard]] static error remove_directory(const std::wstring_view path);
 
@@ -447,7 +2097,7 @@ public:
 	 * @brief Remove a file.
 	 *
 	 * @param path path to the file
-	 * @return golxzn::os::filesystem::error - filesystem::OK or the error message
+	 * @return golxzn::os::filesystem::error - filesystem::OK or the error
 	 */
 	[[nodiscard]] static error remove_file(const std::wstring_view path);
 
@@ -455,13 +2105,52 @@ public:
 	 * @brief List an entry (file or directory).
 	 *
 	 * @param path path to the entry
-	 * @return golxzn::os::filesystem::error - filesystem::OK or the error message
+	 * @return golxzn::os::filesystem::error - filesystem::OK or the error
 	 */
 	[[nodiscard]] static error remove(const std::wstring_view path);
 
-	// [[nodiscard]] static error move_file(const std::wstring_view path, const std::wstring_view destination);
+	/**
+	 * @brief Move a file. The destination file is replaced if it exists.
+	 * @details Within one device the file is just renamed. Otherwise it's copied the same way as
+	 * golxzn::os::filesystem::copy_file does and the source is removed.
+	 *
+	 * @param path path to the file
+	 * @param destination path to the new location. Parent directories are created if needed
+	 * @return golxzn::os::filesystem::error - filesystem::OK or the error
+	 */
+	[[nodiscard]] static error move_file(const std::wstring_view path, const std::wstring_view destination);
+
+	/**
+	 * @brief Copy a file. The destination file is replaced if it exists.
+	 * @details The content never passes through the user space when the platform allows it.
+	 * On Linux the copy is a reflink on copy-on-write filesystems (`FICLONE`), then
+	 * `copy_file_range`, then `sendfile` and only then a buffered copy. MacOS clones the file on APFS
+	 * and Windows relies on `CopyFileExW`. If the destination is the source reached through another
+	 * path (a link, a bind mount or another association), nothing is copied and it's not an error.
+	 *
+	 * @param path path to the file
+	 * @param destination path to the copy. Parent directories are created if needed
+	 * @return golxzn::os::filesystem::error - filesystem::OK or the error
+	 */
+	[[nodiscard]] static error copy_file(const std::wstring_view path, const std::wstring_view destination);
 
-	// [[nodiscard]] static error copy_file(const std::wstring_view path, const std::wstring_view destination);
+	/**
+	 * @brief Copy a directory recursively.
+	 * @details The source tree is walked once, then the destination directories are created and
+	 * the files are copied concurrently on the background workers in the same way as
+	 * golxzn::os::filesystem::copy_file does. Existing destination files are replaced.
+	 * Symbolic links inside the source are skipped. @p progress is called on the calling thread
+	 * whenever some files were copied, and once more when the copying is over.
+	 *
+	 * @param path path to the directory
+	 * @param destination path to the copy. It's created if needed
+	 * @param progress optional progress callback
+	 * @param threads maximum number of workers. 0 means the number of hardware threads. The
+	 * background pool has at most 4 threads, so the larger values don't copy any faster
+	 * @return golxzn::os::filesystem::error - filesystem::OK or the error
+	 */
+	[[nodiscard]] static error copy_directory(const std::wstring_view path, const std::wstring_view destination,
+		const copy_progress_callback &progress = {}, const usize threads = 0);
 
 	/** @} */
 
@@ -512,42 +2201,96 @@ public:
 	/// @brief Narrow string alias for golxzn::os::filesystem::associate(const std::wstring_view, const std::wstring_view)
 	static void associate(const std::string_view protocol, const std::string_view prefix) noexcept;
 
-	/// @brief Narrow string alias for golxzn::os::filesystem::read_binary(const std::wstring_view path)
-	[[nodiscard]] static std::vector<byte> read_binary(const std::string_view path);
+	/// @brief Narrow string alias for golxzn::os::filesystem::read_binary(const std::wstring_view path, const read_mode mode)
+	[[nodiscard]] static std::vector<byte> read_binary(const std::string_view path,
+		const read_mode mode = read_mode::buffered);
 
-	/// @brief Narrow string alias for golxzn::os::filesystem::read_text(const std::wstring_view path)
-	[[nodiscard]] static std::string read_text(const std::string_view path);
+	/// @brief Narrow string alias for golxzn::os::filesystem::read_binary(const std::wstring_view path, const usize offset, const usize size, const read_mode mode)
+	[[nodiscard]] static std::vector<byte> read_binary(const std::string_view path, const usize offset,
+		const usize size, const read_mode mode = read_mode::buffered);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::read_text(const std::wstring_view path, const read_mode mode)
+	[[nodiscard]] static std::string read_text(const std::string_view path,
+		const read_mode mode = read_mode::buffered);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::read_text(const std::wstring_view path, const usize offset, const usize size, const read_mode mode)
+	[[nodiscard]] static std::string read_text(const std::string_view path, const usize offset,
+		const usize size, const read_mode mode = read_mode::buffered);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::read_binary(const asset_id &id, const read_mode mode)
+	[[nodiscard]] static std::vector<byte> read_binary(const asset_id_narrow &id,
+		const read_mode mode = read_mode::buffered);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::read_text(const asset_id &id, const read_mode mode)
+	[[nodiscard]] static std::string read_text(const asset_id_narrow &id,
+		const read_mode mode = read_mode::buffered);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::read_into(const std::wstring_view path, const std::function<byte *(usize)> &destination, const read_mode mode)
+	[[nodiscard]] static error read_into(const std::string_view path,
+		const std::function<byte *(usize)> &destination, const read_mode mode = read_mode::buffered);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::map(const std::wstring_view path)
+	[[nodiscard]] static mapped_file map(const std::string_view path);
+
+#if defined(GXZN_OS_FS_PMR)
+	/// @brief Narrow string alias for golxzn::os::filesystem::read_binary(const std::wstring_view path, std::pmr::memory_resource *resource, const read_mode mode)
+	[[nodiscard]] static std::pmr::vector<byte> read_binary(const std::string_view path,
+		std::pmr::memory_resource *resource, const read_mode mode = read_mode::buffered);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::read_binary(const std::wstring_view path, const usize offset, const usize size, std::pmr::memory_resource *resource, const read_mode mode)
+	[[nodiscard]] static std::pmr::vector<byte> read_binary(const std::string_view path, const usize offset,
+		const usize size, std::pmr::memory_resource *resource, const read_mode mode = read_mode::buffered);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::read_text(const std::wstring_view path, std::pmr::memory_resource *resource, const read_mode mode)
+	[[nodiscard]] static std::pmr::string read_text(const std::string_view path,
+		std::pmr::memory_resource *resource, const read_mode mode = read_mode::buffered);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::read_text(const std::wstring_view path, const usize offset, const usize size, std::pmr::memory_resource *resource, const read_mode mode)
+	[[nodiscard]] static std::pmr::string read_text(const std::string_view path, const usize offset,
+		const usize size, std::pmr::memory_resource *resource, const read_mode mode = read_mode::buffered);
+#endif // defined(GXZN_OS_FS_PMR)
 
 	/// @brief Narrow string alias for golxzn::os::filesystem::read_binary(const std::wstring_view path)
 	template<class Custom>
-	[[nodiscard]] static auto read_binary(const std::string_view path)
-		-> std::enable_if_t<std::is_constructible_v<Custom, std::vector<byte>>, Custom>;
+	[[nodiscard]] static auto read_binary(const std::string_view path,
+		const read_mode mode = read_mode::buffered)
+		-> std::enable_if_t<details::is_loadable_v<Custom>, Custom>;
 
 	/// @brief Narrow string alias for golxzn::os::filesystem::read_text(const std::wstring_view path)
 	template<class Custom>
-	[[nodiscard]] static auto read_text(const std::string_view path)
+	[[nodiscard]] static auto read_text(const std::string_view path,
+		const read_mode mode = read_mode::buffered)
 		-> std::enable_if_t<std::is_constructible_v<Custom, std::string>, Custom>;
 
 	/// @brief Narrow string alias for golxzn::os::filesystem::read_shared_binary(const std::wstring_view path)
 	template<class Custom>
-	[[nodiscard]] static auto read_shared_binary(const std::string_view path)
-		-> std::enable_if_t<std::is_constructible_v<Custom, std::vector<byte>>, std::shared_ptr<Custom>>;
+	[[nodiscard]] static auto read_shared_binary(const std::string_view path,
+		const read_mode mode = read_mode::buffered)
+		-> std::enable_if_t<details::is_loadable_v<Custom>, std::shared_ptr<Custom>>;
 
 	/// @brief Narrow string alias for golxzn::os::filesystem::read_shared_text(const std::wstring_view path)
 	template<class Custom>
-	[[nodiscard]] static auto read_shared_text(const std::string_view path)
+	[[nodiscard]] static auto read_shared_text(const std::string_view path,
+		const read_mode mode = read_mode::buffered)
 		-> std::enable_if_t<std::is_constructible_v<Custom, std::string>, std::shared_ptr<Custom>>;
 
 	/// @brief Narrow string alias for golxzn::os::filesystem::read_unique_binary(const std::wstring_view path)
 	template<class Custom>
-	[[nodiscard]] static auto read_unique_binary(const std::string_view path)
-		-> std::enable_if_t<std::is_constructible_v<Custom, std::vector<byte>>, std::unique_ptr<Custom>>;
+	[[nodiscard]] static auto read_unique_binary(const std::string_view path,
+		const read_mode mode = read_mode::buffered)
+		-> std::enable_if_t<details::is_loadable_v<Custom>, std::unique_ptr<Custom>>;
 
 	/// @brief Narrow string alias for golxzn::os::filesystem::read_unique_text(const std::wstring_view path)
 	template<class Custom>
-	[[nodiscard]] static auto read_unique_text(const std::string_view path)
+	[[nodiscard]] static auto read_unique_text(const std::string_view path,
+		const read_mode mode = read_mode::buffered)
 		-> std::enable_if_t<std::is_constructible_v<Custom, std::string>, std::unique_ptr<Custom>>;
 
+	/// @brief Narrow string alias for golxzn::os::filesystem::load_into(const std::wstring_view path, Custom &custom, const read_mode mode)
+	template<class Custom>
+	[[nodiscard]] static error load_into(const std::string_view path, Custom &custom,
+		const read_mode mode = read_mode::buffered);
+
 	/// @brief Narrow string alias for golxzn::os::filesystem::write_binary(const std::wstring_view path, const details::data_view<byte> &data)
 	[[nodiscard]] static error write_binary(const std::string_view path, const details::data_view<byte> &data);
 
@@ -560,6 +2303,22 @@ public:
 	/// @brief Narrow string alias for golxzn::os::filesystem::append_binary(const std::wstring_view path, const std::initializer_list<byte> data)
 	[[nodiscard]] static error append_binary(const std::string_view path, const std::initializer_list<byte> data);
 
+	/// @brief Narrow string alias for golxzn::os::filesystem::write_binary(const std::wstring_view path, const std::initializer_list<details::data_view<byte>> pieces)
+	[[nodiscard]] static error write_binary(const std::string_view path,
+		const std::initializer_list<details::data_view<byte>> pieces);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::write_binary(const std::wstring_view path, const std::vector<details::data_view<byte>> &pieces)
+	[[nodiscard]] static error write_binary(const std::string_view path,
+		const std::vector<details::data_view<byte>> &pieces);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::append_binary(const std::wstring_view path, const std::initializer_list<details::data_view<byte>> pieces)
+	[[nodiscard]] static error append_binary(const std::string_view path,
+		const std::initializer_list<details::data_view<byte>> pieces);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::append_binary(const std::wstring_view path, const std::vector<details::data_view<byte>> &pieces)
+	[[nodiscard]] static error append_binary(const std::string_view path,
+		const std::vector<details::data_view<byte>> &pieces);
+
 	/// @brief Narrow string alias for golxzn::os::filesystem::write_text(const std::wstring_view path, const std::string_view text)
 	[[nodiscard]] static error write_text(const std::string_view path, const std::string_view text);
 
@@ -572,6 +2331,70 @@ public:
 	/// @brief Narrow string alias for golxzn::os::filesystem::append_text(const std::wstring_view path, const std::wstring_view text)
 	[[nodiscard]] static error append_text(const std::string_view path, const std::wstring_view text);
 
+	/// @brief Narrow string alias for golxzn::os::filesystem::write_binary_atomic(const std::wstring_view path, const details::data_view<byte> &data, const durability level)
+	[[nodiscard]] static error write_binary_atomic(const std::string_view path,
+		const details::data_view<byte> &data, const durability level = durability::data);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::write_binary_atomic(const std::wstring_view path, const std::initializer_list<byte> data, const durability level)
+	[[nodiscard]] static error write_binary_atomic(const std::string_view path,
+		const std::initializer_list<byte> data, const durability level = durability::data);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::write_text_atomic(const std::wstring_view path, const std::string_view text, const durability level)
+	[[nodiscard]] static error write_text_atomic(const std::string_view path,
+		const std::string_view text, const durability level = durability::data);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::write_text_atomic(const std::wstring_view path, const std::wstring_view text, const durability level)
+	[[nodiscard]] static error write_text_atomic(const std::string_view path,
+		const std::wstring_view text, const durability level = durability::data);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::write_delta(const std::wstring_view path, const details::data_view<byte> &data, const delta_mode mode, const usize block_size)
+	[[nodiscard]] static error write_delta(const std::string_view path, const details::data_view<byte> &data,
+		const delta_mode mode = delta_mode::in_place, const usize block_size = default_delta_block_size);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::prefetch(std::vector<std::wstring> paths)
+	[[nodiscard]] static std::future<usize> prefetch(const std::vector<std::string> &paths);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::prefetch(const std::initializer_list<std::wstring_view> paths)
+	[[nodiscard]] static std::future<usize> prefetch(const std::initializer_list<std::string_view> paths);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::evict(std::vector<std::wstring> paths)
+	[[nodiscard]] static std::future<usize> evict(const std::vector<std::string> &paths);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::evict(const std::initializer_list<std::wstring_view> paths)
+	[[nodiscard]] static std::future<usize> evict(const std::initializer_list<std::string_view> paths);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::build_index(const std::wstring_view protocol)
+	[[nodiscard]] static error build_index(const std::string_view protocol);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::drop_index(const std::wstring_view protocol)
+	static void drop_index(const std::string_view protocol);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::stop_trace(const std::wstring_view path)
+	static error stop_trace(const std::string_view path);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::lock(const std::wstring_view path, file_lock &lock, const usize offset, const usize size, const lock_mode mode, const std::chrono::milliseconds timeout)
+	[[nodiscard]] static error lock(const std::string_view path, file_lock &lock, const usize offset = 0,
+		const usize size = 0, const lock_mode mode = lock_mode::exclusive,
+		const std::chrono::milliseconds timeout = wait_forever);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::try_lock(const std::wstring_view path, file_lock &lock, const usize offset, const usize size, const lock_mode mode)
+	[[nodiscard]] static error try_lock(const std::string_view path, file_lock &lock, const usize offset = 0,
+		const usize size = 0, const lock_mode mode = lock_mode::exclusive);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::is_locked(const std::wstring_view path, const usize offset, const usize size, const lock_mode mode)
+	[[nodiscard]] static bool is_locked(const std::string_view path, const usize offset = 0,
+		const usize size = 0, const lock_mode mode = lock_mode::exclusive);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::is_unlocked(const std::wstring_view path, const usize offset, const usize size, const lock_mode mode)
+	[[nodiscard]] static bool is_unlocked(const std::string_view path, const usize offset = 0,
+		const usize size = 0, const lock_mode mode = lock_mode::exclusive);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::invalidate_metadata(const std::wstring_view path)
+	static void invalidate_metadata(const std::string_view path);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::replay_trace(const std::wstring_view path)
+	[[nodiscard]] static std::future<usize> replay_trace(const std::string_view path);
+
 	/// @brief Narrow string alias for golxzn::os::filesystem::get_association(const std::wstring_view protocol)
 	[[nodiscard]] static std::wstring_view get_association(const std::string_view protocol) noexcept;
 
@@ -581,18 +2404,40 @@ public:
 	/// @brief Narrow string alias for golxzn::os::filesystem::join(std::wstring_view left, std::wstring_view right)
 	[[nodiscard]] static std::string join(std::string_view left, std::string_view right) noexcept;
 
+	/// @brief Narrow string alias for golxzn::os::filesystem::join(path_buffer &left, std::wstring_view right)
+	static void join(path_buffer_narrow &left, std::string_view right);
+
 	/// @brief Narrow string alias for golxzn::os::filesystem::parent_directory(std::wstring &path)
 	static void parent_directory(std::string &path) noexcept;
 
 	/// @brief Narrow string alias for golxzn::os::filesystem::parent_directory(std::wstring_view path)
 	[[nodiscard]] static std::string parent_directory(std::string_view path) noexcept;
 
+	/// @brief Narrow string alias for golxzn::os::filesystem::parent_directory(path_buffer &path)
+	static void parent_directory(path_buffer_narrow &path) noexcept;
+
 	/// @brief Narrow string alias for golxzn::os::filesystem::normalize(const std::wstring_view path)
 	[[nodiscard]] static std::wstring normalize(const std::string_view path);
 
+	/// @brief Narrow string alias for golxzn::os::filesystem::normalize(std::wstring &path)
+	static void normalize(std::string &path);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::normalize(path_buffer &path)
+	static void normalize(path_buffer_narrow &path);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::normalize(const std::wstring_view path, wchar_t *destination, const usize capacity)
+	[[nodiscard]] static usize normalize(const std::string_view path, char *destination,
+		const usize capacity) noexcept;
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::resolve(const std::wstring_view path)
+	[[nodiscard]] static std::wstring resolve(const std::string_view path);
+
 	/// @brief Narrow string alias for golxzn::os::filesystem::exists(const std::wstring_view path)
 	[[nodiscard]] static bool exists(const std::string_view path) noexcept;
 
+	/// @brief Narrow string alias for golxzn::os::filesystem::exists(const asset_id &id)
+	[[nodiscard]] static bool exists(const asset_id_narrow &id) noexcept;
+
 	/// @brief Narrow string alias for golxzn::os::filesystem::is_file(const std::wstring_view path)
 	[[nodiscard]] static bool is_file(const std::string_view path);
 
@@ -611,6 +2456,16 @@ public:
 	/// @brief Narrow string alias for golxzn::os::filesystem::remove(const std::wstring_view path)
 	[[nodiscard]] static error remove(const std::string_view path);
 
+	/// @brief Narrow string alias for golxzn::os::filesystem::move_file(const std::wstring_view path, const std::wstring_view destination)
+	[[nodiscard]] static error move_file(const std::string_view path, const std::string_view destination);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::copy_file(const std::wstring_view path, const std::wstring_view destination)
+	[[nodiscard]] static error copy_file(const std::string_view path, const std::string_view destination);
+
+	/// @brief Narrow string alias for golxzn::os::filesystem::copy_directory(const std::wstring_view path, const std::wstring_view destination, const copy_progress_callback &progress, const usize threads)
+	[[nodiscard]] static error copy_directory(const std::string_view path, const std::string_view destination,
+		const copy_progress_callback &progress = {}, const usize threads = 0);
+
 	/// @brief Narrow stirng alias for golxzn::os::filesystem::entries(const std::wstring_view path)
 	[[nodiscard]] static std::vector<std::string> entries(const std::string_view path);
 
@@ -622,7 +2477,19 @@ private:
 	static associations_type associations_map;
 
 	static std::wstring_view get_protocol(const std::wstring_view path) noexcept;
-	static std::wstring replace_association_prefix(std::wstring_view path) noexcept;
+	static path_buffer replace_association_prefix(std::wstring_view path) noexcept;
+#if defined(GXZN_OS_FS_PMR)
+	static std::pmr::wstring replace_association_prefix(std::wstring_view path, std::pmr::memory_resource *resource);
+#endif // defined(GXZN_OS_FS_PMR)
+	static error make_checked_parent(const checked_path path, const std::wstring_view native);
+	static error write_pieces(const char *operation, const std::wstring_view path,
+		const details::data_view<byte> *pieces, const usize count, const bool append);
+
+	/** Builds the @p Result of read_*_binary<Custom> by golxzn::os::loader_traits. @p make constructs it */
+	template<class Custom, class Result, class Make>
+	static Result load(const std::wstring_view path, const read_mode mode, Make &&make);
+	template<class Custom, class Result, class Make>
+	static Result load(const std::string_view path, const read_mode mode, Make &&make);
 	static std::wstring setup_assets_directories(const std::wstring_view assets_path);
 	static std::wstring setup_user_data_directory();
 };
@@ -632,77 +2499,129 @@ using fs = filesystem;
 //======================================== Implementation ========================================//
 
 template<class Custom>
-auto filesystem::read_binary(const std::wstring_view path)
-	-> std::enable_if_t<std::is_constructible_v<Custom, std::vector<byte>>, Custom> {
-	return Custom{ read_binary(path) };
+auto filesystem::read_binary(const std::wstring_view path, const read_mode mode)
+	-> std::enable_if_t<details::is_loadable_v<Custom>, Custom> {
+	return load<Custom, Custom>(path, mode, [](auto &&...args) {
+		return Custom{ std::forward<decltype(args)>(args)... };
+	});
 }
 template<class Custom>
-auto filesystem::read_text(const std::wstring_view path)
+auto filesystem::read_text(const std::wstring_view path, const read_mode mode)
 	-> std::enable_if_t<std::is_constructible_v<Custom, std::string>, Custom> {
-	return Custom{ read_text(path) };
+	return Custom{ read_text(path, mode) };
 }
 
 template<class Custom>
-auto filesystem::read_shared_binary(const std::wstring_view path)
-	-> std::enable_if_t<std::is_constructible_v<Custom, std::vector<byte>>, std::shared_ptr<Custom>> {
-	return std::make_shared<Custom>(read_binary(path));
+auto filesystem::read_shared_binary(const std::wstring_view path, const read_mode mode)
+	-> std::enable_if_t<details::is_loadable_v<Custom>, std::shared_ptr<Custom>> {
+	return load<Custom, std::shared_ptr<Custom>>(path, mode, [](auto &&...args) {
+		return std::make_shared<Custom>(std::forward<decltype(args)>(args)...);
+	});
 }
 
 template<class Custom>
-auto filesystem::read_shared_text(const std::wstring_view path)
+auto filesystem::read_shared_text(const std::wstring_view path, const read_mode mode)
 	-> std::enable_if_t<std::is_constructible_v<Custom, std::string>, std::shared_ptr<Custom>> {
-	return std::make_shared<Custom>(read_text(path));
+	return std::make_shared<Custom>(read_text(path, mode));
 }
 
 template<class Custom>
-auto filesystem::read_unique_binary(const std::wstring_view path)
-	-> std::enable_if_t<std::is_constructible_v<Custom, std::vector<byte>>, std::unique_ptr<Custom>> {
-	return std::make_unique<Custom>(read_binary(path));
+auto filesystem::read_unique_binary(const std::wstring_view path, const read_mode mode)
+	-> std::enable_if_t<details::is_loadable_v<Custom>, std::unique_ptr<Custom>> {
+	return load<Custom, std::unique_ptr<Custom>>(path, mode, [](auto &&...args) {
+		return std::make_unique<Custom>(std::forward<decltype(args)>(args)...);
+	});
 }
 
 template<class Custom>
-auto filesystem::read_unique_text(const std::wstring_view path)
+auto filesystem::read_unique_text(const std::wstring_view path, const read_mode mode)
 	-> std::enable_if_t<std::is_constructible_v<Custom, std::string>, std::unique_ptr<Custom>> {
-	return std::make_unique<Custom>(read_text(path));
+	return std::make_unique<Custom>(read_text(path, mode));
 }
 
 
 template<class Custom>
-auto filesystem::read_binary(const std::string_view path)
-	-> std::enable_if_t<std::is_constructible_v<Custom, std::vector<byte>>, Custom> {
-	return Custom{ read_binary(path) };
+auto filesystem::read_binary(const std::string_view path, const read_mode mode)
+	-> std::enable_if_t<details::is_loadable_v<Custom>, Custom> {
+	return load<Custom, Custom>(path, mode, [](auto &&...args) {
+		return Custom{ std::forward<decltype(args)>(args)... };
+	});
 }
 template<class Custom>
-auto filesystem::read_text(const std::string_view path)
+auto filesystem::read_text(const std::string_view path, const read_mode mode)
 	-> std::enable_if_t<std::is_constructible_v<Custom, std::string>, Custom> {
-	return Custom{ read_text(path) };
+	return Custom{ read_text(path, mode) };
 }
 
 template<class Custom>
-auto filesystem::read_shared_binary(const std::string_view path)
-	-> std::enable_if_t<std::is_constructible_v<Custom, std::vector<byte>>, std::shared_ptr<Custom>> {
-	return std::make_shared<Custom>(read_binary(path));
+auto filesystem::read_shared_binary(const std::string_view path, const read_mode mode)
+	-> std::enable_if_t<details::is_loadable_v<Custom>, std::shared_ptr<Custom>> {
+	return load<Custom, std::shared_ptr<Custom>>(path, mode, [](auto &&...args) {
+		return std::make_shared<Custom>(std::forward<decltype(args)>(args)...);
+	});
 }
 
 template<class Custom>
-auto filesystem::read_shared_text(const std::string_view path)
+auto filesystem::read_shared_text(const std::string_view path, const read_mode mode)
 	-> std::enable_if_t<std::is_constructible_v<Custom, std::string>, std::shared_ptr<Custom>> {
-	return std::make_shared<Custom>(read_text(path));
+	return std::make_shared<Custom>(read_text(path, mode));
 }
 
 template<class Custom>
-auto filesystem::read_unique_binary(const std::string_view path)
-	-> std::enable_if_t<std::is_constructible_v<Custom, std::vector<byte>>, std::unique_ptr<Custom>> {
-	return std::make_unique<Custom>(read_binary(path));
+auto filesystem::read_unique_binary(const std::string_view path, const read_mode mode)
+	-> std::enable_if_t<details::is_loadable_v<Custom>, std::unique_ptr<Custom>> {
+	return load<Custom, std::unique_ptr<Custom>>(path, mode, [](auto &&...args) {
+		return std::make_unique<Custom>(std::forward<decltype(args)>(args)...);
+	});
 }
 
 template<class Custom>
-auto filesystem::read_unique_text(const std::string_view path)
+auto filesystem::read_unique_text(const std::string_view path, const read_mode mode)
 	-> std::enable_if_t<std::is_constructible_v<Custom, std::string>, std::unique_ptr<Custom>> {
-	return std::make_unique<Custom>(read_text(path));
+	return std::make_unique<Custom>(read_text(path, mode));
+}
+
+
+template<class Custom, class Result, class Make>
+Result filesystem::load(const std::wstring_view path, const read_mode mode, Make &&make) {
+	constexpr auto strategy{ loader_traits<Custom>::strategy };
+
+	if constexpr (strategy == load_strategy::mapping) {
+		return make(map(path));
+	} else if constexpr (strategy == load_strategy::view) {
+		if (mode == read_mode::direct) {
+			const auto content{ read_binary(path, mode) };
+			return make(details::data_view<byte>{ content.data(), content.size() });
+		}
+		const auto mapping{ map(path) };
+		return make(mapping.view());
+	} else if constexpr (strategy == load_strategy::in_place) {
+		auto result{ make() };
+		if (load_into(path, details::loaded_object(result), mode).has_error()) [[unlikely]] {
+			return make(); // Nothing of a partial read is left
+		}
+		return result;
+	} else {
+		return make(read_binary(path, mode));
+	}
+}
+
+template<class Custom, class Result, class Make>
+Result filesystem::load(const std::string_view path, const read_mode mode, Make &&make) {
+	return load<Custom, Result>(to_wide(path), mode, std::forward<Make>(make));
 }
 
+template<class Custom>
+filesystem::error filesystem::load_into(const std::wstring_view path, Custom &custom, const read_mode mode) {
+	return read_into(path, [&custom](const usize size) {
+		return loader_traits<Custom>::destination(custom, size);
+	}, mode);
+}
 
+template<class Custom>
+filesystem::error filesystem::load_into(const std::string_view path, Custom &custom, const read_mode mode) {
+	return load_into(to_wide(path), custom, mode);
+}
 
 } // namespace golxzn::os
 
@@ -1,13 +1,26 @@
+#include <map>
+#include <set>
+#include <array>
 #include <deque>
+#include <mutex>
+#include <tuple>
+#include <atomic>
+#include <thread>
 #include <vector>
+#include <limits>
 #include <cstdlib>
 #include <numeric>
 #include <utility>
 #include <fstream>
+#include <optional>
 #include <algorithm>
+#include <shared_mutex>
+#include <condition_variable>
 
 #include "golxzn/os/filesystem.hpp"
 
+#include "instrumentation.inl"
+#include "path.inl"
 
 #if defined(GXZN_OS_FS_WINDOWS)
 # include "platform/win.inl"
@@ -24,57 +37,1284 @@ namespace golxzn::os {
 
 namespace details {
 
+/**
+ * Directories known to exist, grouped by the association (protocol) they were created through.
+ * It lets make_directory() and every write_* skip the filesystem entirely for parents which were
+ * already created or checked. Entries are dropped when the association changes or the directory
+ * is removed through this library.
+ */
+class known_directories {
+public:
+	/** Called before every write, so it neither allocates nor blocks the other lookups */
+	bool contains(const std::wstring_view protocol, const std::wstring_view path) {
+		std::shared_lock lock{ guard };
+		if (const auto found{ cache.find(protocol) }; found != std::end(cache)) {
+			return found->second.find(path) != std::end(found->second);
+		}
+		return false;
+	}
+
+	void remember(const std::wstring_view protocol, std::wstring path) {
+		std::lock_guard lock{ guard };
+		auto found{ cache.find(protocol) };
+		if (found == std::end(cache)) [[unlikely]] {
+			found = cache.emplace(std::wstring{ protocol }, paths{}).first;
+		}
+		found->second.emplace(std::move(path));
+	}
+
+	void forget_association(const std::wstring &protocol) {
+		std::lock_guard lock{ guard };
+		cache.erase(protocol);
+	}
+
+	void forget(const std::wstring_view path) {
+		const auto is_inside = [path](const std::wstring &entry) {
+			return entry.size() == path.size() || entry[path.size()] == filesystem::separator;
+		};
+
+		std::lock_guard lock{ guard };
+		for (auto &[_, directories] : cache) {
+			// The entries starting with the path are sorted next to each other
+			for (auto entry{ directories.lower_bound(path) };
+					entry != std::end(directories) && entry->rfind(path, 0) == 0; ) {
+				entry = is_inside(*entry) ? directories.erase(entry) : std::next(entry);
+			}
+		}
+	}
+
+private:
+	using paths = std::set<std::wstring, std::less<>>;
+
+	std::shared_mutex guard;
+	std::map<std::wstring, paths, std::less<>> cache;
+};
+
+static known_directories directories;
+
+/**
+ * Native paths of the files of the indexed associations by their asset_id hashes, so a lookup by
+ * an id is a single probe. Filled by filesystem::build_index() and dropped with the association.
+ * Each file keeps its id path too, so an id which only shares the hash falls back to the resolution.
+ */
+class asset_index {
+public:
+	struct file {
+		u64 hash;
+		std::wstring id; ///< The protocol and the relative path with `/` separators only
+		std::wstring path;
+	};
+
+	bool find(const filesystem::asset_id &id, filesystem::path_buffer &path) {
+		std::shared_lock lock{ guard };
+		if (const auto found{ files.find(id.hash()) }; found != std::end(files) && names(found->second.id, id)) [[likely]] {
+			path = found->second.path;
+			return true;
+		}
+		return false;
+	}
+
+	/** The narrow ids get the indexed wide id as well, so the measurements need no conversion */
+	bool find(const filesystem::asset_id_narrow &id, filesystem::path_buffer &path, filesystem::path_buffer &wide_id) {
+		std::shared_lock lock{ guard };
+		if (const auto found{ files.find(id.hash()) }; found != std::end(files) && names(found->second.id, id)) [[likely]] {
+			path = found->second.path;
+			wide_id = found->second.id;
+			return true;
+		}
+		return false;
+	}
+
+	/** The first file of a hash stays indexed, the ones colliding with it are left to the resolution */
+	void replace(const std::wstring_view protocol, std::vector<file> entries) {
+		const auto protocol_hash{ hash_text(fnv1a_offset, protocol) };
+		std::unique_lock lock{ guard };
+		erase(protocol_hash);
+		files.reserve(files.size() + entries.size());
+		for (auto &[hash, id, path] : entries) {
+			files.try_emplace(hash, entry{ protocol_hash, std::move(id), std::move(path) });
+		}
+	}
+
+	void forget_association(const std::wstring_view protocol) {
+		const auto protocol_hash{ hash_text(fnv1a_offset, protocol) };
+		std::unique_lock lock{ guard };
+		erase(protocol_hash);
+	}
+
+private:
+	struct entry {
+		u64 protocol;
+		std::wstring id;
+		std::wstring path;
+	};
+
+	std::shared_mutex guard;
+	std::unordered_map<u64, entry> files;
+
+	/**
+	 * Compares the relative path the way hash_relative_path hashes it, so no copy is needed. The
+	 * narrow ids match in ASCII only, the rest is left to the resolution
+	 */
+	template<class Char>
+	static bool names(const std::wstring_view indexed, const basic_asset_id<Char> &id) noexcept {
+		const auto same = [](const wchar_t left, const Char right) {
+			if constexpr (sizeof(Char) == 1) {
+				return static_cast<unsigned char>(right) < 0x80 && left == static_cast<wchar_t>(right);
+			} else {
+				return left == right;
+			}
+		};
+
+		usize position{};
+		for (const auto c : id.protocol()) {
+			if (position == indexed.size() || !same(indexed[position++], c)) return false;
+		}
+		relative_path_reader<Char> relative{ id.relative() };
+		for (auto c{ relative.next() }; c != Char{}; c = relative.next()) {
+			if (position == indexed.size() || !same(indexed[position++], c)) return false;
+		}
+		return position == indexed.size();
+	}
+
+	void erase(const u64 protocol) {
+		for (auto file{ std::begin(files) }; file != std::end(files); ) {
+			file = file->second.protocol == protocol ? files.erase(file) : std::next(file);
+		}
+	}
+};
+
+static asset_index assets;
+
+/**
+ * Types of the resolved paths, the missing ones included, while filesystem::enable_metadata_cache
+ * is on. A result expires after the TTL. The library drops the results of the paths it changes,
+ * and the change_watcher of the platform drops the ones changed by everyone else. A result is
+ * remembered only if nothing was dropped since its stat began, so it can't outlive a change.
+ */
+class metadata_cache {
+public:
+	~metadata_cache() { disable(); }
+
+	bool enabled() const noexcept { return active.load(std::memory_order_acquire); }
+
+	void enable(const std::chrono::milliseconds lifetime) {
+		std::lock_guard lifecycle_lock{ lifecycle };
+		{
+			std::unique_lock lock{ guard };
+			ttl = std::max(lifetime, std::chrono::milliseconds::zero());
+		}
+		if (enabled()) return;
+
+		watching.store(watcher.start([this](const std::wstring_view path, const bool tree) {
+			if (path.empty()) clear(); else forget(path, tree);
+		}), std::memory_order_release);
+		active.store(true, std::memory_order_release);
+	}
+
+	void disable() {
+		std::lock_guard lifecycle_lock{ lifecycle };
+		active.store(false, std::memory_order_release);
+		if (watching.exchange(false, std::memory_order_acq_rel)) watcher.stop();
+		clear();
+	}
+
+	/** The cached type of @p full_path, if it hasn't expired yet */
+	std::optional<entry_type> find(const std::wstring_view full_path) const {
+		return find(hash_text(fnv1a_offset, full_path), full_path, clock::now());
+	}
+
+	/** The type of @p full_path, cached or queried and remembered */
+	entry_type type(const std::wstring_view full_path) {
+		const auto hash{ hash_text(fnv1a_offset, full_path) };
+		const auto now{ clock::now() };
+		if (const auto cached{ find(hash, full_path, now) }) [[likely]] return *cached;
+
+		// The watch goes first, so a change during the stat is either seen by it or dropped later
+		if (watching.load(std::memory_order_acquire)) {
+			filesystem::path_buffer parent{ full_path };
+			filesystem::parent_directory(parent);
+			watcher.watch(parent);
+		}
+		const auto seen{ generation.load(std::memory_order_acquire) };
+		const auto result{ type_of(full_path) };
+
+		std::unique_lock lock{ guard };
+		if (generation.load(std::memory_order_relaxed) != seen || !enabled()) return result;
+		if (entries.size() >= max_entries) {
+			for (auto entry{ std::begin(entries) }; entry != std::end(entries); ) {
+				entry = entry->second.expires <= now ? entries.erase(entry) : std::next(entry);
+			}
+			if (entries.size() >= max_entries) entries.clear();
+		}
+		entries.insert_or_assign(hash, entry{ std::wstring{ full_path }, result, now + ttl });
+		return result;
+	}
+
+	/** Drops @p full_path and its parents, and with @p tree everything under it */
+	void forget(const std::wstring_view full_path, const bool tree = false) {
+		std::unique_lock lock{ guard };
+		generation.fetch_add(1, std::memory_order_acq_rel);
+		if (entries.empty()) return;
+
+		for (auto path{ full_path }; !path.empty(); ) {
+			if (const auto found{ entries.find(hash_text(fnv1a_offset, path)) };
+					found != std::end(entries) && found->second.path == path) {
+				entries.erase(found);
+			}
+			const auto slash{ path.rfind(filesystem::separator) };
+			path = slash == std::wstring_view::npos || slash == 0 ? std::wstring_view{} : path.substr(0, slash);
+		}
+		if (!tree) return;
+
+		const auto is_inside = [full_path](const std::wstring &path) {
+			return path.size() > full_path.size() && path[full_path.size()] == filesystem::separator
+				&& path.compare(0, full_path.size(), full_path) == 0;
+		};
+		for (auto entry{ std::begin(entries) }; entry != std::end(entries); ) {
+			entry = is_inside(entry->second.path) ? entries.erase(entry) : std::next(entry);
+		}
+	}
+
+	void clear() {
+		std::unique_lock lock{ guard };
+		generation.fetch_add(1, std::memory_order_acq_rel);
+		entries.clear();
+	}
+
+private:
+	using clock = std::chrono::steady_clock;
+	static constexpr usize max_entries{ 64 * 1024 };
+
+	struct entry {
+		std::wstring path;
+		entry_type type;
+		clock::time_point expires;
+	};
+
+	std::mutex lifecycle;
+	mutable std::shared_mutex guard;
+	std::unordered_map<u64, entry> entries;
+	std::chrono::milliseconds ttl{};
+	std::atomic<u64> generation{ 0 };
+	std::atomic<bool> active{ false };
+	std::atomic<bool> watching{ false };
+	change_watcher watcher;
+
+	std::optional<entry_type> find(const u64 hash, const std::wstring_view full_path, const clock::time_point now) const {
+		std::shared_lock lock{ guard };
+		if (const auto found{ entries.find(hash) }; found != std::end(entries) &&
+				found->second.expires > now && found->second.path == full_path) {
+			return found->second.type;
+		}
+		return std::nullopt;
+	}
+};
+
+static metadata_cache metadata;
+
+/** Drops the cached metadata of a path changed by the library. With @p tree, of everything under it too */
+void changed(const std::wstring_view full_path, const bool tree = false) {
+	if (metadata.enabled()) [[unlikely]] metadata.forget(full_path, tree);
+}
+
+/** The protocol with the trailing "://", as it's stored in the associations */
+std::wstring protocol_key(const std::wstring_view protocol) {
+	std::wstring key{ protocol };
+	const auto rbegin{ std::rbegin(protocol) };
+	const auto ends_with_separator{ protocol.size() >= filesystem::protocol_separator.size() &&
+		std::equal(rbegin, std::next(rbegin, filesystem::protocol_separator.size()),
+			std::rbegin(filesystem::protocol_separator))
+	};
+	if (!ends_with_separator) [[unlikely]] {
+		key += filesystem::protocol_separator;
+	}
+	return key;
+}
+
+/** Pool of workers for the requests the callers don't want to wait for */
+class background_queue {
+public:
+	~background_queue() {
+		{
+			std::lock_guard lock{ guard };
+			stopping = true;
+		}
+		available.notify_all();
+		for (auto &worker : workers) worker.join();
+	}
+
+	void push(std::function<void()> task) {
+		{
+			std::lock_guard lock{ guard };
+			if (workers.empty()) [[unlikely]] start();
+			tasks.emplace_back(std::move(task));
+		}
+		available.notify_one();
+	}
+
+private:
+	std::mutex guard;
+	std::condition_variable available;
+	std::deque<std::function<void()>> tasks;
+	std::vector<std::thread> workers;
+	bool stopping{ false };
+
+	void start() {
+		const auto count{ std::clamp(std::thread::hardware_concurrency(), 2u, 4u) };
+		for (u16 i{}; i < count; ++i) {
+			workers.emplace_back([this] { run(); });
+		}
+	}
+
+	void run() {
+		while (true) {
+			std::unique_lock lock{ guard };
+			available.wait(lock, [this] { return stopping || !tasks.empty(); });
+			if (stopping) return;
+
+			auto task{ std::move(tasks.front()) };
+			tasks.pop_front();
+			lock.unlock();
+
+			try {
+				task();
+			} catch (...) {
+				// A failed hint must not take the whole process down
+			}
+		}
+	}
+};
+
+extern background_queue background;
+
+/** Runs @p operation for every item in background in their order and sums up the results */
+template<class Item, class Operation>
+std::future<usize> schedule_for_each(std::vector<Item> &&items, Operation &&operation) {
+	struct batch {
+		batch(std::vector<Item> &&items, Operation &&operation)
+			: items{ std::move(items) }, operation{ std::forward<Operation>(operation) }
+			, remaining{ this->items.size() } {}
+
+		std::vector<Item> items;
+		std::decay_t<Operation> operation;
+		std::atomic<usize> result{ 0 };
+		std::atomic<usize> remaining;
+		std::promise<usize> done;
+	};
+
+	auto state{ std::make_shared<batch>(std::move(items), std::forward<Operation>(operation)) };
+
+	auto future{ state->done.get_future() };
+	if (state->items.empty()) {
+		state->done.set_value(0);
+		return future;
+	}
+
+	for (usize index{}; index < state->items.size(); ++index) {
+		background.push([state, index] {
+			try {
+				state->result += state->operation(state->items[index]);
+			} catch (...) {
+				// Counted as 0 bytes, the rest of the batch still runs
+			}
+			if (--state->remaining == 0) {
+				state->done.set_value(state->result);
+			}
+		});
+	}
+	return future;
+}
+
+template<class Container>
+std::optional<Container> read_content(const std::wstring_view path, const usize offset, const usize size,
+		const filesystem::read_mode mode, const typename Container::allocator_type &allocator = {}) {
+	Container content{ allocator };
+	const auto count{ read_file(path, offset, size, mode, [&content](const usize length) {
+		content.resize(length);
+		return static_cast<void *>(content.data());
+	}) };
+
+	if (!count.has_value()) return std::nullopt;
+	content.resize(*count);
+	return content;
+}
+
+/**
+ * Reads recorded between filesystem::start_trace() and filesystem::stop_trace().
+ * The trace file layout (all integers are little-endian):
+ *   header:  "GXTR", u16 version, u16 reserved, u32 paths count, u32 records count
+ *   paths:   u32 length, length * u32 code units
+ *   records: u32 path index, u64 offset, u64 size
+ */
+class access_trace {
+public:
+	struct record {
+		std::wstring path;
+		usize offset;
+		usize size;
+	};
+
+	static constexpr u16 version{ 1 };
+
+	void start() {
+		std::lock_guard lock{ guard };
+		records.clear();
+		recording.store(true, std::memory_order_release);
+	}
+
+	[[nodiscard]] bool active() const noexcept {
+		return recording.load(std::memory_order_acquire);
+	}
+
+	void add(const std::wstring_view path, const usize offset, const usize size) {
+		if (!active()) [[likely]] return;
+
+		std::lock_guard lock{ guard };
+		if (recording.load(std::memory_order_relaxed)) {
+			records.push_back(record{ std::wstring{ path }, offset, size });
+		}
+	}
+
+	[[nodiscard]] std::optional<std::vector<record>> stop() {
+		std::lock_guard lock{ guard };
+		if (!recording.exchange(false)) return std::nullopt;
+		return std::exchange(records, {});
+	}
+
+	[[nodiscard]] static std::vector<byte> serialize(const std::vector<record> &records) {
+		std::unordered_map<std::wstring_view, u32> indices;
+		std::vector<std::wstring_view> paths;
+		std::vector<std::tuple<u32, u64, u64>> unique;
+		std::set<std::tuple<u32, u64, u64>> seen;
+
+		for (const auto &[path, offset, size] : records) {
+			auto [index, inserted]{ indices.try_emplace(path, static_cast<u32>(paths.size())) };
+			if (inserted) paths.emplace_back(path);
+
+			const auto entry{ std::make_tuple(index->second, static_cast<u64>(offset), static_cast<u64>(size)) };
+			if (seen.insert(entry).second) unique.emplace_back(entry);
+		}
+
+		std::vector<byte> data;
+		data.insert(std::end(data), std::begin(magic), std::end(magic));
+		put(data, version);
+		put(data, u16{});
+		put(data, static_cast<u32>(paths.size()));
+		put(data, static_cast<u32>(unique.size()));
+		for (const auto path : paths) {
+			put(data, static_cast<u32>(path.size()));
+			for (const auto c : path) put(data, static_cast<u32>(c));
+		}
+		for (const auto &[index, offset, size] : unique) {
+			put(data, index);
+			put(data, offset);
+			put(data, size);
+		}
+		return data;
+	}
+
+	/** Parses the records until the first malformed one. Unknown versions give no records */
+	[[nodiscard]] static std::vector<record> deserialize(const std::vector<byte> &data) {
+		usize position{ std::size(magic) };
+		if (data.size() < position || !std::equal(std::begin(magic), std::end(magic), std::begin(data))) {
+			return {};
+		}
+
+		u16 file_version{};
+		u16 reserved{};
+		u32 paths_count{};
+		u32 records_count{};
+		if (!get(data, position, file_version) || file_version != version || !get(data, position, reserved) ||
+			!get(data, position, paths_count) || !get(data, position, records_count)) {
+			return {};
+		}
+
+		std::vector<std::wstring> paths;
+		for (u32 i{}; i < paths_count; ++i) {
+			u32 length{};
+			if (!get(data, position, length) || (data.size() - position) / sizeof(u32) < length) return {};
+
+			auto &path{ paths.emplace_back(length, L'\0') };
+			for (auto &c : path) {
+				u32 code{};
+				get(data, position, code);
+				c = static_cast<std::wstring::value_type>(code);
+			}
+		}
+
+		std::vector<record> result;
+		result.reserve(std::min<usize>(records_count, (data.size() - position) / (sizeof(u32) + 2 * sizeof(u64))));
+		for (u32 i{}; i < records_count; ++i) {
+			u32 index{};
+			u64 offset{};
+			u64 size{};
+			if (!get(data, position, index) || !get(data, position, offset) || !get(data, position, size)) break;
+			if (index >= paths.size()) break;
+			result.push_back(record{ paths[index], static_cast<usize>(offset), static_cast<usize>(size) });
+		}
+		return result;
+	}
+
+private:
+	static constexpr std::array<byte, 4> magic{ byte{ 'G' }, byte{ 'X' }, byte{ 'T' }, byte{ 'R' } };
+
+	std::mutex guard;
+	std::atomic_bool recording{ false };
+	std::vector<record> records;
+
+	template<class T>
+	static void put(std::vector<byte> &data, const T value) {
+		for (usize i{}; i < sizeof(T); ++i) {
+			data.push_back(static_cast<byte>((value >> (i * 8)) & 0xFFu));
+		}
+	}
+
+	template<class T>
+	static bool get(const std::vector<byte> &data, usize &position, T &value) {
+		if (data.size() - position < sizeof(T)) return false;
+		value = T{};
+		for (usize i{}; i < sizeof(T); ++i) {
+			value |= static_cast<T>(static_cast<T>(data[position + i]) << (i * 8));
+		}
+		position += sizeof(T);
+		return true;
+	}
+};
+
+static access_trace trace;
+
+/** The common part of every read_binary and read_text once the path is resolved */
+template<class Container>
+Container read_resolved(measurement &measure, const std::wstring_view full_path, const usize offset,
+		const usize size, const filesystem::read_mode mode, const typename Container::allocator_type &allocator = {}) {
+	auto content{ read_content<Container>(full_path, offset, size, mode, allocator) };
+	if (!content.has_value()) [[unlikely]] {
+		measure.fail();
+		return Container{ allocator };
+	}
+
+	measure.read(content->size());
+	if (!content->empty()) trace.add(full_path, offset, content->size());
+	return std::move(*content);
+}
+
+/** The error with `errno` (`GetLastError()` on Windows) of the call which has just failed */
+filesystem::error system_error(const filesystem::error_code code, const char *operation) noexcept {
+	return filesystem::error{ code, last_error(), operation };
+}
+
+/**
+ * write_data() and write_pieces() without the write-behind queue. The arguments are already checked.
+ * If the parent was removed behind our back while it's still in the known_directories, it's created
+ * again and the write is retried once.
+ */
+filesystem::error write_immediately(const char *operation, const std::wstring_view wide_path,
+		const data_view<byte> *pieces, const usize count, const bool append) noexcept {
+	using code = filesystem::error_code;
+
+	try {
+		auto status{ write_gathered(wide_path, pieces, count, append) };
+		if (status == code::open_failed) [[unlikely]] {
+			filesystem::path_buffer parent{ wide_path };
+			filesystem::parent_directory(parent);
+			if (!make_directories(parent)) {
+				return system_error(code::make_directory_failed, operation);
+			}
+			status = write_gathered(wide_path, pieces, count, append);
+		}
+		// The system error is taken before changed() can overwrite it
+		const auto result{ status != code::ok ? system_error(status, operation) : filesystem::OK };
+		changed(wide_path);
+		return result;
+	} catch(...) {
+		return filesystem::error{ code::exception, 0, operation };
+	}
+}
+
+/**
+ * Writes of filesystem::enable_write_behind(). A single worker writes the files in the order of their
+ * first queued write, so the writes of a file are never reordered. The writes of a file which is
+ * still queued are coalesced: a write replaces the queued content, an append is concatenated to it.
+ */
+class write_behind_queue {
+public:
+	~write_behind_queue() {
+		[[maybe_unused]] const auto status{ disable() };
+	}
+
+	[[nodiscard]] bool enabled() const noexcept { return active.load(std::memory_order_acquire); }
+
+	void enable(const usize limit) {
+		std::lock_guard lifetime{ lifecycle };
+		{
+			std::lock_guard lock{ guard };
+			max_bytes = std::max<usize>(limit, 1);
+			stopping = false;
+			active.store(true, std::memory_order_release);
+			if (!worker.joinable()) {
+				running = true;
+				worker = std::thread{ [this] { run(); } };
+			}
+		}
+		space.notify_all();
+	}
+
+	filesystem::error disable() {
+		std::lock_guard lifetime{ lifecycle };
+		{
+			std::lock_guard lock{ guard };
+			active.store(false, std::memory_order_release);
+			stopping = true;
+		}
+		available.notify_one();
+		// The worker leaves only once the queue is empty, including the writers waiting for space
+		if (worker.joinable()) worker.join();
+
+		std::lock_guard lock{ guard };
+		return earliest_failure();
+	}
+
+	/** Copies the pieces into the queue. Returns false if it's disabled, so the caller writes by itself */
+	bool push(const char *operation, const std::wstring_view path, const data_view<byte> *pieces,
+			const usize count, const bool append) {
+		usize size{};
+		for (usize i{}; i < count; ++i) size += pieces[i].size();
+
+		std::unique_lock lock{ guard };
+		if (!enabled()) [[unlikely]] return false;
+
+		space.wait(lock, [this, size] {
+			return !running || queued_bytes == 0 || queued_bytes + size <= max_bytes;
+		});
+		if (!running) [[unlikely]] return false; // Disabled and drained while we were waiting
+
+		auto [found, inserted]{ pending.try_emplace(std::wstring{ path }) };
+		auto &entry{ found->second };
+		if (inserted) {
+			entry.append = append;
+			order.emplace_back(++tickets, found->first);
+		} else if (!append) {
+			// The queued content is overwritten anyway
+			queued_bytes -= entry.data.size();
+			entry.data.clear();
+			entry.append = false;
+		}
+		entry.operation = operation;
+		for (usize i{}; i < count; ++i) {
+			entry.data.insert(std::end(entry.data), std::begin(pieces[i]), std::end(pieces[i]));
+		}
+		queued_bytes += size;
+		lock.unlock();
+
+		available.notify_one();
+		return true;
+	}
+
+	filesystem::error flush() {
+		std::unique_lock lock{ guard };
+		const auto target{ tickets };
+		written.wait(lock, [this, target] {
+			return (writing == 0 || writing > target) && (order.empty() || order.front().first > target);
+		});
+		return earliest_failure();
+	}
+
+	filesystem::error drain() {
+		std::unique_lock lock{ guard };
+		written.wait(lock, [this] { return writing == 0 && order.empty(); });
+		return earliest_failure();
+	}
+
+	std::vector<filesystem::write_failure> take_failures() {
+		std::lock_guard lock{ guard };
+		return std::exchange(failures, {});
+	}
+
+private:
+	struct entry {
+		std::vector<byte> data;
+		const char *operation{ nullptr };
+		bool append{ false };
+	};
+
+	std::mutex lifecycle;
+	std::mutex guard;
+	std::condition_variable available;
+	std::condition_variable space;
+	std::condition_variable written;
+	std::unordered_map<std::wstring, entry> pending;
+	std::deque<std::pair<u64, std::wstring>> order; ///< The ticket of the first queued write and the path
+	std::vector<filesystem::write_failure> failures;
+	std::thread worker;
+	std::atomic<bool> active{ false };
+	usize queued_bytes{};
+	usize max_bytes{ filesystem::default_write_behind_limit };
+	u64 tickets{};
+	u64 writing{}; ///< The ticket of the entry being written or 0
+	bool running{ false };
+	bool stopping{ false };
+
+	filesystem::error earliest_failure() const noexcept {
+		return failures.empty() ? filesystem::OK : failures.front().status;
+	}
+
+	void run() {
+		std::unique_lock lock{ guard };
+		while (true) {
+			available.wait(lock, [this] { return stopping || !order.empty(); });
+			if (order.empty()) {
+				running = false;
+				space.notify_all();
+				return;
+			}
+
+			auto [ticket, path]{ std::move(order.front()) };
+			order.pop_front();
+			auto node{ pending.extract(path) };
+			const auto &queued{ node.mapped() };
+			writing = ticket;
+			lock.unlock();
+
+			const data_view<byte> content{ queued.data.data(), queued.data.size() };
+			const auto status{ write_immediately(queued.operation, path, &content, 1, queued.append) };
+
+			lock.lock();
+			writing = 0;
+			queued_bytes -= queued.data.size();
+			if (status.has_error()) [[unlikely]] {
+				failures.push_back(filesystem::write_failure{ std::move(path), status });
+			}
+			space.notify_all();
+			written.notify_all();
+		}
+	}
+};
+
+extern write_behind_queue write_behind;
+
 template<class T>
-filesystem::error write_data(const std::wstring_view wide_path, const T *data, const usize len,
-		const std::ios::openmode mode = std::ios::out) noexcept {
+filesystem::error write_data(const char *operation, const std::wstring_view wide_path, const T *data,
+		const usize len, const std::ios::openmode mode = std::ios::out) noexcept {
+	using code = filesystem::error_code;
 
 	if (len == 0 || data == nullptr) [[unlikely]] {
-		return filesystem::error{ L"Invalid empty parameters" };
+		return filesystem::error{ code::invalid_argument, 0, operation };
+	}
+
+	const data_view<byte> piece{ reinterpret_cast<const byte *>(data), sizeof(T) * len };
+	const bool append{ (mode & std::ios::app) != 0 };
+	if (write_behind.enabled()) [[unlikely]] {
+		try {
+			if (write_behind.push(operation, wide_path, &piece, 1, append)) {
+				return filesystem::OK;
+			}
+		} catch(...) {
+			return filesystem::error{ code::exception, 0, operation };
+		}
+	}
+	return write_immediately(operation, wide_path, &piece, 1, append);
+}
+
+/** write_data() for the scatter-gather writes. The pieces reach the file without being concatenated */
+filesystem::error write_pieces(const char *operation, const std::wstring_view wide_path,
+		const data_view<byte> *pieces, const usize count, const usize total, const bool append) noexcept {
+	using code = filesystem::error_code;
+
+	if (total == 0) [[unlikely]] {
+		return filesystem::error{ code::invalid_argument, 0, operation };
+	}
+
+	try {
+		if (write_behind.enabled() && write_behind.push(operation, wide_path, pieces, count, append)) {
+			return filesystem::OK;
+		}
+	} catch(...) {
+		return filesystem::error{ code::exception, 0, operation };
+	}
+	return write_immediately(operation, wide_path, pieces, count, append);
+}
+
+/**
+ * Writes the blocks of @p data which differ from the content of @p reference into @p target, which
+ * holds the same content, and cuts @p target at the size of @p data. The old content is compared
+ * through a mapping and the adjacent changed blocks are written at once. A missing @p reference
+ * counts as an empty file. The number of the written bytes is added to @p written.
+ */
+filesystem::error write_changed_blocks(const char *operation, const std::wstring_view reference,
+		const std::wstring_view target, const data_view<byte> &data, const usize block_size,
+		const bool sync, usize &written) {
+	using code = filesystem::error_code;
+
+	const void *mapping{ nullptr };
+	usize old_size{};
+	if (!map_file(reference, mapping, old_size)) {
+		mapping = nullptr;
+		old_size = 0;
+	}
+
+	const auto file{ open_read_write(target) };
+	if (file == -1) [[unlikely]] {
+		const auto status{ system_error(code::open_failed, operation) };
+		unmap_file(mapping, old_size);
+		return status;
+	}
+
+	const auto old{ static_cast<const byte *>(mapping) };
+	const auto size{ data.size() };
+	const auto write_changed = [&](const usize begin, const usize end) {
+		if (begin == end) return true;
+		written += end - begin;
+		return write_at(file, begin, data.data() + begin, end - begin);
+	};
+
+	bool success{ true };
+	usize changed{}; // Begin of the changed blocks which aren't written yet
+	for (usize offset{}; success && offset < size; offset += block_size) {
+		const auto length{ std::min(block_size, size - offset) };
+		if (offset + length <= old_size && std::memcmp(old + offset, data.data() + offset, length) == 0) {
+			success = write_changed(changed, offset);
+			changed = offset + length;
+		}
+	}
+	success = success && write_changed(changed, size);
+	// Windows refuses to cut a mapped file
+	unmap_file(mapping, old_size);
+
+	if (success && sync) success = sync_file(file);
+	if (!success) [[unlikely]] {
+		const auto status{ system_error(code::write_failed, operation) };
+		close_file(file);
+		return status;
+	}
+	if (!close_truncated(file, size)) [[unlikely]] {
+		return system_error(code::write_failed, operation);
+	}
+	return filesystem::OK;
+}
+
+/** filesystem::make_directory() of the resolved path. Known directories don't touch the filesystem */
+filesystem::error make_native_directory(const char *operation, const std::wstring_view protocol,
+		const std::wstring_view full_path) {
+	using code = filesystem::error_code;
+
+	if (directories.contains(protocol, full_path)) [[likely]] return filesystem::OK;
+	if (metadata.enabled() && metadata.find(full_path) == entry_type::directory) return filesystem::OK;
+
+	if (!make_directories(full_path)) [[unlikely]] {
+		const auto status{ system_error(code::make_directory_failed, operation) };
+		if (is_file(full_path)) {
+			return filesystem::error{ code::path_is_file, status.system, operation };
+		}
+		return status;
+	}
+
+	directories.remember(protocol, std::wstring{ full_path });
+	changed(full_path);
+	return filesystem::OK;
+}
+
+} // namespace details
+
+filesystem::associations_type filesystem::associations_map{};
+std::wstring filesystem::appname{ filesystem::default_application_name };
+
+// Defined after the associations, so the workers are stopped before anything they use is destroyed
+details::background_queue details::background{};
+
+// Stopped before the workers above, it writes everything still queued on exit
+details::write_behind_queue details::write_behind{};
+
+
+//==================================== filesystem::chrome_trace_sink ===================================//
+
+filesystem::chrome_trace_sink::chrome_trace_sink() : origin{ std::chrono::steady_clock::now() } {}
+
+void filesystem::chrome_trace_sink::end(const span &call) noexcept {
+	const auto microseconds = [](const std::chrono::steady_clock::duration duration) {
+		// Calls which have started before the sink was created are clamped to its creation
+		const auto nanoseconds{ std::max<long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(), 0) };
+		auto fraction{ std::to_string(nanoseconds % 1000) };
+		fraction.insert(0, 3 - fraction.size(), '0');
+		return std::to_string(nanoseconds / 1000) + '.' + fraction;
+	};
+
+	try {
+		std::string path;
+		for (const auto c : to_narrow(call.path)) {
+			if (c == '"' || c == '\\') path += '\\';
+			if (static_cast<unsigned char>(c) < 0x20) continue;
+			path += c;
+		}
+
+		std::string event{ "{\"name\":\"" };
+		event.append(call.name);
+		event += "\",\"cat\":\"filesystem\",\"ph\":\"X\",\"pid\":1,\"tid\":";
+		event += std::to_string(call.thread);
+		event += ",\"ts\":";
+		event += microseconds(call.begin - origin);
+		event += ",\"dur\":";
+		event += microseconds(call.end - call.begin);
+		event += ",\"args\":{\"path\":\"";
+		event += path;
+		event += "\",\"size\":";
+		event += std::to_string(call.size);
+		event += ",\"failed\":";
+		event += call.failed ? "true" : "false";
+		event += "}}";
+
+		std::lock_guard lock{ guard };
+		if (!events.empty()) events += ",\n";
+		events += event;
+	} catch (...) {
+		// Losing a span is better than failing the traced call
+	}
+}
+
+filesystem::error filesystem::chrome_trace_sink::save(const std::wstring_view path) {
+	std::string json{ "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n" };
+	{
+		std::lock_guard lock{ guard };
+		json += events;
+	}
+	json += "\n]}\n";
+	// The write could be traced by this sink, so it's done without holding the lock
+	return write_text_atomic(path, json, durability::none);
+}
+
+filesystem::error filesystem::chrome_trace_sink::save(const std::string_view path) {
+	return save(to_wide(path));
+}
+
+//========================================= filesystem::error ========================================//
+
+
+namespace details {
+
+constexpr std::array<std::wstring_view, static_cast<usize>(filesystem::error_code::count)> error_descriptions{
+	L"No error",
+	L"Protocol prefix expected in the path",
+	L"Empty path",
+	L"Invalid empty parameters",
+	L"Not a file",
+	L"Not a directory",
+	L"Path is a file",
+	L"Cannot open the file",
+	L"Cannot write to the file",
+	L"Cannot create the directory",
+	L"Cannot remove the entry",
+	L"Cannot move the file",
+	L"Cannot copy the entry",
+	L"Cannot copy the directory into itself",
+	L"Cannot read the directory tree",
+	L"The trace wasn't started",
+	L"Failed to setup the assets or the user data directory",
+	L"Exception was thrown",
+	L"The range is locked by someone else",
+	L"Cannot lock or unlock the range",
+};
+
+/** Appends to the fixed buffer and silently truncates. The descriptions are ASCII, so they fit `char` too */
+template<class Char>
+class message_writer {
+public:
+	message_writer(Char *buffer, const usize capacity) noexcept : buffer{ buffer }, capacity{ capacity } {}
+
+	template<class Text>
+	void append(const Text &text) noexcept {
+		for (const auto c : text) {
+			if (length + 1 >= capacity) return;
+			buffer[length++] = static_cast<Char>(c);
+		}
+	}
+
+	void append_system(const int code) noexcept {
+		if (length + 1 < capacity) length += system_message(code, buffer + length, capacity - length - 1);
+	}
+
+	usize finish() noexcept {
+		buffer[length] = Char{};
+		return length;
+	}
+
+private:
+	Char *const buffer;
+	const usize capacity;
+	usize length{};
+};
+
+template<class Char>
+usize format_error(const filesystem::error &status, Char *buffer, const usize capacity) noexcept {
+	if (buffer == nullptr || capacity == 0) [[unlikely]] return 0;
+
+	message_writer<Char> out{ buffer, capacity };
+	if (!status.has_error()) return out.finish();
+
+	if (status.operation != nullptr) {
+		out.append(std::string_view{ "[filesystem::" });
+		out.append(std::string_view{ status.operation });
+		out.append(std::string_view{ "] " });
+	}
+	out.append(status.description());
+	if (status.system != 0) {
+		out.append(std::string_view{ ": " });
+		out.append_system(status.system);
+	}
+	return out.finish();
+}
+
+} // namespace details
+
+std::wstring_view filesystem::error::description() const noexcept {
+	const auto index{ static_cast<usize>(code) };
+	return index < details::error_descriptions.size() ? details::error_descriptions[index] : L"Unknown error";
+}
+
+usize filesystem::error::message(wchar_t *buffer, const usize capacity) const noexcept {
+	return details::format_error(*this, buffer, capacity);
+}
+
+usize filesystem::error::message(char *buffer, const usize capacity) const noexcept {
+	return details::format_error(*this, buffer, capacity);
+}
+
+std::wstring filesystem::error::message() const {
+	std::array<wchar_t, 512> buffer;
+	return std::wstring{ buffer.data(), message(buffer.data(), buffer.size()) };
+}
+
+
+//============================================ mapped_file ===========================================//
+
+mapped_file::mapped_file(mapped_file &&other) noexcept
+	: m_data{ std::exchange(other.m_data, nullptr) }, m_size{ std::exchange(other.m_size, 0) } {}
+
+mapped_file &mapped_file::operator=(mapped_file &&other) noexcept {
+	if (this != &other) {
+		reset();
+		m_data = std::exchange(other.m_data, nullptr);
+		m_size = std::exchange(other.m_size, 0);
+	}
+	return *this;
+}
+
+mapped_file::~mapped_file() {
+	reset();
+}
+
+void mapped_file::reset() noexcept {
+	details::unmap_file(m_data, m_size);
+	m_data = nullptr;
+	m_size = 0;
+}
+
+//==================================== filesystem::segment_writer ====================================//
+
+namespace details {
+
+/** `<path>.000042`, the fixed width keeps the segments sorted by name */
+std::wstring segment_name(const std::wstring_view path, const usize index) {
+	static constexpr usize width{ 6 };
+	auto number{ std::to_wstring(index) };
+	if (number.size() < width) number.insert(0, width - number.size(), L'0');
+
+	std::wstring name;
+	name.reserve(path.size() + 1 + number.size());
+	name.append(path).append(1, L'.').append(number);
+	return name;
+}
+
+/** The index after the last segment of @p full_path in its directory */
+usize next_segment(const std::wstring_view full_path) {
+	const auto slash{ full_path.rfind(filesystem::separator) };
+	const auto prefix{ full_path.substr(slash == std::wstring_view::npos ? 0 : slash + 1) };
+	const auto directory{ slash == std::wstring_view::npos ? std::wstring_view{} : full_path.substr(0, slash) };
+
+	usize next{};
+	for (const auto &entry : ls(directory.empty() ? std::wstring_view{ L"/" } : directory)) {
+		const std::wstring_view name{ entry };
+		if (name.size() <= prefix.size() + 1 || name.substr(0, prefix.size()) != prefix ||
+				name[prefix.size()] != L'.') continue;
+
+		const auto number{ name.substr(prefix.size() + 1) };
+		if (!std::all_of(std::begin(number), std::end(number), [](const wchar_t c) { return c >= L'0' && c <= L'9'; })) {
+			continue;
+		}
+		usize index{};
+		for (const auto digit : number) index = index * 10 + static_cast<usize>(digit - L'0');
+		next = std::max(next, index + 1);
+	}
+	return next;
+}
+
+} // namespace details
+
+filesystem::segment_writer::segment_writer(const std::wstring_view path, const usize segment_size)
+	: m_path{ path }, m_segment_size{ std::max<usize>(segment_size, 1) } {}
+
+filesystem::segment_writer::segment_writer(const std::string_view path, const usize segment_size)
+	: segment_writer{ to_wide(path), segment_size } {}
+
+filesystem::segment_writer::segment_writer(segment_writer &&other) noexcept
+	: m_path{ std::move(other.m_path) }, m_segment_size{ other.m_segment_size }
+	, m_segment{ std::exchange(other.m_segment, 0) }, m_size{ std::exchange(other.m_size, 0) }
+	, m_file{ std::exchange(other.m_file, closed_file) }, m_indexed{ std::exchange(other.m_indexed, false) } {}
+
+filesystem::segment_writer &filesystem::segment_writer::operator=(segment_writer &&other) noexcept {
+	if (this != &other) {
+		[[maybe_unused]] const auto status{ close() };
+		m_path = std::move(other.m_path);
+		m_segment_size = other.m_segment_size;
+		m_segment = std::exchange(other.m_segment, 0);
+		m_size = std::exchange(other.m_size, 0);
+		m_file = std::exchange(other.m_file, closed_file);
+		m_indexed = std::exchange(other.m_indexed, false);
+	}
+	return *this;
+}
+
+filesystem::segment_writer::~segment_writer() {
+	[[maybe_unused]] const auto status{ close() };
+}
+
+filesystem::error filesystem::segment_writer::append_binary(const details::data_view<byte> &data) {
+	details::measurement measure{ io_operation::append, __func__, m_path };
+	if (data.size() == 0 || data.data() == nullptr) [[unlikely]] {
+		return measure(error{ error_code::invalid_argument, 0, __func__ });
+	}
+
+	// The records aren't split, so the one which doesn't fit goes to the next segment
+	if (is_open() && m_size != 0 && m_size + data.size() > m_segment_size) {
+		if (const auto status{ close() }; status.has_error()) [[unlikely]] return measure(status);
+	}
+	if (!is_open()) {
+		if (const auto status{ open(__func__) }; status.has_error()) [[unlikely]] return measure(status);
+	}
+
+	if (!details::write_at(m_file, m_size, data.data(), data.size())) [[unlikely]] {
+		return measure(details::system_error(error_code::write_failed, __func__));
 	}
+	m_size += data.size();
+	return measure.written(OK, data.size());
+}
 
-	try {
+filesystem::error filesystem::segment_writer::append_text(const std::string_view text) {
+	return append_binary(details::data_view<byte>{ reinterpret_cast<const byte *>(text.data()), text.size() });
+}
 
-		#if defined(GXZN_OS_FS_WINDOWS)
-			const auto path{ wide_path };
-		#elif defined(GXZN_OS_FS_LINUX) || defined(GXZN_OS_FS_MACOS)
-			const auto path{ filesystem::to_narrow(wide_path) };
-		#endif
+filesystem::error filesystem::segment_writer::close() {
+	if (!is_open()) return OK;
 
-		if (std::ofstream file{ path.data(), mode | std::ios::binary }; file.is_open()) {
-			file.write(reinterpret_cast<const char *>(data), sizeof(T) * len);
-			if (file.good()) [[likely]] {
-				return filesystem::OK;
-			}
+	const bool success{ details::close_truncated(std::exchange(m_file, closed_file), m_size) };
+	++m_segment;
+	m_size = 0;
+	return success ? OK : details::system_error(error_code::write_failed, __func__);
+}
+
+std::wstring filesystem::segment_writer::segment_path() const {
+	return details::segment_name(m_path, m_segment);
+}
 
-			return filesystem::error{ L"Failed to write to file '" + std::wstring{ wide_path } + L'\'' };
+filesystem::error filesystem::segment_writer::open(const char *operation) {
+	static constexpr usize max_attempts{ 8 };
+
+	if (m_path.find(protocol_separator) == std::wstring::npos) [[unlikely]] {
+		return error{ error_code::missing_protocol, 0, operation };
+	}
+	if (const auto status{ make_directory(parent_directory(std::wstring_view{ m_path })) }; status.has_error()) [[unlikely]] {
+		return status;
+	}
+
+	const auto full_path{ replace_association_prefix(m_path) };
+	if (!m_indexed) {
+		m_segment = details::next_segment(full_path);
+		m_indexed = true;
+	}
+
+	// Another writer of the same path could have taken the index
+	for (usize attempt{}; attempt < max_attempts; ++attempt, ++m_segment) {
+		const auto segment_path{ details::segment_name(full_path, m_segment) };
+		m_file = details::open_segment(segment_path, m_segment_size);
+		if (m_file != closed_file) {
+			details::changed(segment_path);
+			return OK;
 		}
+		if (!details::file_exists_error()) break;
+	}
+	return details::system_error(error_code::open_failed, operation);
+}
 
-	} catch(const std::exception &ex) {
-		return filesystem::error{ L"Failed to write to file '" + std::wstring{ wide_path } +
-			L"' due to exception '" + filesystem::to_wide(ex.what()) + L'\''
-		};
-	} catch(...) {
-		return filesystem::error{ L"Failed to write to file '{}' due to unknown exception" +
-			std::wstring{ wide_path }
-		};
+//====================================== filesystem::file_lock =======================================//
+
+namespace details {
+
+/** Locks the range, polling with a growing pause until @p timeout expires. Waiting forever blocks in the kernel */
+filesystem::error acquire_range(const char *operation, const std::intptr_t file, const usize offset,
+		const usize size, const bool exclusive, const std::chrono::milliseconds timeout) {
+	using code = filesystem::error_code;
+	static constexpr std::chrono::microseconds first_pause{ 50 };
+	static constexpr std::chrono::microseconds max_pause{ 10'000 };
+
+	if (timeout == filesystem::wait_forever) {
+		if (lock_range(file, offset, size, exclusive, true)) [[likely]] return filesystem::OK;
+		return system_error(code::lock_failed, operation);
 	}
 
-	return filesystem::error{ L"Failed to open file '" + std::wstring{ wide_path } + L"' for writing" };
+	const auto deadline{ std::chrono::steady_clock::now() + std::max(timeout, std::chrono::milliseconds::zero()) };
+	for (auto pause{ first_pause }; ; pause = std::min(pause * 2, max_pause)) {
+		if (lock_range(file, offset, size, exclusive, false)) return filesystem::OK;
+		if (!range_busy_error()) [[unlikely]] return system_error(code::lock_failed, operation);
+
+		const auto now{ std::chrono::steady_clock::now() };
+		if (now >= deadline) return system_error(code::locked, operation);
+		std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(pause, deadline - now));
+	}
 }
 
 } // namespace details
 
-filesystem::associations_type filesystem::associations_map{};
-std::wstring filesystem::appname{ filesystem::default_application_name };
-
+filesystem::file_lock::file_lock(file_lock &&other) noexcept
+	: m_file{ std::exchange(other.m_file, closed_file) }, m_offset{ other.m_offset }, m_size{ other.m_size }
+	, m_mode{ other.m_mode } {}
+
+filesystem::file_lock &filesystem::file_lock::operator=(file_lock &&other) noexcept {
+	if (this != &other) {
+		[[maybe_unused]] const auto status{ unlock() };
+		m_file = std::exchange(other.m_file, closed_file);
+		m_offset = other.m_offset;
+		m_size = other.m_size;
+		m_mode = other.m_mode;
+	}
+	return *this;
+}
 
-//========================================= filesystem::error ========================================//
+filesystem::file_lock::~file_lock() {
+	[[maybe_unused]] const auto status{ unlock() };
+}
 
+filesystem::error filesystem::file_lock::write(const usize offset, const details::data_view<byte> &data) {
+	details::measurement measure{ io_operation::write, __func__, none };
+	if (!is_locked() || data.size() == 0 || data.data() == nullptr) [[unlikely]] {
+		return measure(error{ error_code::invalid_argument, 0, __func__ });
+	}
 
-bool filesystem::error::has_error() const noexcept { return !message.empty(); }
+	if (!details::write_at(m_file, offset, data.data(), data.size())) [[unlikely]] {
+		return measure(details::system_error(error_code::write_failed, __func__));
+	}
+	return measure.written(OK, data.size());
+}
 
-filesystem::error::operator bool() const noexcept { return !has_error(); }
+filesystem::error filesystem::file_lock::unlock() {
+	if (!is_locked()) return OK;
 
+	const auto file{ std::exchange(m_file, closed_file) };
+	const auto status{ details::unlock_range(file, m_offset, m_size) ? OK
+		: details::system_error(error_code::lock_failed, __func__)
+	};
+	// Closing the description releases its locks anyway
+	details::close_file(file);
+	return status;
+}
 
 //======================================== filesystem::public ========================================//
 
@@ -89,7 +1329,7 @@ filesystem::error filesystem::initialize(const std::wstring_view app_name, const
 		err = make_directory(L"res://");
 		if (err.has_error()) [[unlikely]] return err;
 	} else {
-		err.message = L"Failed to setup assets directories";
+		err = error{ error_code::setup_failed, 0, __func__ };
 	}
 
 
@@ -98,9 +1338,7 @@ filesystem::error filesystem::initialize(const std::wstring_view app_name, const
 		associate(L"user://", std::wstring{ user_dir });
 		associate(L"temp://", std::move(user_dir) + L"/temp");
 	} else {
-		err.message += (err.has_error() ? L" and '" : L"Failed to setup '");
-		err.message += appname;
-		err.message += L"' user data directory";
+		err = error{ error_code::setup_failed, 0, __func__ };
 	}
 
 	return err;
@@ -116,20 +1354,19 @@ void filesystem::set_application_name(const std::wstring_view application_name)
 void filesystem::associate(const std::wstring_view protocol_view, std::wstring &&prefix) noexcept {
 	if (protocol_view.empty()) [[unlikely]] return;
 
-	std::wstring protocol{ protocol_view };
-	const auto rbegin{ std::rbegin(protocol_view) };
-	const auto ends_with_separator{
-		std::equal(rbegin, std::next(rbegin, protocol_separator.size()),
-			std::rbegin(protocol_separator))
-	};
-	if (!ends_with_separator) [[unlikely]] {
-		protocol += protocol_separator;
-	}
-
+	auto protocol{ details::protocol_key(protocol_view) };
+	details::directories.forget_association(protocol);
+	details::assets.forget_association(protocol);
+	details::associate_root(protocol, prefix);
 	associations_map.insert_or_assign(std::move(protocol), std::move(prefix));
 }
 
-std::vector<byte> filesystem::read_binary(const std::wstring_view wide_path) {
+std::vector<byte> filesystem::read_binary(const std::wstring_view path, const read_mode mode) {
+	return read_binary(path, 0, std::numeric_limits<usize>::max(), mode);
+}
+
+std::vector<byte> filesystem::read_binary(const std::wstring_view wide_path, const usize offset,
+		const usize size, const read_mode mode) {
 	if (wide_path.find(protocol_separator) == std::wstring_view::npos) [[unlikely]] {
 		throw std::invalid_argument{
 			std::string{ "[filesystem::read_binary] Protocol prefix expected in the path: '" } +
@@ -137,23 +1374,40 @@ std::vector<byte> filesystem::read_binary(const std::wstring_view wide_path) {
 		};
 	}
 
-#if defined(GXZN_OS_FS_WINDOWS)
-	const auto path{ replace_association_prefix(wide_path) };
-#elif defined(GXZN_OS_FS_LINUX) || defined(GXZN_OS_FS_MACOS)
-	const auto path{ to_narrow(replace_association_prefix(wide_path)) };
-#endif
+	details::measurement measure{ io_operation::read, __func__, wide_path };
+	return details::read_resolved<std::vector<byte>>(measure, replace_association_prefix(wide_path), offset, size, mode);
+}
+
+#if defined(GXZN_OS_FS_PMR)
+
+std::pmr::vector<byte> filesystem::read_binary(const std::wstring_view path, std::pmr::memory_resource *resource,
+		const read_mode mode) {
+	return read_binary(path, 0, std::numeric_limits<usize>::max(), resource, mode);
+}
 
-	if (std::ifstream file{ path, std::ios::binary | std::ios::ate }; file.is_open()) [[likely]] {
-		std::vector<byte> content(file.tellg());
-		file.seekg(std::ios::beg);
-		file.read(reinterpret_cast<char *>(content.data()), content.size());
-		return content;
+std::pmr::vector<byte> filesystem::read_binary(const std::wstring_view wide_path, const usize offset,
+		const usize size, std::pmr::memory_resource *resource, const read_mode mode) {
+	if (wide_path.find(protocol_separator) == std::wstring_view::npos) [[unlikely]] {
+		throw std::invalid_argument{
+			std::string{ "[filesystem::read_binary] Protocol prefix expected in the path: '" } +
+			to_narrow(wide_path) + "'"
+		};
 	}
+	if (resource == nullptr) resource = std::pmr::get_default_resource();
+
+	details::measurement measure{ io_operation::read, __func__, wide_path };
+	const auto full_path{ replace_association_prefix(wide_path, resource) };
+	return details::read_resolved<std::pmr::vector<byte>>(measure, full_path, offset, size, mode, resource);
+}
 
-	return {};
+#endif // defined(GXZN_OS_FS_PMR)
+
+std::string filesystem::read_text(const std::wstring_view path, const read_mode mode) {
+	return read_text(path, 0, std::numeric_limits<usize>::max(), mode);
 }
 
-std::string filesystem::read_text(const std::wstring_view wide_path) {
+std::string filesystem::read_text(const std::wstring_view wide_path, const usize offset,
+		const usize size, const read_mode mode) {
 	if (wide_path.find(protocol_separator) == std::wstring_view::npos) [[unlikely]] {
 		throw std::invalid_argument{
 			std::string{ "[filesystem::read_text] Protocol prefix expected in the path: '" } +
@@ -161,156 +1415,577 @@ std::string filesystem::read_text(const std::wstring_view wide_path) {
 		};
 	}
 
-#if defined(GXZN_OS_FS_WINDOWS)
-	const auto path{ replace_association_prefix(wide_path) };
-#elif defined(GXZN_OS_FS_LINUX) || defined(GXZN_OS_FS_MACOS)
-	const auto path{ to_narrow(replace_association_prefix(wide_path)) };
-#endif
+	details::measurement measure{ io_operation::read, __func__, wide_path };
+	return details::read_resolved<std::string>(measure, replace_association_prefix(wide_path), offset, size, mode);
+}
+
+std::vector<byte> filesystem::read_binary(const asset_id &id, const read_mode mode) {
+	if (path_buffer native; details::assets.find(id, native)) [[likely]] {
+		details::measurement measure{ io_operation::read, __func__, id.path() };
+		return details::read_resolved<std::vector<byte>>(measure, native, 0, std::numeric_limits<usize>::max(), mode);
+	}
+	return read_binary(id.path(), mode);
+}
 
-	if (std::ifstream file{ path, std::ios::ate }; file.is_open()) [[likely]] {
-		std::string content(file.tellg(), '\0');
-		file.seekg(std::ios::beg);
-		file.read(content.data(), content.size());
-		return content;
+std::string filesystem::read_text(const asset_id &id, const read_mode mode) {
+	if (path_buffer native; details::assets.find(id, native)) [[likely]] {
+		details::measurement measure{ io_operation::read, __func__, id.path() };
+		return details::read_resolved<std::string>(measure, native, 0, std::numeric_limits<usize>::max(), mode);
 	}
+	return read_text(id.path(), mode);
+}
 
-	return {};
+std::vector<byte> filesystem::read_binary(const checked_path path, const read_mode mode) {
+	details::measurement measure{ io_operation::read, __func__, path.path };
+	path_buffer native;
+	resolve(path, native);
+	return details::read_resolved<std::vector<byte>>(measure, native, 0, std::numeric_limits<usize>::max(), mode);
 }
 
-filesystem::error filesystem::write_binary(const std::wstring_view path, const details::data_view<byte> &data) {
+std::string filesystem::read_text(const checked_path path, const read_mode mode) {
+	details::measurement measure{ io_operation::read, __func__, path.path };
+	path_buffer native;
+	resolve(path, native);
+	return details::read_resolved<std::string>(measure, native, 0, std::numeric_limits<usize>::max(), mode);
+}
+
+filesystem::error filesystem::read_into(const std::wstring_view path,
+		const std::function<byte *(usize)> &destination, const read_mode mode) {
+	details::measurement measure{ io_operation::read, __func__, path };
 	if (path.find(protocol_separator) == std::wstring_view::npos) [[unlikely]] {
-		return error{ L"[filesystem::write_binary] Protocol prefix expected in the path: '" +
-			std::wstring{ path } + L'\''
+		return measure(error{ error_code::missing_protocol, 0, __func__ });
+	}
+	if (!destination) [[unlikely]] {
+		return measure(error{ error_code::invalid_argument, 0, __func__ });
+	}
+
+	const auto full_path{ replace_association_prefix(path) };
+	const auto count{ details::read_file(full_path, 0, std::numeric_limits<usize>::max(), mode,
+		[&destination](const usize size) { return static_cast<void *>(destination(size)); })
+	};
+	if (!count.has_value()) [[unlikely]] {
+		return measure(details::system_error(error_code::open_failed, __func__));
+	}
+
+	measure.read(*count);
+	if (*count != 0) details::trace.add(full_path, 0, *count);
+	return OK;
+}
+
+mapped_file filesystem::map(const std::wstring_view wide_path) {
+	if (wide_path.find(protocol_separator) == std::wstring_view::npos) [[unlikely]] {
+		throw std::invalid_argument{
+			std::string{ "[filesystem::map] Protocol prefix expected in the path: '" } +
+			to_narrow(wide_path) + "'"
 		};
 	}
 
-	if (auto status{ make_directory(parent_directory(path)) }; status.has_error()) {
-		status.message += L" (During creating parent directory for writing file '",
-		status.message += std::wstring{ path } + L"')";
-		return status;
+	details::measurement measure{ io_operation::read, __func__, wide_path };
+	const auto full_path{ replace_association_prefix(wide_path) };
+	const void *data{ nullptr };
+	usize size{};
+	if (!details::map_file(full_path, data, size)) [[unlikely]] {
+		measure.fail();
+		return mapped_file{};
+	}
+
+	measure.read(size);
+	if (size != 0) details::trace.add(full_path, 0, size);
+	return mapped_file{ static_cast<const byte *>(data), size };
+}
+
+#if defined(GXZN_OS_FS_PMR)
+
+std::pmr::string filesystem::read_text(const std::wstring_view path, std::pmr::memory_resource *resource,
+		const read_mode mode) {
+	return read_text(path, 0, std::numeric_limits<usize>::max(), resource, mode);
+}
+
+std::pmr::string filesystem::read_text(const std::wstring_view wide_path, const usize offset,
+		const usize size, std::pmr::memory_resource *resource, const read_mode mode) {
+	if (wide_path.find(protocol_separator) == std::wstring_view::npos) [[unlikely]] {
+		throw std::invalid_argument{
+			std::string{ "[filesystem::read_text] Protocol prefix expected in the path: '" } +
+			to_narrow(wide_path) + "'"
+		};
+	}
+	if (resource == nullptr) resource = std::pmr::get_default_resource();
+
+	details::measurement measure{ io_operation::read, __func__, wide_path };
+	const auto full_path{ replace_association_prefix(wide_path, resource) };
+	return details::read_resolved<std::pmr::string>(measure, full_path, offset, size, mode, resource);
+}
+
+#endif // defined(GXZN_OS_FS_PMR)
+
+filesystem::error filesystem::write_binary(const std::wstring_view path, const details::data_view<byte> &data) {
+	details::measurement measure{ io_operation::write, __func__, path };
+	if (path.find(protocol_separator) == std::wstring_view::npos) [[unlikely]] {
+		return measure(error{ error_code::missing_protocol, 0, __func__ });
 	}
 
-	return details::write_data(replace_association_prefix(path), data.data(), data.size());
+	if (const auto status{ make_directory(parent_directory(path)) }; status.has_error()) {
+		return measure(status);
+	}
+
+	return measure.written(details::write_data(__func__, replace_association_prefix(path), data.data(), data.size()),
+		data.size()
+	);
 }
 
 filesystem::error filesystem::write_binary(const std::wstring_view path, const std::initializer_list<byte> data) {
+	details::measurement measure{ io_operation::write, __func__, path };
 	if (path.find(protocol_separator) == std::wstring_view::npos) [[unlikely]] {
-		return error{ L"[filesystem::write_binary] Protocol prefix expected in the path: '" +
-			std::wstring{ path } + L'\''
-		};
+		return measure(error{ error_code::missing_protocol, 0, __func__ });
 	}
 
-	if (auto status{ make_directory(parent_directory(path)) }; status.has_error()) {
-		status.message += L" (During creating parent directory for writing file '",
-		status.message += std::wstring{ path } + L"')";
-		return status;
+	if (const auto status{ make_directory(parent_directory(path)) }; status.has_error()) {
+		return measure(status);
 	}
 
-	return details::write_data(replace_association_prefix(path), data.begin(), data.size());
+	return measure.written(details::write_data(__func__, replace_association_prefix(path), data.begin(), data.size()),
+		data.size()
+	);
 }
 
 filesystem::error filesystem::append_binary(const std::wstring_view path, const details::data_view<byte> &data) {
+	details::measurement measure{ io_operation::append, __func__, path };
 	if (path.find(protocol_separator) == std::wstring_view::npos) [[unlikely]] {
-		return error{ L"[filesystem::write_binary] Protocol prefix expected in the path: '" +
-			std::wstring{ path } + L'\''
-		};
+		return measure(error{ error_code::missing_protocol, 0, __func__ });
 	}
 
-	if (auto status{ make_directory(parent_directory(path)) }; status.has_error()) {
-		status.message += L" (During creating parent directory for writing file '";
-		status.message += std::wstring{ path } + L"')";
-		return status;
+	if (const auto status{ make_directory(parent_directory(path)) }; status.has_error()) {
+		return measure(status);
 	}
 
-	return details::write_data(replace_association_prefix(path),
+	return measure.written(details::write_data(__func__, replace_association_prefix(path),
 		data.data(), data.size(), std::ios::app
-	);
+	), data.size());
 }
 
 filesystem::error filesystem::append_binary(const std::wstring_view path, const std::initializer_list<byte> data) {
+	details::measurement measure{ io_operation::append, __func__, path };
 	if (path.find(protocol_separator) == std::wstring_view::npos) [[unlikely]] {
-		return error{ L"[filesystem::write_binary] Protocol prefix expected in the path: '" +
-			std::wstring{ path } + L'\''
-		};
+		return measure(error{ error_code::missing_protocol, 0, __func__ });
 	}
 
-	if (auto status{ make_directory(parent_directory(path)) }; status.has_error()) {
-		status.message += L" (During creating parent directory for writing file '";
-		status.message += std::wstring{ path } + L"')";
-		return status;
+	if (const auto status{ make_directory(parent_directory(path)) }; status.has_error()) {
+		return measure(status);
 	}
 
-	return details::write_data(replace_association_prefix(path),
+	return measure.written(details::write_data(__func__, replace_association_prefix(path),
 		data.begin(), data.size(), std::ios::app
-	);
+	), data.size());
+}
+
+filesystem::error filesystem::write_binary(const std::wstring_view path,
+		const std::initializer_list<details::data_view<byte>> pieces) {
+	return write_pieces(__func__, path, pieces.begin(), pieces.size(), false);
+}
+
+filesystem::error filesystem::write_binary(const std::wstring_view path,
+		const std::vector<details::data_view<byte>> &pieces) {
+	return write_pieces(__func__, path, pieces.data(), pieces.size(), false);
+}
+
+filesystem::error filesystem::append_binary(const std::wstring_view path,
+		const std::initializer_list<details::data_view<byte>> pieces) {
+	return write_pieces(__func__, path, pieces.begin(), pieces.size(), true);
+}
+
+filesystem::error filesystem::append_binary(const std::wstring_view path,
+		const std::vector<details::data_view<byte>> &pieces) {
+	return write_pieces(__func__, path, pieces.data(), pieces.size(), true);
+}
+
+filesystem::error filesystem::write_pieces(const char *operation, const std::wstring_view path,
+		const details::data_view<byte> *pieces, const usize count, const bool append) {
+	details::measurement measure{ append ? io_operation::append : io_operation::write, operation, path };
+	if (path.find(protocol_separator) == std::wstring_view::npos) [[unlikely]] {
+		return measure(error{ error_code::missing_protocol, 0, operation });
+	}
+
+	if (const auto status{ make_directory(parent_directory(path)) }; status.has_error()) {
+		return measure(status);
+	}
+
+	usize total{};
+	for (usize i{}; i < count; ++i) total += pieces[i].size();
+	return measure.written(details::write_pieces(operation, replace_association_prefix(path),
+		pieces, count, total, append), total);
 }
 
 filesystem::error filesystem::write_text(const std::wstring_view path, const std::string_view text) {
+	details::measurement measure{ io_operation::write, __func__, path };
+	if (path.find(protocol_separator) == std::wstring_view::npos) [[unlikely]] {
+		return measure(error{ error_code::missing_protocol, 0, __func__ });
+	}
+
+	if (const auto status{ make_directory(parent_directory(path)) }; status.has_error()) {
+		return measure(status);
+	}
+
+	return measure.written(details::write_data(__func__, replace_association_prefix(path), text.data(), text.size()),
+		text.size()
+	);
+}
+
+filesystem::error filesystem::write_binary(const checked_path path, const details::data_view<byte> &data) {
+	details::measurement measure{ io_operation::write, __func__, path.path };
+	path_buffer native;
+	resolve(path, native);
+	if (const auto status{ make_checked_parent(path, native) }; status.has_error()) {
+		return measure(status);
+	}
+
+	return measure.written(details::write_data(__func__, native, data.data(), data.size()), data.size());
+}
+
+filesystem::error filesystem::write_text(const checked_path path, const std::string_view text) {
+	details::measurement measure{ io_operation::write, __func__, path.path };
+	path_buffer native;
+	resolve(path, native);
+	if (const auto status{ make_checked_parent(path, native) }; status.has_error()) {
+		return measure(status);
+	}
+
+	return measure.written(details::write_data(__func__, native, text.data(), text.size()), text.size());
+}
+
+filesystem::error filesystem::append_text(const std::wstring_view path, const std::string_view text) {
+	details::measurement measure{ io_operation::append, __func__, path };
+	if (path.find(protocol_separator) == std::wstring_view::npos) [[unlikely]] {
+		return measure(error{ error_code::missing_protocol, 0, __func__ });
+	}
+
+	if (const auto status{ make_directory(parent_directory(path)) }; status.has_error()) {
+		return measure(status);
+	}
+
+	return measure.written(details::write_data(__func__, replace_association_prefix(path),
+		text.data(), text.size(), std::ios::app), text.size()
+	);
+}
+
+filesystem::error filesystem::write_text(const std::wstring_view path, const std::wstring_view text) {
+	details::measurement measure{ io_operation::write, __func__, path };
+	if (path.find(protocol_separator) == std::wstring_view::npos) [[unlikely]] {
+		return measure(error{ error_code::missing_protocol, 0, __func__ });
+	}
+
+	if (const auto status{ make_directory(parent_directory(path)) }; status.has_error()) {
+		return measure(status);
+	}
+
+	return measure.written(details::write_data(__func__, replace_association_prefix(path), text.data(), text.size()),
+		text.size() * sizeof(std::wstring_view::value_type)
+	);
+}
+
+filesystem::error filesystem::append_text(const std::wstring_view path, const std::wstring_view text) {
+	details::measurement measure{ io_operation::append, __func__, path };
+	if (path.find(protocol_separator) == std::wstring_view::npos) [[unlikely]] {
+		return measure(error{ error_code::missing_protocol, 0, __func__ });
+	}
+
+	if (const auto status{ make_directory(parent_directory(path)) }; status.has_error()) {
+		return measure(status);
+	}
+
+	return measure.written(details::write_data(__func__, replace_association_prefix(path),
+		text.data(), text.size(), std::ios::app), text.size() * sizeof(std::wstring_view::value_type)
+	);
+}
+
+filesystem::error filesystem::write_binary_atomic(const std::wstring_view path,
+		const details::data_view<byte> &data, const durability level) {
+	details::measurement measure{ io_operation::write_atomic, __func__, path };
+	if (path.find(protocol_separator) == std::wstring_view::npos) [[unlikely]] {
+		return measure(error{ error_code::missing_protocol, 0, __func__ });
+	}
+
+	if (const auto status{ make_directory(parent_directory(path)) }; status.has_error()) {
+		return measure(status);
+	}
+
+	const auto full_path{ replace_association_prefix(path) };
+	const bool written{ details::write_atomically(full_path, data.data(), data.size(), level) };
+	const auto status{ written ? OK : details::system_error(error_code::write_failed, __func__) };
+	details::changed(full_path);
+	return measure.written(status, data.size());
+}
+
+filesystem::error filesystem::write_binary_atomic(const std::wstring_view path,
+		const std::initializer_list<byte> data, const durability level) {
+	return write_binary_atomic(path, details::data_view<byte>{ data.begin(), data.end() }, level);
+}
+
+filesystem::error filesystem::write_text_atomic(const std::wstring_view path,
+		const std::string_view text, const durability level) {
+	const auto begin{ reinterpret_cast<const byte *>(text.data()) };
+	return write_binary_atomic(path, details::data_view<byte>{ begin, begin + text.size() }, level);
+}
+
+filesystem::error filesystem::write_text_atomic(const std::wstring_view path,
+		const std::wstring_view text, const durability level) {
+	const auto begin{ reinterpret_cast<const byte *>(text.data()) };
+	const auto size{ text.size() * sizeof(std::wstring_view::value_type) };
+	return write_binary_atomic(path, details::data_view<byte>{ begin, begin + size }, level);
+}
+
+filesystem::error filesystem::write_delta(const std::wstring_view path, const details::data_view<byte> &data,
+		const delta_mode mode, const usize block_size) {
+	static std::atomic<usize> counter{ 0 };
+
+	details::measurement measure{ io_operation::write_delta, __func__, path };
+	if (path.find(protocol_separator) == std::wstring_view::npos) [[unlikely]] {
+		return measure(error{ error_code::missing_protocol, 0, __func__ });
+	}
+	if (block_size == 0) [[unlikely]] {
+		return measure(error{ error_code::invalid_argument, 0, __func__ });
+	}
+	if (const auto status{ make_directory(parent_directory(path)) }; status.has_error()) {
+		return measure(status);
+	}
+
+	const auto full_path{ replace_association_prefix(path) };
+	usize written{};
+	if (mode == delta_mode::in_place) {
+		const auto status{ details::write_changed_blocks(__func__, full_path, full_path, data, block_size, false, written) };
+		details::changed(full_path);
+		return measure.written(status, written);
+	}
+
+	// The clone shares the unchanged blocks with the file on the copy-on-write filesystems
+	std::wstring temporary{ full_path.view() };
+	temporary += L'.' + std::to_wstring(details::process_id()) + L'.' +
+		std::to_wstring(counter.fetch_add(1, std::memory_order_relaxed)) + L".tmp";
+	error status{ OK };
+	if (details::is_file(full_path) && !details::copy_file(full_path, temporary)) [[unlikely]] {
+		status = details::system_error(error_code::write_failed, __func__);
+	}
+	if (!status.has_error()) {
+		status = details::write_changed_blocks(__func__, full_path, temporary, data, block_size, true, written);
+	}
+	if (!status.has_error() && !details::move_file(temporary, full_path)) [[unlikely]] {
+		status = details::system_error(error_code::write_failed, __func__);
+	}
+	if (status.has_error()) [[unlikely]] {
+		details::rmfile(temporary);
+	}
+	details::changed(full_path);
+	return measure.written(status, written);
+}
+
+std::future<usize> filesystem::prefetch(std::vector<std::wstring> paths) {
+	details::measurement measure{ io_operation::prefetch, __func__, none };
+	// The associations are read by the caller, so they can't change under the workers
+	for (auto &path : paths) path = replace_association_prefix(path).view();
+	return details::schedule_for_each(std::move(paths), [](const std::wstring &native) {
+		return details::prefetch_file(native, 0, std::numeric_limits<usize>::max());
+	});
+}
+
+std::future<usize> filesystem::prefetch(const std::initializer_list<std::wstring_view> paths) {
+	return prefetch(std::vector<std::wstring>{ std::begin(paths), std::end(paths) });
+}
+
+std::future<usize> filesystem::evict(std::vector<std::wstring> paths) {
+	details::measurement measure{ io_operation::prefetch, __func__, none };
+	// The associations are read by the caller, so they can't change under the workers
+	for (auto &path : paths) path = replace_association_prefix(path).view();
+	return details::schedule_for_each(std::move(paths), [](const std::wstring &native) {
+		return details::evict_file(native, 0, std::numeric_limits<usize>::max());
+	});
+}
+
+std::future<usize> filesystem::evict(const std::initializer_list<std::wstring_view> paths) {
+	return evict(std::vector<std::wstring>{ std::begin(paths), std::end(paths) });
+}
+
+filesystem::error filesystem::build_index(const std::wstring_view protocol_view) {
+	if (protocol_view.empty()) [[unlikely]] {
+		return error{ error_code::empty_path, 0, __func__ };
+	}
+
+	const auto protocol{ details::protocol_key(protocol_view) };
+	if (get_association(protocol) == none) [[unlikely]] {
+		return error{ error_code::missing_protocol, 0, __func__ };
+	}
+
+	const auto root{ replace_association_prefix(protocol) };
+	const auto protocol_hash{ details::hash_text(details::fnv1a_offset, std::wstring_view{ protocol }) };
+	std::vector<details::asset_index::file> files;
+	const bool walked{ details::walk(root, [&](const std::wstring_view relative, const bool is_directory, usize) {
+		if (is_directory) return;
+		auto native{ join(root, relative) };
+		normalize(native);
+		std::wstring id{ protocol };
+		for (const auto c : relative) {
+			id += c == L'\\' ? L'/' : c;
+		}
+		files.push_back({ details::hash_relative_path(protocol_hash, relative), std::move(id), std::move(native) });
+	}) };
+	if (!walked) [[unlikely]] {
+		return details::system_error(error_code::open_failed, __func__);
+	}
+
+	details::assets.replace(protocol, std::move(files));
+	return OK;
+}
+
+void filesystem::drop_index(const std::wstring_view protocol) {
+	details::assets.forget_association(details::protocol_key(protocol));
+}
+
+void filesystem::enable_write_behind(const usize max_queued_bytes) {
+	details::write_behind.enable(max_queued_bytes);
+}
+
+filesystem::error filesystem::disable_write_behind() {
+	return details::write_behind.disable();
+}
+
+bool filesystem::is_writing_behind() noexcept {
+	return details::write_behind.enabled();
+}
+
+filesystem::error filesystem::flush() {
+	return details::write_behind.flush();
+}
+
+filesystem::error filesystem::drain() {
+	return details::write_behind.drain();
+}
+
+std::vector<filesystem::write_failure> filesystem::take_write_failures() {
+	return details::write_behind.take_failures();
+}
+
+void filesystem::enable_metadata_cache(const std::chrono::milliseconds ttl) {
+	details::metadata.enable(ttl);
+}
+
+void filesystem::disable_metadata_cache() {
+	details::metadata.disable();
+}
+
+bool filesystem::is_caching_metadata() noexcept {
+	return details::metadata.enabled();
+}
+
+void filesystem::invalidate_metadata(const std::wstring_view path) {
+	if (path.empty() || !details::metadata.enabled()) return;
+	details::metadata.forget(replace_association_prefix(path), true);
+}
+
+filesystem::error filesystem::lock(const std::wstring_view path, file_lock &lock, const usize offset,
+		const usize size, const lock_mode mode, const std::chrono::milliseconds timeout) {
+	details::measurement measure{ io_operation::lock, __func__, path };
+	if (const auto status{ lock.unlock() }; status.has_error()) [[unlikely]] {
+		return measure(status);
+	}
+	if (path.find(protocol_separator) == std::wstring_view::npos) [[unlikely]] {
+		return measure(error{ error_code::missing_protocol, 0, __func__ });
+	}
+	if (const auto status{ make_directory(parent_directory(path)) }; status.has_error()) [[unlikely]] {
+		return measure(status);
+	}
+
+	const auto full_path{ replace_association_prefix(path) };
+	const auto file{ details::open_read_write(full_path) };
+	if (file == file_lock::closed_file) [[unlikely]] {
+		return measure(details::system_error(error_code::open_failed, __func__));
+	}
+	details::changed(full_path);
+
+	const auto status{ details::acquire_range(__func__, file, offset, size, mode == lock_mode::exclusive, timeout) };
+	if (status.has_error()) {
+		details::close_file(file);
+		return measure(status);
+	}
+
+	lock.m_file = file;
+	lock.m_offset = offset;
+	lock.m_size = size;
+	lock.m_mode = mode;
+	return OK;
+}
+
+filesystem::error filesystem::try_lock(const std::wstring_view path, file_lock &lock, const usize offset,
+		const usize size, const lock_mode mode) {
+	return filesystem::lock(path, lock, offset, size, mode, std::chrono::milliseconds::zero());
+}
+
+filesystem::error filesystem::unlock(file_lock &lock) {
+	return lock.unlock();
+}
+
+bool filesystem::is_locked(const std::wstring_view path, const usize offset, const usize size, const lock_mode mode) {
+	details::measurement measure{ io_operation::lock, __func__, path };
 	if (path.find(protocol_separator) == std::wstring_view::npos) [[unlikely]] {
-		return error{ L"[filesystem::write_binary] Protocol prefix expected in the path: '" +
-			std::wstring{ path } + L'\''
-		};
+		measure.fail();
+		return false;
 	}
+	return details::is_range_locked(replace_association_prefix(path), offset, size, mode == lock_mode::exclusive);
+}
 
-	if (auto status{ make_directory(parent_directory(path)) }; status.has_error()) {
-		status.message += L" (During creating parent directory for writing file '";
-		status.message += std::wstring{ path } + L"')";
-		return status;
-	}
+bool filesystem::is_unlocked(const std::wstring_view path, const usize offset, const usize size, const lock_mode mode) {
+	return !is_locked(path, offset, size, mode);
+}
 
-	return details::write_data(replace_association_prefix(path), text.data(), text.size());
+void filesystem::start_trace() noexcept {
+	details::trace.start();
 }
 
-filesystem::error filesystem::append_text(const std::wstring_view path, const std::string_view text) {
+filesystem::error filesystem::stop_trace(const std::wstring_view path) {
 	if (path.find(protocol_separator) == std::wstring_view::npos) [[unlikely]] {
-		return error{ L"[filesystem::write_binary] Protocol prefix expected in the path: '" +
-			std::wstring{ path } + L'\''
-		};
+		return error{ error_code::missing_protocol, 0, __func__ };
 	}
 
-	if (auto status{ make_directory(parent_directory(path)) }; status.has_error()) {
-		status.message += L" (During creating parent directory for writing file '";
-		status.message += std::wstring{ path } + L"')";
-		return status;
+	const auto records{ details::trace.stop() };
+	if (!records.has_value()) [[unlikely]] {
+		return error{ error_code::trace_not_started, 0, __func__ };
 	}
+	return write_binary_atomic(path, details::access_trace::serialize(*records), durability::none);
+}
 
-	return details::write_data(replace_association_prefix(path),
-		text.data(), text.size(), std::ios::app);
+bool filesystem::is_tracing() noexcept {
+	return details::trace.active();
 }
 
-filesystem::error filesystem::write_text(const std::wstring_view path, const std::wstring_view text) {
-	if (path.find(protocol_separator) == std::wstring_view::npos) [[unlikely]] {
-		return error{ L"[filesystem::write_binary] Protocol prefix expected in the path: '" +
-			std::wstring{ path } + L'\''
-		};
-	}
+std::future<usize> filesystem::replay_trace(const std::wstring_view path) {
+	// Read directly, so the trace itself never gets into the recording trace
+	const auto trace{ details::read_content<std::vector<byte>>(
+		replace_association_prefix(path), 0, std::numeric_limits<usize>::max(), read_mode::buffered)
+	};
+	auto records{ details::access_trace::deserialize(trace.value_or(std::vector<byte>{})) };
 
-	if (auto status{ make_directory(parent_directory(path)) }; status.has_error()) {
-		status.message += L" (During creating parent directory for writing file '";
-		status.message += std::wstring{ path } + L"')";
-		return status;
-	}
+	return details::schedule_for_each(std::move(records), [](const details::access_trace::record &record) {
+		return details::prefetch_file(record.path, record.offset, record.size);
+	});
+}
 
-	return details::write_data(replace_association_prefix(path), text.data(), text.size());
+void filesystem::set_trace_sink(trace_sink *sink) noexcept {
+	details::tracing_sink.store(sink, std::memory_order_release);
 }
 
-filesystem::error filesystem::append_text(const std::wstring_view path, const std::wstring_view text) {
-	if (path.find(protocol_separator) == std::wstring_view::npos) [[unlikely]] {
-		return error{ L"[filesystem::write_binary] Protocol prefix expected in the path: '" +
-			std::wstring{ path } + L'\''
-		};
-	}
+filesystem::trace_sink *filesystem::get_trace_sink() noexcept {
+	return details::tracing_sink.load(std::memory_order_acquire);
+}
 
-	if (auto status{ make_directory(parent_directory(path)) }; status.has_error()) {
-		status.message += L" (During creating parent directory for writing file '";
-		status.message += std::wstring{ path } + L"')";
-		return status;
-	}
+#if defined(GXZN_OS_FS_STATISTICS)
 
-	return details::write_data(replace_association_prefix(path),
-		text.data(), text.size(), std::ios::app);
+filesystem::statistics filesystem::stats() {
+	return details::io_statistics.snapshot();
 }
 
+void filesystem::reset_stats() {
+	details::io_statistics.reset();
+}
+
+#endif // defined(GXZN_OS_FS_STATISTICS)
+
 std::wstring_view filesystem::get_association(const std::wstring_view protocol) noexcept {
 	if (protocol.empty()) [[unlikely]] return none;
 
@@ -353,6 +2028,18 @@ void filesystem::join(std::wstring &left, std::wstring_view right) noexcept {
 	left += right;
 }
 
+void filesystem::join(path_buffer &left, std::wstring_view right) {
+	if (left.empty() || right.empty()) [[unlikely]] return;
+	if (const auto last{ left.back() }; last != separator) {
+		if (last == L'\\') [[unlikely]] left.pop_back();
+		left += separator;
+	}
+	if (right.front() == separator || right.front() == L'\\') [[unlikely]] {
+		right.remove_prefix(1);
+	}
+	left += right;
+}
+
 std::wstring filesystem::join(std::wstring_view left, std::wstring_view right) noexcept {
 	static const auto is_separator = [](const auto c) noexcept {
 		if (c.size() > 1) return false;
@@ -376,6 +2063,14 @@ void filesystem::parent_directory(std::wstring &path) noexcept {
 	}
 }
 
+void filesystem::parent_directory(path_buffer &path) noexcept {
+	if (const auto last_slash{ path.find_last_of(L"/\\") }; last_slash != path_buffer::npos) [[likely]] {
+		path.resize(last_slash);
+	} else {
+		path.clear();
+	}
+}
+
 std::wstring filesystem::parent_directory(const std::wstring_view path) noexcept {
 	if (const auto last_slash{ path.find_last_of(L"/\\") }; last_slash != std::wstring::npos) {
 		return std::wstring{ path.substr(0, last_slash + 1) };
@@ -384,119 +2079,115 @@ std::wstring filesystem::parent_directory(const std::wstring_view path) noexcept
 }
 
 std::wstring filesystem::normalize(std::wstring_view str) {
-	while(!str.empty() && str.front() == L' ') str.remove_prefix(1);
-	while(!str.empty() && str.back() == L' ') str.remove_suffix(1);
-	if (str.empty()) [[unlikely]] return L"";
-
-	static constexpr std::wstring_view slash{ L"\\/" };
-	static constexpr std::wstring_view prev_dir{ L".." };
-	static constexpr std::wstring_view curr_dir{ L"." };
-
-	std::wstring prefix;
-	if (str.find(L':') == 1) {
-		prefix.reserve(3);
-		prefix = str.substr(0, 2);
-		prefix += separator;
-		str.remove_prefix(2);
-	} else {
-		prefix = separator;
-	}
+	return details::normalize_path<std::wstring>(str);
+}
 
-	std::vector<std::wstring_view> parts;
-	parts.reserve(std::count_if(std::begin(str), std::end(str),
-		[](const auto &c){ return slash.find(c) != std::wstring_view::npos; }) + 1lu
-	);
-	usize prev_slash{};
-	usize curr_slash{};
-	usize next_slash{};
-
-	for(; next_slash != std::wstring_view::npos; prev_slash = std::exchange(curr_slash, next_slash + 1)) {
-		next_slash = str.find_first_of(slash, curr_slash);
-		const auto substr{ str.substr(curr_slash, next_slash - curr_slash) };
-
-		if (substr.empty() || substr == L" ") continue;
-		if (substr == curr_dir) [[unlikely]] continue;
-		if (substr == prev_dir) [[unlikely]] {
-			if (parts.empty() || parts.back().find(L':') != std::wstring_view::npos) [[unlikely]] {
-				return prefix;
-			}
-			parts.pop_back();
-			continue;
-		}
-		parts.emplace_back(substr);
-	}
+void filesystem::normalize(std::wstring &path) {
+	details::normalize_in_place(path);
+}
 
-	const usize length{ std::accumulate(
-		std::begin(parts), std::end(parts), usize{},
-		[](usize accum, const auto &str) { return accum + 1 + str.size(); }
-	)};
+usize filesystem::normalize(const std::wstring_view path, wchar_t *destination, const usize capacity) noexcept {
+	return details::normalize_to(path, destination, capacity);
+}
 
-	std::wstring result{ std::move(prefix) };
-	result.reserve(length);
+void filesystem::normalize(path_buffer &path) {
+	details::normalize_in_place(path);
+}
 
-	for (auto &&part : parts) {
-		if (!part.empty()) [[likely]] {
-			join(result, std::move(part));
-		}
+std::wstring filesystem::resolve(const std::wstring_view path) {
+	return replace_association_prefix(path).str();
+}
+
+void filesystem::resolve(const std::wstring_view path, path_buffer &result) {
+	result = replace_association_prefix(path);
+}
+
+void filesystem::resolve(const checked_path path, path_buffer &result) {
+	const auto prefix{ get_association(path.protocol()) };
+	if (prefix == none || !details::is_normalized(prefix)) [[unlikely]] {
+		result = replace_association_prefix(path.path);
+		return;
 	}
 
-	return result;
+	result = prefix;
+	if (const auto relative{ path.relative() }; !relative.empty()) {
+		if (result.back() != separator) result.push_back(separator);
+		result.append(relative);
+	}
 }
 
 bool filesystem::exists(const std::wstring_view path) noexcept {
 	if (path.empty()) return false;
 
-	return details::exists(replace_association_prefix(path));
+	details::measurement measure{ io_operation::stat, __func__, path };
+	const auto full_path{ replace_association_prefix(path) };
+	if (details::metadata.enabled()) [[unlikely]] {
+		return details::metadata.type(full_path) != details::entry_type::missing;
+	}
+	return details::exists(full_path);
+}
+
+bool filesystem::exists(const asset_id &id) noexcept {
+	if (path_buffer native; details::assets.find(id, native)) [[likely]] {
+		details::measurement measure{ io_operation::stat, __func__, id.path() };
+		if (details::metadata.enabled()) [[unlikely]] {
+			return details::metadata.type(native) != details::entry_type::missing;
+		}
+		return details::exists(native);
+	}
+	return exists(id.path());
+}
+
+bool filesystem::exists(const checked_path path) noexcept {
+	details::measurement measure{ io_operation::stat, __func__, path.path };
+	path_buffer native;
+	resolve(path, native);
+	if (details::metadata.enabled()) [[unlikely]] {
+		return details::metadata.type(native) != details::entry_type::missing;
+	}
+	return details::exists(native);
 }
 
 bool filesystem::is_file(const std::wstring_view path) {
 	if (path.empty()) return false;
 
-	return details::is_file(replace_association_prefix(path));
+	details::measurement measure{ io_operation::stat, __func__, path };
+	const auto full_path{ replace_association_prefix(path) };
+	if (details::metadata.enabled()) [[unlikely]] {
+		return details::metadata.type(full_path) == details::entry_type::file;
+	}
+	return details::is_file(full_path);
 }
 
 bool filesystem::is_directory(const std::wstring_view path) {
 	if (path.empty()) return false;
 
-	return details::is_directory(replace_association_prefix(path));
+	details::measurement measure{ io_operation::stat, __func__, path };
+	const auto full_path{ replace_association_prefix(path) };
+	if (details::metadata.enabled()) [[unlikely]] {
+		return details::metadata.type(full_path) == details::entry_type::directory;
+	}
+	return details::is_directory(full_path);
 }
 
 filesystem::error filesystem::make_directory(const std::wstring_view path) {
+	details::measurement measure{ io_operation::make_directory, __func__, path };
 	if (path.empty()) {
-		return error{ L"Empty path" };
-	}
-	if (is_directory(path)) return OK;
-	if (is_file(path)) {
-		return error{ L"Path is a file: '" + std::wstring{ path } + L'\'' };
-	}
-
-	const auto full_path{ replace_association_prefix(path) };
-
-	std::deque<std::wstring> parts;
-
-	std::wstring root{ full_path };
-	while (!root.empty() && !details::is_directory(root)) {
-		parts.emplace_front(root.substr(root.find_last_of(separator) + 1));
-		parent_directory(root);
+		return measure(error{ error_code::empty_path, 0, __func__ });
 	}
 
-	for (auto &&part : parts) {
-		if (join(root, part); !details::mkdir(root)) {
-			return error{ L"Cannot create directory: " + std::wstring{ root } };
-		}
-	}
-
-	return OK;
+	return measure(details::make_native_directory(__func__, get_protocol(path), replace_association_prefix(path)));
 }
 
 filesystem::error filesystem::remove_directory(const std::wstring_view path) {
+	details::measurement measure{ io_operation::remove, __func__, path };
 	if (path.empty()) {
-		return error{ L"Empty path" };
+		return measure(error{ error_code::empty_path, 0, __func__ });
 	}
 	if (!exists(path)) return OK;
 
 	if (!is_directory(path)) {
-		return error{ L"Not a directory: '" + std::wstring{ path } + L'\'' };
+		return measure(error{ error_code::not_a_directory, 0, __func__ });
 	}
 
 	const auto full_path{ replace_association_prefix(path) };
@@ -510,33 +2201,37 @@ filesystem::error filesystem::remove_directory(const std::wstring_view path) {
 			status = remove_file(entry_path);
 		}
 
-		if (status.has_error()) [[unlikely]] { return status; }
+		if (status.has_error()) [[unlikely]] { return measure(status); }
 	}
+	details::directories.forget(full_path);
 	if (!details::rmdir(full_path)) {
-		return error{ L"Cannot remove directory: '" + std::wstring{ path } + L'\'' };
+		return measure(details::system_error(error_code::remove_failed, __func__));
 	}
+	details::changed(full_path);
 
 	return OK;
 }
 
 filesystem::error filesystem::remove_file(const std::wstring_view path) {
+	details::measurement measure{ io_operation::remove, __func__, path };
 	if (path.empty()) {
-		return error{ L"Empty path" };
+		return measure(error{ error_code::empty_path, 0, __func__ });
 	}
 	if (!is_file(path)) return OK;
 
 	const auto full_path{ replace_association_prefix(path) };
 
 	if (!details::rmfile(full_path)) {
-		return error{ L"Cannot remove file: '" + std::wstring{ path } + L'\'' };
+		return measure(details::system_error(error_code::remove_failed, __func__));
 	}
+	details::changed(full_path);
 
 	return OK;
 }
 
 filesystem::error filesystem::remove(const std::wstring_view path) {
 	if (path.empty()) {
-		return error{ L"Empty path" };
+		return error{ error_code::empty_path, 0, __func__ };
 	}
 
 	if (!exists(path)) return OK;
@@ -548,11 +2243,217 @@ filesystem::error filesystem::remove(const std::wstring_view path) {
 	return remove_file(path);
 }
 
+filesystem::error filesystem::move_file(const std::wstring_view path, const std::wstring_view destination) {
+	details::measurement measure{ io_operation::move_file, __func__, path };
+	if (path.empty() || destination.empty()) {
+		return measure(error{ error_code::empty_path, 0, __func__ });
+	}
+	if (!is_file(path)) {
+		return measure(error{ error_code::not_a_file, 0, __func__ });
+	}
+
+	if (const auto status{ make_directory(parent_directory(destination)) }; status.has_error()) {
+		return measure(status);
+	}
+
+	const auto from{ replace_association_prefix(path) };
+	const auto to{ replace_association_prefix(destination) };
+	if (from == to) return OK;
+
+	if (!details::move_file(from, to)) {
+		return measure(details::system_error(error_code::move_failed, __func__));
+	}
+	details::changed(from);
+	details::changed(to);
+	return OK;
+}
+
+filesystem::error filesystem::copy_file(const std::wstring_view path, const std::wstring_view destination) {
+	details::measurement measure{ io_operation::copy_file, __func__, path };
+	if (path.empty() || destination.empty()) {
+		return measure(error{ error_code::empty_path, 0, __func__ });
+	}
+	if (!is_file(path)) {
+		return measure(error{ error_code::not_a_file, 0, __func__ });
+	}
+
+	if (const auto status{ make_directory(parent_directory(destination)) }; status.has_error()) {
+		return measure(status);
+	}
+
+	const auto from{ replace_association_prefix(path) };
+	const auto to{ replace_association_prefix(destination) };
+	if (from == to) return OK;
+
+	const bool copied{ details::copy_file(from, to) };
+	const auto status{ copied ? OK : details::system_error(error_code::copy_failed, __func__) };
+	details::changed(to);
+	return measure(status);
+}
+
+filesystem::error filesystem::copy_directory(const std::wstring_view path, const std::wstring_view destination,
+		const copy_progress_callback &progress, const usize threads) {
+	struct file_entry {
+		std::wstring relative;
+		usize size;
+	};
+
+	details::measurement measure{ io_operation::copy_directory, __func__, path };
+	if (path.empty() || destination.empty()) {
+		return measure(error{ error_code::empty_path, 0, __func__ });
+	}
+	if (!is_directory(path)) {
+		return measure(error{ error_code::not_a_directory, 0, __func__ });
+	}
+
+	const auto from{ replace_association_prefix(path) };
+	const auto to{ replace_association_prefix(destination) };
+	if (from == to) return OK;
+	// A link or another association can lead into the source, so the paths can't tell it by themselves.
+	// The destination's real ancestors are compared instead, since ".." is where the link points to
+	if (const auto source_id{ details::file_id(from) }; source_id.has_value()) {
+		std::wstring ancestor{ to.view() };
+		auto id{ details::file_id(ancestor) };
+		// The missing part of the destination is made later, so it can't be a link
+		for (auto cut{ ancestor.rfind(separator) }; !id.has_value() && cut != ancestor.find(separator);
+				cut = ancestor.rfind(separator)) {
+			ancestor.resize(cut);
+			id = details::file_id(ancestor);
+		}
+		for (bool is_destination{ ancestor.size() == to.size() }; id.has_value(); is_destination = false) {
+			if (id == source_id) {
+				if (is_destination) return OK;
+				return measure(error{ error_code::copy_into_itself, 0, __func__ });
+			}
+			ancestor.append(1, separator).append(L"..");
+			auto parent{ details::file_id(ancestor) };
+			if (parent == id) break; // The root is its own parent
+			id = std::move(parent);
+		}
+	}
+	if (auto status{ make_directory(destination) }; status.has_error()) {
+		return measure(status);
+	}
+
+	copy_progress total;
+	std::vector<file_entry> files;
+	bool directories_created{ true };
+	const bool walked{ details::walk(from, [&](const std::wstring_view relative, const bool is_directory, const usize size) {
+		if (is_directory) {
+			// The walk visits parents first, so there's always a single directory to create
+			const auto directory{ join(to, relative) };
+			directories_created = directories_created && (details::mkdir(directory) || details::is_directory(directory));
+			return;
+		}
+		files.push_back(file_entry{ std::wstring{ relative }, size });
+		total.bytes_total += size;
+	}) };
+	total.files_total = files.size();
+	const auto walk_status{ walked ? OK : details::system_error(error_code::read_failed, __func__) };
+	details::changed(to, true);
+
+	if (walk_status.has_error()) {
+		return measure(walk_status);
+	}
+	if (!directories_created) {
+		return measure(error{ error_code::make_directory_failed, 0, __func__ });
+	}
+
+	std::atomic<usize> next{ 0 };
+	std::atomic<usize> files_copied{ 0 };
+	std::atomic<usize> bytes_copied{ 0 };
+	std::atomic<bool> failed{ false };
+	std::mutex guard;
+	std::condition_variable copied;
+	int failed_error{};
+	usize running{};
+
+	// The workers share the locals, so every started one has to finish, even when it throws
+	const auto copy_files = [&] {
+		try {
+			for (auto index{ next++ }; index < files.size() && !failed; index = next++) {
+				const auto &file{ files[index] };
+				if (!details::copy_file(join(from, file.relative), join(to, file.relative))) [[unlikely]] {
+					const auto system{ details::last_error() };
+					std::lock_guard lock{ guard };
+					if (!failed.exchange(true)) failed_error = system;
+				}
+				{
+					std::lock_guard lock{ guard };
+					bytes_copied += file.size;
+					++files_copied;
+				}
+				copied.notify_one();
+			}
+		} catch (...) {
+			failed = true;
+		}
+		{
+			std::lock_guard lock{ guard };
+			--running;
+		}
+		copied.notify_one();
+	};
+
+	// The workers take the files from the shared counter, so any of them copies the rest if the
+	// pool is busy or smaller than requested
+	const usize workers_count{ std::clamp<usize>(threads != 0 ? threads : std::thread::hardware_concurrency(),
+		1, std::max<usize>(files.size(), 1))
+	};
+	usize started{};
+	for (; started < workers_count; ++started) {
+		{
+			std::lock_guard lock{ guard };
+			++running;
+		}
+		try {
+			details::background.push(copy_files);
+		} catch (...) {
+			std::lock_guard lock{ guard };
+			--running;
+			break;
+		}
+	}
+	if (started == 0) [[unlikely]] {
+		++running;
+		copy_files();
+	}
+
+	const auto snapshot = [&] {
+		copy_progress current{ total };
+		current.files_copied = files_copied;
+		current.bytes_copied = bytes_copied;
+		return current;
+	};
+	for (usize reported{}; progress && reported < files.size() && !failed; ) {
+		std::unique_lock lock{ guard };
+		copied.wait(lock, [&] { return files_copied != reported || failed; });
+		lock.unlock();
+
+		const auto current{ snapshot() };
+		reported = current.files_copied;
+		progress(current);
+	}
+
+	{
+		std::unique_lock lock{ guard };
+		copied.wait(lock, [&running] { return running == 0; });
+	}
+	details::changed(to, true);
+
+	if (failed) {
+		return measure(error{ error_code::copy_failed, failed_error, __func__ });
+	}
+	if (progress) progress(snapshot());
+	return measure.written(OK, total.bytes_total);
+}
+
 std::wstring filesystem::current_directory() {
 	return normalize(details::cwd());
 };
 
 std::vector<std::wstring> filesystem::entries(const std::wstring_view path) {
+	details::measurement measure{ io_operation::entries, __func__, path };
 	if (!is_directory(path)) return {};
 
 	const auto full_path{ replace_association_prefix(path) };
@@ -569,25 +2470,13 @@ std::wstring filesystem::to_wide(const std::string_view str) noexcept {
 }
 
 std::string filesystem::to_narrow(const std::wstring_view str) noexcept {
-	static constexpr u16 bits_per_char{ 8 };
 	static constexpr usize difference{
 		sizeof(std::wstring_view::value_type) / sizeof(std::string::value_type)
 	};
 
 	std::string result;
 	result.reserve(str.size() * difference);
-
-	for (const auto c : str) {
-		const auto int_c{ static_cast<u16>(c) };
-		const char left_part{ static_cast<char>(int_c >> bits_per_char) };
-		const char right_part{ static_cast<char>(int_c & 0x00FFu) };
-
-		if (left_part != u16{}) [[unlikely]] {
-			result += left_part;
-		}
-
-		result += right_part;
-	}
+	details::narrow_into(str, result);
 	return result;
 }
 
@@ -607,14 +2496,73 @@ void filesystem::associate(const std::string_view protocol_view, const std::stri
 	associate(to_wide(protocol_view), to_wide(prefix));
 }
 
-std::vector<byte> filesystem::read_binary(const std::string_view path) {
-	return read_binary(to_wide(path));
+std::vector<byte> filesystem::read_binary(const std::string_view path, const read_mode mode) {
+	return read_binary(to_wide(path), mode);
+}
+
+std::vector<byte> filesystem::read_binary(const std::string_view path, const usize offset,
+		const usize size, const read_mode mode) {
+	return read_binary(to_wide(path), offset, size, mode);
+}
+
+std::string filesystem::read_text(const std::string_view path, const read_mode mode) {
+	return read_text(to_wide(path), mode);
+}
+
+std::string filesystem::read_text(const std::string_view path, const usize offset,
+		const usize size, const read_mode mode) {
+	return read_text(to_wide(path), offset, size, mode);
+}
+
+std::vector<byte> filesystem::read_binary(const asset_id_narrow &id, const read_mode mode) {
+	if (path_buffer native, wide_id; details::assets.find(id, native, wide_id)) [[likely]] {
+		details::measurement measure{ io_operation::read, __func__, wide_id.view() };
+		return details::read_resolved<std::vector<byte>>(measure, native, 0, std::numeric_limits<usize>::max(), mode);
+	}
+	return read_binary(id.path(), mode);
+}
+
+std::string filesystem::read_text(const asset_id_narrow &id, const read_mode mode) {
+	if (path_buffer native, wide_id; details::assets.find(id, native, wide_id)) [[likely]] {
+		details::measurement measure{ io_operation::read, __func__, wide_id.view() };
+		return details::read_resolved<std::string>(measure, native, 0, std::numeric_limits<usize>::max(), mode);
+	}
+	return read_text(id.path(), mode);
+}
+
+filesystem::error filesystem::read_into(const std::string_view path,
+		const std::function<byte *(usize)> &destination, const read_mode mode) {
+	return read_into(to_wide(path), destination, mode);
+}
+
+mapped_file filesystem::map(const std::string_view path) {
+	return map(to_wide(path));
+}
+
+#if defined(GXZN_OS_FS_PMR)
+
+std::pmr::vector<byte> filesystem::read_binary(const std::string_view path, std::pmr::memory_resource *resource,
+		const read_mode mode) {
+	return read_binary(to_wide(path), resource, mode);
+}
+
+std::pmr::vector<byte> filesystem::read_binary(const std::string_view path, const usize offset,
+		const usize size, std::pmr::memory_resource *resource, const read_mode mode) {
+	return read_binary(to_wide(path), offset, size, resource, mode);
+}
+
+std::pmr::string filesystem::read_text(const std::string_view path, std::pmr::memory_resource *resource,
+		const read_mode mode) {
+	return read_text(to_wide(path), resource, mode);
 }
 
-std::string filesystem::read_text(const std::string_view path) {
-	return read_text(to_wide(path));
+std::pmr::string filesystem::read_text(const std::string_view path, const usize offset,
+		const usize size, std::pmr::memory_resource *resource, const read_mode mode) {
+	return read_text(to_wide(path), offset, size, resource, mode);
 }
 
+#endif // defined(GXZN_OS_FS_PMR)
+
 filesystem::error filesystem::write_binary(const std::string_view path, const details::data_view<byte> &data) {
 	return write_binary(to_wide(path), data);
 }
@@ -631,6 +2579,26 @@ filesystem::error filesystem::append_binary(const std::string_view path, const s
 	return append_binary(to_wide(path), data);
 }
 
+filesystem::error filesystem::write_binary(const std::string_view path,
+		const std::initializer_list<details::data_view<byte>> pieces) {
+	return write_binary(to_wide(path), pieces);
+}
+
+filesystem::error filesystem::write_binary(const std::string_view path,
+		const std::vector<details::data_view<byte>> &pieces) {
+	return write_binary(to_wide(path), pieces);
+}
+
+filesystem::error filesystem::append_binary(const std::string_view path,
+		const std::initializer_list<details::data_view<byte>> pieces) {
+	return append_binary(to_wide(path), pieces);
+}
+
+filesystem::error filesystem::append_binary(const std::string_view path,
+		const std::vector<details::data_view<byte>> &pieces) {
+	return append_binary(to_wide(path), pieces);
+}
+
 filesystem::error filesystem::write_text(const std::string_view path, const std::string_view text) {
 	return write_text(to_wide(path), text);
 }
@@ -647,6 +2615,97 @@ filesystem::error filesystem::append_text(const std::string_view path, const std
 	return append_text(to_wide(path), text);
 }
 
+filesystem::error filesystem::write_binary_atomic(const std::string_view path,
+		const details::data_view<byte> &data, const durability level) {
+	return write_binary_atomic(to_wide(path), data, level);
+}
+
+filesystem::error filesystem::write_binary_atomic(const std::string_view path,
+		const std::initializer_list<byte> data, const durability level) {
+	return write_binary_atomic(to_wide(path), data, level);
+}
+
+filesystem::error filesystem::write_text_atomic(const std::string_view path,
+		const std::string_view text, const durability level) {
+	return write_text_atomic(to_wide(path), text, level);
+}
+
+filesystem::error filesystem::write_text_atomic(const std::string_view path,
+		const std::wstring_view text, const durability level) {
+	return write_text_atomic(to_wide(path), text, level);
+}
+
+std::future<usize> filesystem::prefetch(const std::vector<std::string> &paths) {
+	std::vector<std::wstring> wide_paths;
+	wide_paths.reserve(paths.size());
+	for (const auto &path : paths) wide_paths.emplace_back(to_wide(path));
+	return prefetch(std::move(wide_paths));
+}
+
+std::future<usize> filesystem::prefetch(const std::initializer_list<std::string_view> paths) {
+	std::vector<std::wstring> wide_paths;
+	wide_paths.reserve(paths.size());
+	for (const auto &path : paths) wide_paths.emplace_back(to_wide(path));
+	return prefetch(std::move(wide_paths));
+}
+
+std::future<usize> filesystem::evict(const std::vector<std::string> &paths) {
+	std::vector<std::wstring> wide_paths;
+	wide_paths.reserve(paths.size());
+	for (const auto &path : paths) wide_paths.emplace_back(to_wide(path));
+	return evict(std::move(wide_paths));
+}
+
+std::future<usize> filesystem::evict(const std::initializer_list<std::string_view> paths) {
+	std::vector<std::wstring> wide_paths;
+	wide_paths.reserve(paths.size());
+	for (const auto &path : paths) wide_paths.emplace_back(to_wide(path));
+	return evict(std::move(wide_paths));
+}
+
+filesystem::error filesystem::build_index(const std::string_view protocol) {
+	return build_index(to_wide(protocol));
+}
+
+void filesystem::drop_index(const std::string_view protocol) {
+	drop_index(to_wide(protocol));
+}
+
+filesystem::error filesystem::lock(const std::string_view path, file_lock &lock, const usize offset,
+		const usize size, const lock_mode mode, const std::chrono::milliseconds timeout) {
+	return filesystem::lock(to_wide(path), lock, offset, size, mode, timeout);
+}
+
+filesystem::error filesystem::try_lock(const std::string_view path, file_lock &lock, const usize offset,
+		const usize size, const lock_mode mode) {
+	return try_lock(to_wide(path), lock, offset, size, mode);
+}
+
+bool filesystem::is_locked(const std::string_view path, const usize offset, const usize size, const lock_mode mode) {
+	return is_locked(to_wide(path), offset, size, mode);
+}
+
+bool filesystem::is_unlocked(const std::string_view path, const usize offset, const usize size, const lock_mode mode) {
+	return is_unlocked(to_wide(path), offset, size, mode);
+}
+
+filesystem::error filesystem::write_delta(const std::string_view path, const details::data_view<byte> &data,
+		const delta_mode mode, const usize block_size) {
+	return write_delta(to_wide(path), data, mode, block_size);
+}
+
+void filesystem::invalidate_metadata(const std::string_view path) {
+	invalidate_metadata(to_wide(path));
+}
+
+filesystem::error filesystem::stop_trace(const std::string_view path) {
+	return stop_trace(to_wide(path));
+}
+
+std::future<usize> filesystem::replay_trace(const std::string_view path) {
+	return replay_trace(to_wide(path));
+}
+
 std::wstring_view filesystem::get_association(const std::string_view protocol) noexcept {
 	return get_association(to_wide(protocol));
 }
@@ -666,6 +2725,18 @@ void filesystem::join(std::string &left, std::string_view right) noexcept {
 	left += right;
 }
 
+void filesystem::join(path_buffer_narrow &left, std::string_view right) {
+	if (left.empty() || right.empty()) [[unlikely]] return;
+	if (const auto last{ left.back() }; last != separator_narrow) {
+		if (last == '\\') [[unlikely]] left.pop_back();
+		left += separator_narrow;
+	}
+	if (right.front() == separator_narrow || right.front() == '\\') [[unlikely]] {
+		right.remove_prefix(1);
+	}
+	left += right;
+}
+
 std::string filesystem::join(std::string_view left, std::string_view right) noexcept {
 	static const auto is_separator = [](const auto c) noexcept {
 		if (c.size() > 1) return false;
@@ -689,6 +2760,14 @@ void filesystem::parent_directory(std::string &path) noexcept {
 	}
 }
 
+void filesystem::parent_directory(path_buffer_narrow &path) noexcept {
+	if (const auto last_slash{ path.find_last_of("/\\") }; last_slash != path_buffer_narrow::npos) [[likely]] {
+		path.resize(last_slash);
+	} else {
+		path.clear();
+	}
+}
+
 std::string filesystem::parent_directory(const std::string_view path) noexcept {
 	if (const auto last_slash{ path.find_last_of("/\\") }; last_slash != std::string::npos) [[likely]] {
 		return std::string{ path.substr(0, last_slash) };
@@ -700,10 +2779,37 @@ std::wstring filesystem::normalize(const std::string_view str) {
 	return normalize(to_wide(str));
 }
 
+void filesystem::normalize(std::string &path) {
+	details::normalize_in_place(path);
+}
+
+usize filesystem::normalize(const std::string_view path, char *destination, const usize capacity) noexcept {
+	return details::normalize_to(path, destination, capacity);
+}
+
+void filesystem::normalize(path_buffer_narrow &path) {
+	details::normalize_in_place(path);
+}
+
+std::wstring filesystem::resolve(const std::string_view path) {
+	return resolve(to_wide(path));
+}
+
 bool filesystem::exists(const std::string_view path) noexcept {
 	return exists(to_wide(path));
 }
 
+bool filesystem::exists(const asset_id_narrow &id) noexcept {
+	if (path_buffer native, wide_id; details::assets.find(id, native, wide_id)) [[likely]] {
+		details::measurement measure{ io_operation::stat, __func__, wide_id.view() };
+		if (details::metadata.enabled()) [[unlikely]] {
+			return details::metadata.type(native) != details::entry_type::missing;
+		}
+		return details::exists(native);
+	}
+	return exists(id.path());
+}
+
 bool filesystem::is_file(const std::string_view path) {
 	return is_file(to_wide(path));
 }
@@ -728,6 +2834,19 @@ filesystem::error filesystem::remove(const std::string_view path) {
 	return remove(to_wide(path));
 }
 
+filesystem::error filesystem::move_file(const std::string_view path, const std::string_view destination) {
+	return move_file(to_wide(path), to_wide(destination));
+}
+
+filesystem::error filesystem::copy_file(const std::string_view path, const std::string_view destination) {
+	return copy_file(to_wide(path), to_wide(destination));
+}
+
+filesystem::error filesystem::copy_directory(const std::string_view path, const std::string_view destination,
+		const copy_progress_callback &progress, const usize threads) {
+	return copy_directory(to_wide(path), to_wide(destination), progress, threads);
+}
+
 std::vector<std::string> filesystem::entries(const std::string_view path) {
 	if (!is_directory(path)) return {};
 
@@ -755,17 +2874,57 @@ std::wstring_view filesystem::get_protocol(const std::wstring_view path) noexcep
 	return L"";
 }
 
-std::wstring filesystem::replace_association_prefix(std::wstring_view path) noexcept {
+filesystem::path_buffer filesystem::replace_association_prefix(std::wstring_view path) noexcept {
+	path_buffer full_path;
+	if (const auto protocol{ get_protocol(path) }; !protocol.empty()) {
+		if (protocol == path) return path_buffer{ get_association(protocol) };
+
+		if (const auto prefix{ get_association(protocol) }; prefix != none) {
+			path.remove_prefix(protocol.size());
+			// normalize() drops the doubled separators, so it's the same as join(prefix, path)
+			full_path.reserve(prefix.size() + 1 + path.size());
+			full_path.append(prefix).push_back(separator);
+			full_path.append(path);
+		}
+	}
+	if (full_path.empty()) full_path = path;
+
+	details::normalize_in_place(full_path);
+	return full_path;
+}
+
+#if defined(GXZN_OS_FS_PMR)
+
+std::pmr::wstring filesystem::replace_association_prefix(std::wstring_view path,
+		std::pmr::memory_resource *resource) {
+	const std::pmr::polymorphic_allocator<wchar_t> allocator{ resource };
 	if (const auto protocol{ get_protocol(path) }; !protocol.empty()) {
-		if (protocol == path) return std::wstring{ get_association(protocol) };
+		if (protocol == path) return std::pmr::wstring{ get_association(protocol), allocator };
 
 		if (const auto prefix{ get_association(protocol) }; prefix != none) {
 			path.remove_prefix(protocol.size());
-			return normalize(join(prefix, path));
+			// normalize() drops the doubled separators, so it's the same as join(prefix, path)
+			std::pmr::wstring full_path{ allocator };
+			full_path.reserve(prefix.size() + 1 + path.size());
+			full_path.append(prefix).append(1, separator).append(path);
+			details::normalize_in_place(full_path);
+			return full_path;
 		}
 	}
 
-	return normalize(path);
+	return details::normalize_path<std::pmr::wstring>(path, allocator);
+}
+
+#endif // defined(GXZN_OS_FS_PMR)
+
+filesystem::error filesystem::make_checked_parent(const checked_path path, const std::wstring_view native) {
+	// The native path ends with the relative part of the checked path, so the parent is the same cut
+	const auto cut{ path.path.size() - path.parent_size };
+	if (cut >= native.size()) [[unlikely]] return OK;
+
+	auto parent{ native.substr(0, native.size() - cut) };
+	if (parent.size() > 1 && parent.back() == separator) parent.remove_suffix(1);
+	return details::make_native_directory("make_directory", path.protocol(), parent);
 }
 
 std::wstring filesystem::setup_assets_directories(const std::wstring_view assets_path) {
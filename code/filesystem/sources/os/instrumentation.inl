@@ -0,0 +1,292 @@
+#include <deque>
+#include <mutex>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <string_view>
+
+namespace golxzn::os::details {
+
+#if defined(GXZN_OS_FS_STATISTICS)
+
+/** System calls issued by the current thread. The platform code counts them with count_syscalls() */
+inline thread_local u64 issued_syscalls{};
+
+inline void count_syscalls(const u64 count = 1) noexcept {
+	issued_syscalls += count;
+}
+
+/**
+ * Owner of the counters of every thread. Each thread writes only its own shard, so the counters are
+ * updated with plain relaxed loads and stores. The shards are merged when the snapshot is taken, and
+ * the shards of the finished threads are folded into the retired statistics.
+ */
+class statistics_registry {
+public:
+	struct counters {
+		std::atomic<u64> calls;
+		std::atomic<u64> errors;
+		std::atomic<u64> bytes_read;
+		std::atomic<u64> bytes_written;
+		std::atomic<u64> syscalls;
+		std::array<std::atomic<u64>, filesystem::operation_statistics::latency_buckets> latency;
+	};
+	using protocol_counters = std::array<counters, static_cast<usize>(filesystem::io_operation::count)>;
+
+	struct shard {
+		std::mutex guard; // Taken by the owner only when it meets a new protocol
+		std::deque<std::pair<std::wstring, protocol_counters>> protocols;
+	};
+
+	std::shared_ptr<shard> attach() {
+		auto data{ std::make_shared<shard>() };
+		std::lock_guard lock{ guard };
+		shards.push_back(data);
+		return data;
+	}
+
+	void detach(const std::shared_ptr<shard> &data) {
+		std::lock_guard lock{ guard };
+		merge(retired, *data);
+		shards.erase(std::remove(std::begin(shards), std::end(shards), data), std::end(shards));
+	}
+
+	[[nodiscard]] filesystem::statistics snapshot() {
+		std::lock_guard lock{ guard };
+		auto result{ collect() };
+		for (auto &[protocol, operations] : result) {
+			const auto found{ baseline.find(protocol) };
+			if (found == std::end(baseline)) continue;
+
+			for (usize i{}; i < operations.size(); ++i) {
+				subtract(operations[i], found->second[i]);
+			}
+		}
+		return result;
+	}
+
+	void reset() {
+		std::lock_guard lock{ guard };
+		baseline = collect();
+	}
+
+private:
+	std::mutex guard;
+	std::vector<std::shared_ptr<shard>> shards;
+	filesystem::statistics retired;
+	filesystem::statistics baseline;
+
+	filesystem::statistics collect() {
+		auto result{ retired };
+		for (const auto &data : shards) {
+			merge(result, *data);
+		}
+		return result;
+	}
+
+	static void merge(filesystem::statistics &to, shard &from) {
+		std::lock_guard lock{ from.guard };
+		for (const auto &[protocol, operations] : from.protocols) {
+			auto &target{ to[protocol] };
+			for (usize i{}; i < operations.size(); ++i) {
+				const auto &source{ operations[i] };
+				target[i].calls += source.calls.load(std::memory_order_relaxed);
+				target[i].errors += source.errors.load(std::memory_order_relaxed);
+				target[i].bytes_read += source.bytes_read.load(std::memory_order_relaxed);
+				target[i].bytes_written += source.bytes_written.load(std::memory_order_relaxed);
+				target[i].syscalls += source.syscalls.load(std::memory_order_relaxed);
+				for (usize bucket{}; bucket < source.latency.size(); ++bucket) {
+					target[i].latency[bucket] += source.latency[bucket].load(std::memory_order_relaxed);
+				}
+			}
+		}
+	}
+
+	static void subtract(filesystem::operation_statistics &from, const filesystem::operation_statistics &value) {
+		from.calls -= value.calls;
+		from.errors -= value.errors;
+		from.bytes_read -= value.bytes_read;
+		from.bytes_written -= value.bytes_written;
+		from.syscalls -= value.syscalls;
+		for (usize bucket{}; bucket < from.latency.size(); ++bucket) {
+			from.latency[bucket] -= value.latency[bucket];
+		}
+	}
+};
+
+// Defined before the background workers, so they're stopped before the registry is destroyed
+static statistics_registry io_statistics;
+
+/** The shard of the current thread */
+class thread_statistics {
+public:
+	thread_statistics() : data{ io_statistics.attach() } {}
+	~thread_statistics() { io_statistics.detach(data); }
+
+	thread_statistics(const thread_statistics &) = delete;
+	thread_statistics &operator=(const thread_statistics &) = delete;
+
+	statistics_registry::protocol_counters &operator[](const std::wstring_view protocol) {
+		// Only this thread adds the protocols, so it can look them up without the lock
+		for (auto &[name, operations] : data->protocols) {
+			if (name == protocol) [[likely]] return operations;
+		}
+
+		std::lock_guard lock{ data->guard };
+		return data->protocols.emplace_back(std::piecewise_construct,
+			std::forward_as_tuple(protocol), std::forward_as_tuple()).second;
+	}
+
+	u32 depth{}; ///< Number of the public calls on the stack
+
+private:
+	std::shared_ptr<statistics_registry::shard> data;
+};
+
+static thread_local thread_statistics local_statistics;
+
+#else
+
+inline void count_syscalls(const u64 = 1) noexcept {}
+
+#endif // defined(GXZN_OS_FS_STATISTICS)
+
+/** Sink set by filesystem::set_trace_sink() */
+inline std::atomic<filesystem::trace_sink *> tracing_sink{ nullptr };
+
+/** Small sequential number of the current thread. Trace viewers show them better than the native ids */
+inline u64 thread_number() noexcept {
+	static std::atomic<u64> next{ 1 };
+	static thread_local const u64 number{ next.fetch_add(1, std::memory_order_relaxed) };
+	return number;
+}
+
+/**
+ * Traces the public call it's created in and counts it into the statistics. Without a trace sink and
+ * with the statistics compiled out it costs a single atomic load. Only the outermost public call is
+ * counted into the statistics, while every call gets its own span.
+ */
+class measurement {
+	using clock = std::chrono::steady_clock;
+
+public:
+	measurement(const filesystem::io_operation operation, const std::string_view name,
+			const std::wstring_view path) noexcept
+		: sink{ tracing_sink.load(std::memory_order_acquire) }, operation{ operation }, name{ name }, path{ path }
+#if defined(GXZN_OS_FS_STATISTICS)
+		, outermost{ local_statistics.depth++ == 0 }, syscalls{ issued_syscalls }
+#endif // defined(GXZN_OS_FS_STATISTICS)
+	{
+		if (!timed()) [[likely]] return;
+
+		start = clock::now();
+		if (sink != nullptr) [[unlikely]] sink->begin(make_span());
+	}
+
+	~measurement() {
+#if defined(GXZN_OS_FS_STATISTICS)
+		--local_statistics.depth;
+#endif // defined(GXZN_OS_FS_STATISTICS)
+		if (!timed()) [[likely]] return;
+
+		const auto finish{ clock::now() };
+		if (sink != nullptr) [[unlikely]] {
+			auto call{ make_span() };
+			call.size = bytes_read + bytes_written;
+			call.failed = failed;
+			call.end = finish;
+			sink->end(call);
+		}
+
+#if defined(GXZN_OS_FS_STATISTICS)
+		if (outermost) count(finish - start);
+#endif // defined(GXZN_OS_FS_STATISTICS)
+	}
+
+	measurement(const measurement &) = delete;
+	measurement &operator=(const measurement &) = delete;
+
+	void read(const usize count) noexcept { bytes_read += count; }
+	void fail() noexcept { failed = true; }
+
+	filesystem::error operator()(filesystem::error status) noexcept {
+		if (status.has_error()) [[unlikely]] failed = true;
+		return status;
+	}
+
+	filesystem::error written(filesystem::error status, const usize count) noexcept {
+		if (status.has_error()) [[unlikely]] failed = true;
+		else bytes_written += count;
+		return status;
+	}
+
+private:
+	filesystem::trace_sink *const sink;
+	const filesystem::io_operation operation;
+	const std::string_view name;
+	const std::wstring_view path;
+#if defined(GXZN_OS_FS_STATISTICS)
+	const bool outermost;
+	const u64 syscalls;
+#endif // defined(GXZN_OS_FS_STATISTICS)
+	clock::time_point start{};
+	u64 bytes_read{};
+	u64 bytes_written{};
+	bool failed{ false };
+
+	[[nodiscard]] bool timed() const noexcept {
+#if defined(GXZN_OS_FS_STATISTICS)
+		return outermost || sink != nullptr;
+#else
+		return sink != nullptr;
+#endif // defined(GXZN_OS_FS_STATISTICS)
+	}
+
+	[[nodiscard]] filesystem::span make_span() const noexcept {
+		filesystem::span call;
+		call.operation = operation;
+		call.name = name;
+		call.path = path;
+		call.thread = thread_number();
+		call.begin = start;
+		return call;
+	}
+
+#if defined(GXZN_OS_FS_STATISTICS)
+	void count(const clock::duration elapsed) {
+		const auto nanoseconds{ std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() };
+		auto &counters{ local_statistics[protocol()][static_cast<usize>(operation)] };
+		add(counters.calls, 1);
+		add(counters.errors, failed ? 1 : 0);
+		add(counters.bytes_read, bytes_read);
+		add(counters.bytes_written, bytes_written);
+		add(counters.syscalls, issued_syscalls - syscalls);
+		add(counters.latency[bucket(static_cast<u64>(nanoseconds))], 1);
+	}
+
+	[[nodiscard]] std::wstring_view protocol() const noexcept {
+		if (const auto found{ path.find(filesystem::protocol_separator) }; found != std::wstring_view::npos) {
+			return path.substr(0, found + filesystem::protocol_separator.size());
+		}
+		return filesystem::none;
+	}
+
+	static void add(std::atomic<u64> &counter, const u64 value) noexcept {
+		counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+	}
+
+	static usize bucket(u64 nanoseconds) noexcept {
+		usize index{};
+		for (; nanoseconds != 0 && index + 1 < filesystem::operation_statistics::latency_buckets; ++index) {
+			nanoseconds >>= 1;
+		}
+		return index;
+	}
+#endif // defined(GXZN_OS_FS_STATISTICS)
+};
+
+} // namespace golxzn::os::details
@@ -0,0 +1,259 @@
+#include <string>
+#include <algorithm>
+#include <string_view>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# include <emmintrin.h>
+# define GXZN_OS_FS_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+# include <arm_neon.h>
+# define GXZN_OS_FS_NEON
+#endif
+
+namespace golxzn::os::details {
+
+template<class Char>
+constexpr bool is_separator(const Char c) noexcept {
+	return c == Char('/') || c == Char('\\');
+}
+
+#if defined(GXZN_OS_FS_SSE2)
+inline u32 count_trailing_zeros(const u32 mask) noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+	unsigned long index{};
+	_BitScanForward(&index, mask);
+	return static_cast<u32>(index);
+#else
+	return static_cast<u32>(__builtin_ctz(mask));
+#endif // defined(_MSC_VER) && !defined(__clang__)
+}
+#endif // defined(GXZN_OS_FS_SSE2)
+
+/**
+ * The first '/' or '\' in [first, last) or @p last. Checks 16 bytes at once with SSE2 or NEON, so a
+ * whole path component usually takes a single compare.
+ */
+template<class Char>
+const Char *find_separator(const Char *first, const Char *const last) noexcept {
+	static_assert(sizeof(Char) == 1 || sizeof(Char) == 2 || sizeof(Char) == 4);
+	[[maybe_unused]] static constexpr std::ptrdiff_t lanes{ 16 / sizeof(Char) };
+
+#if defined(GXZN_OS_FS_SSE2)
+	for (; last - first >= lanes; first += lanes) {
+		const auto chunk{ _mm_loadu_si128(reinterpret_cast<const __m128i *>(first)) };
+		__m128i matches;
+		if constexpr (sizeof(Char) == 1) {
+			matches = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('/')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\')));
+		} else if constexpr (sizeof(Char) == 2) {
+			matches = _mm_or_si128(_mm_cmpeq_epi16(chunk, _mm_set1_epi16('/')), _mm_cmpeq_epi16(chunk, _mm_set1_epi16('\\')));
+		} else {
+			matches = _mm_or_si128(_mm_cmpeq_epi32(chunk, _mm_set1_epi32('/')), _mm_cmpeq_epi32(chunk, _mm_set1_epi32('\\')));
+		}
+		if (const auto mask{ static_cast<u32>(_mm_movemask_epi8(matches)) }; mask != 0) {
+			return first + count_trailing_zeros(mask) / sizeof(Char);
+		}
+	}
+#elif defined(GXZN_OS_FS_NEON)
+	for (; last - first >= lanes; first += lanes) {
+		uint8x16_t matches;
+		if constexpr (sizeof(Char) == 1) {
+			const auto chunk{ vld1q_u8(reinterpret_cast<const uint8_t *>(first)) };
+			matches = vorrq_u8(vceqq_u8(chunk, vdupq_n_u8('/')), vceqq_u8(chunk, vdupq_n_u8('\\')));
+		} else if constexpr (sizeof(Char) == 2) {
+			const auto chunk{ vld1q_u16(reinterpret_cast<const uint16_t *>(first)) };
+			matches = vreinterpretq_u8_u16(vorrq_u16(vceqq_u16(chunk, vdupq_n_u16('/')), vceqq_u16(chunk, vdupq_n_u16('\\'))));
+		} else {
+			const auto chunk{ vld1q_u32(reinterpret_cast<const uint32_t *>(first)) };
+			matches = vreinterpretq_u8_u32(vorrq_u32(vceqq_u32(chunk, vdupq_n_u32('/')), vceqq_u32(chunk, vdupq_n_u32('\\'))));
+		}
+		if (vmaxvq_u8(matches) != 0) break; // The scalar loop below finds it within the chunk
+	}
+#endif // defined(GXZN_OS_FS_SSE2)
+
+	for (; first != last; ++first) {
+		if (is_separator(*first)) return first;
+	}
+	return last;
+}
+
+template<class Char>
+std::basic_string_view<Char> trim_spaces(std::basic_string_view<Char> path) noexcept {
+	while (!path.empty() && path.front() == Char(' ')) path.remove_prefix(1);
+	while (!path.empty() && path.back() == Char(' ')) path.remove_suffix(1);
+	return path;
+}
+
+/** 2 if the path starts with a drive ("C:"), i.e. its first ':' is the second character, 0 otherwise */
+template<class Char>
+usize drive_length(const std::basic_string_view<Char> path) noexcept {
+	return path.size() > 1 && path[1] == Char(':') && path[0] != Char(':') ? 2 : 0;
+}
+
+/**
+ * True if filesystem::normalize() wouldn't change the path: no surrounding spaces, the root separator
+ * after the optional drive, only '/' separators, no empty, ".", ".." or " " components and no
+ * trailing separator. Most of the paths built by the library itself are like that.
+ */
+template<class Char>
+bool is_normalized(const std::basic_string_view<Char> path) noexcept {
+	if (path.empty()) return true;
+	if (path.front() == Char(' ') || path.back() == Char(' ')) return false;
+
+	const auto drive{ drive_length(path) };
+	if (path.size() == drive || path[drive] != Char('/')) return false;
+
+	const Char *cursor{ path.data() + drive + 1 };
+	const Char *const end{ path.data() + path.size() };
+	if (cursor == end) return true; // "/" or "C:/"
+
+	while (true) {
+		const auto next{ find_separator(cursor, end) };
+		const auto length{ static_cast<usize>(next - cursor) };
+		if (length == 0) return false; // "//" or the trailing separator
+		if (length == 1 && (cursor[0] == Char('.') || cursor[0] == Char(' '))) return false;
+		if (length == 2 && cursor[0] == Char('.') && cursor[1] == Char('.')) return false;
+
+		if (next == end) return true;
+		if (*next != Char('/')) return false;
+		cursor = next + 1;
+	}
+}
+
+/**
+ * The single pass of filesystem::normalize(). Writes the result to @p out, which needs room for
+ * `path.size() + 1` characters, and returns its length.
+ * @p out may point into @p path itself if the path has the root separator after the optional drive
+ * or there's a leading space: then the output never gets ahead of the input.
+ */
+template<class Char>
+usize normalize_into(std::basic_string_view<Char> path, Char *const out) noexcept {
+	path = trim_spaces(path);
+	if (path.empty()) [[unlikely]] return 0;
+
+	usize length{};
+	if (const auto drive{ drive_length(path) }; drive != 0) {
+		out[length++] = path[0];
+		out[length++] = path[1];
+		path.remove_prefix(drive);
+	}
+	out[length++] = Char('/');
+	const usize root{ length };
+
+	const Char *cursor{ path.data() };
+	const Char *const end{ path.data() + path.size() };
+	while (cursor != end) {
+		if (is_separator(*cursor)) {
+			++cursor;
+			continue;
+		}
+
+		const auto next{ find_separator(cursor, end) };
+		const std::basic_string_view<Char> part{ cursor, static_cast<usize>(next - cursor) };
+		cursor = next;
+
+		if (part.size() == 1 && (part[0] == Char('.') || part[0] == Char(' '))) continue;
+		if (part.size() == 2 && part[0] == Char('.') && part[1] == Char('.')) [[unlikely]] {
+			auto start{ length };
+			while (start > root && out[start - 1] != Char('/')) --start;
+			// Nothing to step out of: only the root (or the drive) is left
+			if (length == root || std::find(out + start, out + length, Char(':')) != out + length) {
+				return root;
+			}
+			length = start > root ? start - 1 : root;
+			continue;
+		}
+
+		if (length != root) out[length++] = Char('/');
+		std::char_traits<Char>::move(out + length, part.data(), part.size());
+		length += part.size();
+	}
+	return length;
+}
+
+/** filesystem::normalize(std::wstring &path) for any string type */
+template<class String>
+void normalize_in_place(String &path) {
+	using char_type = typename String::value_type;
+	const std::basic_string_view<char_type> view{ path };
+	if (is_normalized(view)) [[likely]] return;
+
+	const auto first{ view.find_first_not_of(char_type(' ')) };
+	if (first == std::basic_string_view<char_type>::npos) {
+		path.clear();
+		return;
+	}
+	// Without the root separator the output gets one character ahead of the input. A leading space
+	// gives it the room and it's trimmed anyway
+	if (const auto root{ first + drive_length(view.substr(first)) }; root == path.size() || !is_separator(path[root])) {
+		path.insert(0, 1, char_type(' '));
+	}
+	path.resize(normalize_into(std::basic_string_view<char_type>{ path }, path.data()));
+}
+
+/** filesystem::normalize(std::wstring_view path, wchar_t *destination, usize capacity) for any char type */
+template<class Char>
+usize normalize_to(std::basic_string_view<Char> path, Char *const destination, const usize capacity) noexcept {
+	if (destination == nullptr || capacity < path.size() + 2) [[unlikely]] return std::basic_string_view<Char>::npos;
+
+	if (is_normalized(path)) [[likely]] {
+		std::char_traits<Char>::move(destination, path.data(), path.size());
+		destination[path.size()] = Char{};
+		return path.size();
+	}
+
+	if (destination == path.data()) {
+		// The same trick as normalize_in_place(): the leading space makes room for the missing root separator
+		const auto first{ path.find_first_not_of(Char(' ')) };
+		if (first != std::basic_string_view<Char>::npos) {
+			const auto root{ first + drive_length(path.substr(first)) };
+			if (root == path.size() || !is_separator(path[root])) {
+				std::char_traits<Char>::move(destination + 1, destination, path.size());
+				destination[0] = Char(' ');
+				path = std::basic_string_view<Char>{ destination, path.size() + 1 };
+			}
+		}
+	}
+
+	const auto length{ normalize_into(path, destination) };
+	destination[length] = Char{};
+	return length;
+}
+
+/** filesystem::normalize() into any string type, e.g. std::pmr::wstring */
+template<class String>
+String normalize_path(const std::basic_string_view<typename String::value_type> path,
+		const typename String::allocator_type &allocator = {}) {
+	if (is_normalized(path)) [[likely]] return String{ path, allocator };
+
+	String result(path.size() + 1, typename String::value_type{}, allocator);
+	result.resize(normalize_into(path, result.data()));
+	return result;
+}
+
+/** filesystem::to_narrow() into any string type, e.g. filesystem::path_buffer_narrow. Appends to @p result */
+template<class String>
+void narrow_into(const std::wstring_view path, String &result) {
+	static constexpr u16 bits_per_char{ 8 };
+
+	for (const auto c : path) {
+		const auto int_c{ static_cast<u16>(c) };
+		const char left_part{ static_cast<char>(int_c >> bits_per_char) };
+		const char right_part{ static_cast<char>(int_c & 0x00FFu) };
+
+		if (left_part != u16{}) [[unlikely]] {
+			result += left_part;
+		}
+
+		result += right_part;
+	}
+}
+
+/** What a path points to, as the type_of() of the platforms reports it */
+enum class entry_type : u16 {
+	missing,
+	file,
+	directory,
+	other,
+};
+
+} // namespace golxzn::os::details
@@ -1,6 +1,18 @@
 
 #include "unix.inl"
 
+#include <thread>
+#include <functional>
+#include <unordered_set>
+#include <unordered_map>
+
+#include <poll.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/sendfile.h>
+
 namespace golxzn::os::details {
 
 std::wstring appdata_directory() {
@@ -13,6 +25,250 @@ std::wstring appdata_directory() {
 	return L"~/.config";
 }
 
+bool copy_file(const std::wstring_view from, const std::wstring_view to) {
+	auto source_at{ __unix_at(from) };
+	const int source{ __unix_call_at(source_at, [&source_at] {
+		count_syscalls();
+		return ::openat(source_at.directory, source_at.c_str(), O_RDONLY | O_CLOEXEC);
+	}) };
+	if (source < 0) return false;
+
+	struct stat st;
+	count_syscalls();
+	if (::fstat(source, &st) != 0) {
+		count_syscalls();
+		::close(source);
+		return false;
+	}
+
+	// Truncating the destination would empty the source if it's the same file, so there's nothing to copy
+	auto destination_at{ __unix_at(to) };
+	struct stat existing;
+	const bool destination_exists{ __unix_call_at(destination_at, [&destination_at, &existing] {
+		count_syscalls();
+		return ::fstatat(destination_at.directory, destination_at.c_str(), &existing, 0);
+	}) == 0 };
+	if (destination_exists && __unix_same_file(st, existing)) {
+		count_syscalls();
+		::close(source);
+		return true;
+	}
+
+	const int destination{ __unix_call_at(destination_at, [&destination_at, &st] {
+		count_syscalls();
+		return ::openat(destination_at.directory, destination_at.c_str(),
+			O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, st.st_mode & 07777);
+	}) };
+	if (destination < 0) {
+		count_syscalls();
+		::close(source);
+		return false;
+	}
+
+	const auto copy = [source, destination, size = static_cast<usize>(st.st_size)] {
+		// Reflink shares the extents on copy-on-write filesystems (btrfs, XFS, bcachefs)
+		count_syscalls();
+		if (::ioctl(destination, FICLONE, source) == 0) return true;
+		// Files like the ones in procfs report zero size, so only reading them tells the truth
+		if (size == 0) return __unix_copy_buffered(source, destination);
+
+		// Each stage continues from the file offsets the previous one has stopped at
+		auto copied{ usize{} };
+		while (copied < size) {
+			count_syscalls();
+			const auto count{ ::copy_file_range(source, nullptr, destination, nullptr, size - copied, 0) };
+			if (count <= 0) break;
+			copied += static_cast<usize>(count);
+		}
+		if (copied >= size) return true;
+
+		while (copied < size) {
+			count_syscalls();
+			const auto count{ ::sendfile(destination, source, nullptr, size - copied) };
+			if (count <= 0) break;
+			copied += static_cast<usize>(count);
+		}
+		if (copied >= size) return true;
+
+		return __unix_copy_buffered(source, destination);
+	};
+
+	bool success{ copy() };
+	count_syscalls();
+	success = (::close(destination) == 0) && success;
+	count_syscalls();
+	::close(source);
+	return success;
+}
+
+/**
+ * Changes made behind the back of the metadata cache. The parents of the cached paths are watched
+ * with inotify, and a thread reports their created, removed and renamed entries. A watch stays
+ * until its directory is gone or the watcher stops. If the events overflow, everything is reported.
+ */
+class change_watcher {
+public:
+	/** Receives the changed path and whether everything under it changed too. Empty path is everything */
+	using callback = std::function<void(std::wstring_view, bool)>;
+
+	~change_watcher() { stop(); }
+
+	bool start(callback on_change) {
+		std::lock_guard lock{ guard };
+		count_syscalls();
+		notify = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		count_syscalls();
+		wakeup = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (notify < 0 || wakeup < 0) {
+			close_descriptors();
+			return false;
+		}
+		thread = std::thread{ [this, on_change = std::move(on_change)] { run(on_change); } };
+		return true;
+	}
+
+	/** Watches the @p directory if it's not watched yet. A missing one isn't watched at all */
+	void watch(const std::wstring_view directory) {
+		std::wstring key{ directory };
+		std::lock_guard lock{ guard };
+		if (notify < 0 || watched.count(key) != 0) return;
+
+		count_syscalls();
+		const int descriptor{ ::inotify_add_watch(notify, __unix_native(directory).c_str(), events) };
+		if (descriptor < 0) return;
+		watched.insert(key);
+		directories.insert_or_assign(descriptor, std::move(key));
+	}
+
+	void stop() {
+		if (thread.joinable()) {
+			const std::uint64_t signal{ 1 };
+			count_syscalls();
+			[[maybe_unused]] const auto written{ ::write(wakeup, &signal, sizeof(signal)) };
+			thread.join();
+		}
+		std::lock_guard lock{ guard };
+		close_descriptors();
+		directories.clear();
+		watched.clear();
+	}
+
+private:
+	static constexpr std::uint32_t events{
+		IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR
+	};
+
+	std::mutex guard;
+	int notify{ -1 };
+	int wakeup{ -1 };
+	std::thread thread;
+	std::unordered_map<int, std::wstring> directories;
+	std::unordered_set<std::wstring> watched;
+
+	void run(const callback &on_change) {
+		alignas(inotify_event) char buffer[16 * 1024];
+		pollfd descriptors[]{ { notify, POLLIN, 0 }, { wakeup, POLLIN, 0 } };
+		while (true) {
+			count_syscalls();
+			if (::poll(descriptors, 2, -1) < 0) {
+				if (errno == EINTR) continue;
+				return;
+			}
+			if (descriptors[1].revents != 0) return;
+
+			count_syscalls();
+			const auto count{ ::read(notify, buffer, sizeof(buffer)) };
+			if (count <= 0) continue;
+			for (auto position{ buffer }; position < buffer + count; ) {
+				const auto &event{ *reinterpret_cast<const inotify_event *>(position) };
+				position += sizeof(inotify_event) + event.len;
+				report(event, on_change);
+			}
+		}
+	}
+
+	void report(const inotify_event &event, const callback &on_change) {
+		if ((event.mask & IN_Q_OVERFLOW) != 0) {
+			on_change(std::wstring_view{}, true);
+			return;
+		}
+
+		std::wstring path;
+		{
+			std::lock_guard lock{ guard };
+			const auto found{ directories.find(event.wd) };
+			if (found == std::end(directories)) return;
+			if ((event.mask & IN_IGNORED) != 0) {
+				watched.erase(found->second);
+				directories.erase(found);
+				return;
+			}
+			path = found->second;
+		}
+
+		// The events of the directory itself have no name
+		if (event.len == 0) {
+			on_change(path, true);
+			return;
+		}
+		path += filesystem::separator;
+		path += filesystem::to_wide(std::string_view{ event.name });
+		on_change(path, (event.mask & IN_ISDIR) != 0);
+	}
+
+	void close_descriptors() noexcept {
+		if (notify >= 0) {
+			count_syscalls();
+			::close(std::exchange(notify, -1));
+		}
+		if (wakeup >= 0) {
+			count_syscalls();
+			::close(std::exchange(wakeup, -1));
+		}
+	}
+};
+
+/** Reserves the blocks and sets the size at once, so the writes inside neither allocate nor grow the file */
+bool __unix_preallocate(const int fd, const usize size) {
+	count_syscalls();
+	return ::fallocate(fd, 0, 0, static_cast<off_t>(size)) == 0;
+}
+
+/**
+ * readahead() blocks until the range is read into the page cache. Returns the number of bytes of
+ * the range which ended up there.
+ */
+usize prefetch_file(const std::wstring_view path, const usize offset, usize size) {
+	const int fd{ __unix_open_range(path, offset, size) };
+	if (fd < 0) return 0;
+
+	if (size != 0) {
+		count_syscalls();
+		if (::readahead(fd, static_cast<off64_t>(offset), size) != 0) {
+			count_syscalls();
+			::posix_fadvise(fd, static_cast<off_t>(offset), static_cast<off_t>(size), POSIX_FADV_WILLNEED);
+		}
+	}
+	const auto warmed{ __unix_resident_bytes(fd, offset, size) };
+	count_syscalls();
+	::close(fd);
+	return warmed;
+}
+
+/** Drops the clean pages of the range from the page cache. Returns the number of dropped bytes */
+usize evict_file(const std::wstring_view path, const usize offset, usize size) {
+	const int fd{ __unix_open_range(path, offset, size) };
+	if (fd < 0) return 0;
+
+	const auto before{ __unix_resident_bytes(fd, offset, size) };
+	count_syscalls();
+	::posix_fadvise(fd, static_cast<off_t>(offset), static_cast<off_t>(size), POSIX_FADV_DONTNEED);
+	const auto after{ __unix_resident_bytes(fd, offset, size) };
+	count_syscalls();
+	::close(fd);
+	return before > after ? before - after : 0;
+}
+
 // Implemented in platform/unix.inl
 // std::wstring cwd() { }
 
@@ -1,6 +1,8 @@
 
 #include "unix.inl"
 
+#include <copyfile.h>
+
 namespace golxzn::os::details {
 
 std::wstring appdata_directory() {
@@ -11,6 +13,96 @@ std::wstring appdata_directory() {
 	return L"~/Library/Application Support";
 }
 
+bool copy_file(const std::wstring_view from, const std::wstring_view to) {
+	const auto narrow_from{ __unix_native(from) };
+	const auto narrow_to{ __unix_native(to) };
+
+	// Truncating the destination would empty the source if it's the same file, so there's nothing to copy
+	struct stat source_stat;
+	struct stat destination_stat;
+	count_syscalls(2);
+	if (::stat(narrow_from.c_str(), &source_stat) != 0) return false;
+	if (::stat(narrow_to.c_str(), &destination_stat) == 0 && __unix_same_file(source_stat, destination_stat)) {
+		return true;
+	}
+
+	// Clones the file on APFS and falls back to a kernel copy otherwise
+	count_syscalls();
+	if (::copyfile(narrow_from.c_str(), narrow_to.c_str(), nullptr,
+			COPYFILE_CLONE | COPYFILE_DATA | COPYFILE_STAT) == 0) [[likely]] {
+		return true;
+	}
+
+	count_syscalls();
+	const int source{ ::open(narrow_from.c_str(), O_RDONLY | O_CLOEXEC) };
+	if (source < 0) return false;
+
+	count_syscalls();
+	const int destination{ ::open(narrow_to.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666) };
+	if (destination < 0) {
+		count_syscalls();
+		::close(source);
+		return false;
+	}
+
+	bool success{ __unix_copy_buffered(source, destination) };
+	count_syscalls();
+	success = (::close(destination) == 0) && success;
+	count_syscalls();
+	::close(source);
+	return success;
+}
+
+/**
+ * Changes made behind the back of the metadata cache. FSEvents needs a run loop and kqueue needs
+ * a descriptor per directory, so nothing is watched and the cached results just expire.
+ */
+class change_watcher {
+public:
+	template<class Callback>
+	bool start(Callback &&) noexcept { return false; }
+	void watch(const std::wstring_view) noexcept {}
+	void stop() noexcept {}
+};
+
+/** Reserves the space, contiguous if possible, and sets the size, so the writes inside don't grow the file */
+bool __unix_preallocate(const int fd, const usize size) {
+	fstore_t store{ F_ALLOCATECONTIG | F_ALLOCATEALL, F_PEOFPOSMODE, 0, static_cast<off_t>(size), 0 };
+	count_syscalls();
+	if (::fcntl(fd, F_PREALLOCATE, &store) != 0) {
+		store.fst_flags = F_ALLOCATEALL;
+		count_syscalls();
+		if (::fcntl(fd, F_PREALLOCATE, &store) != 0) return false;
+	}
+	count_syscalls();
+	return ::ftruncate(fd, static_cast<off_t>(size)) == 0;
+}
+
+/** Returns the number of bytes of the range which ended up in the unified buffer cache */
+usize prefetch_file(const std::wstring_view path, const usize offset, usize size) {
+	static constexpr usize max_advice{ 1u << 30 }; // ra_count is an int
+
+	const int fd{ __unix_open_range(path, offset, size) };
+	if (fd < 0) return 0;
+
+	for (usize advised{}; advised < size; advised += max_advice) {
+		radvisory advice{};
+		advice.ra_offset = static_cast<off_t>(offset + advised);
+		advice.ra_count = static_cast<int>(std::min(max_advice, size - advised));
+		count_syscalls();
+		if (::fcntl(fd, F_RDADVISE, &advice) != 0) break;
+	}
+	const auto warmed{ __unix_resident_bytes(fd, offset, size) };
+	count_syscalls();
+	::close(fd);
+	return warmed;
+}
+
+/** MacOS has no way to drop the cached pages of a single file */
+usize evict_file(const std::wstring_view, const usize, usize) {
+	return 0;
+}
+
 // Implemented in platform/unix.inl
 // std::wstring cwd() { }
 
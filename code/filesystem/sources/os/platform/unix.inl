@@ -1,15 +1,216 @@
 
+#include <mutex>
+#include <atomic>
+#include <cerrno>
 #include <string>
+#include <vector>
+#include <memory>
 #include <cstring>
+#include <optional>
+#include <algorithm>
+#include <shared_mutex>
+#include <condition_variable>
 
 #include <pwd.h>
+#include <fcntl.h>
+#include <limits.h>
 #include <unistd.h>
 #include <dirent.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <sys/types.h>
 
 namespace golxzn::os::details {
 
+static constexpr mode_t __unix_directory_mode{ S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH };
+
+#if defined(O_PATH)
+static constexpr int __unix_directory_flags{ O_PATH | O_DIRECTORY | O_CLOEXEC };
+#else
+static constexpr int __unix_directory_flags{ O_RDONLY | O_DIRECTORY | O_CLOEXEC };
+#endif // defined(O_PATH)
+
+// fdopendir() checks the descriptor with fstat() and fcntl(). readdir() calls getdents() for the
+// entries and once more to find the end, which is enough for all but the huge directories
+static constexpr u64 __unix_fdopendir_syscalls{ 2 };
+static constexpr u64 __unix_readdir_syscalls{ 2 };
+
+/** Native path for the syscalls. It fits the inline storage almost always, so it doesn't allocate */
+filesystem::path_buffer_narrow __unix_native(const std::wstring_view path) {
+	filesystem::path_buffer_narrow native;
+	native.reserve(path.size());
+	narrow_into(path, native);
+	return native;
+}
+
+/** Root directory of an association. It's opened on the first use and closed with the last user */
+class __unix_root {
+public:
+	explicit __unix_root(std::string native) noexcept : path{ std::move(native) } {}
+	~__unix_root() {
+		if (const int fd{ descriptor.load(std::memory_order_acquire) }; fd >= 0) ::close(fd);
+	}
+
+	/** The descriptor or -1 if the directory cannot be opened. Racing openers keep the first one */
+	int open() const noexcept {
+		if (const int fd{ descriptor.load(std::memory_order_acquire) }; fd >= 0) [[likely]] return fd;
+
+		count_syscalls();
+		const int fd{ ::open(path.c_str(), __unix_directory_flags) };
+		if (fd < 0) return -1;
+		if (int expected{ -1 }; !descriptor.compare_exchange_strong(expected, fd, std::memory_order_acq_rel)) {
+			count_syscalls();
+			::close(fd);
+			return expected;
+		}
+		return fd;
+	}
+
+	const std::string path;
+
+private:
+	mutable std::atomic<int> descriptor{ -1 };
+};
+
+/** A path split into the directory descriptor and the path relative to it for the *at() syscalls */
+struct __unix_location {
+	std::shared_ptr<const __unix_root> root; // Keeps the descriptor open
+	int directory{ AT_FDCWD };
+	usize offset{};
+	filesystem::path_buffer_narrow native;
+
+	const char *c_str() const noexcept { return native.c_str() + offset; }
+};
+
+/**
+ * The open root directories of the associations. The paths under a root are resolved relative to
+ * its descriptor, so the kernel doesn't walk the association prefix on every call. The roots are
+ * replaced by filesystem::associate and after the library removes them. A root removed by someone
+ * else is replaced by the first call which fails under it, see __unix_call_at(). A renamed one keeps
+ * pointing to the old directory until it's associated again.
+ */
+class __unix_root_directories {
+public:
+	void assign(const std::wstring_view protocol, const std::wstring_view prefix) {
+		auto native{ filesystem::to_narrow(filesystem::normalize(prefix)) };
+		std::unique_lock lock{ guard };
+		const auto found{ std::find_if(std::begin(roots), std::end(roots),
+			[protocol](const auto &entry) { return entry.first == protocol; })
+		};
+		// "/" gives nothing to skip
+		if (native.size() <= 1) {
+			if (found != std::end(roots)) roots.erase(found);
+			return;
+		}
+		auto root{ std::make_shared<const __unix_root>(std::move(native)) };
+		if (found != std::end(roots)) {
+			found->second = std::move(root);
+		} else {
+			roots.emplace_back(std::wstring{ protocol }, std::move(root));
+		}
+	}
+
+	/** Reopens the roots at or under the removed @p path on their next use */
+	void forget(const std::wstring_view path) {
+		const auto native{ __unix_native(path) };
+		const std::string_view removed{ native.view() };
+		std::unique_lock lock{ guard };
+		for (auto &[protocol, root] : roots) {
+			if (root->path.size() >= removed.size() && root->path.compare(0, removed.size(), removed) == 0 &&
+					(root->path.size() == removed.size() || root->path[removed.size()] == '/')) {
+				root = std::make_shared<const __unix_root>(root->path);
+			}
+		}
+	}
+
+	/**
+	 * Replaces the root of @p at if its directory was removed and points @p at to AT_FDCWD and the
+	 * full path. A removed directory has no links left. Keeps errno, so the caller reports the failure
+	 */
+	bool reroot(__unix_location &at) {
+		if (at.root == nullptr) return false;
+
+		const int error{ errno };
+		if (error != ESTALE) {
+			struct stat st;
+			count_syscalls();
+			if (::fstat(at.directory, &st) == 0 && st.st_nlink != 0) [[likely]] {
+				errno = error;
+				return false;
+			}
+		}
+		{
+			std::unique_lock lock{ guard };
+			for (auto &[protocol, root] : roots) {
+				if (root == at.root) root = std::make_shared<const __unix_root>(root->path);
+			}
+		}
+		at.root = nullptr;
+		at.directory = AT_FDCWD;
+		at.offset = 0;
+		errno = error;
+		return true;
+	}
+
+	/** The deepest root strictly containing @p path, or AT_FDCWD and the full path */
+	__unix_location locate(const std::wstring_view path) const {
+		__unix_location location{ nullptr, AT_FDCWD, 0, __unix_native(path) };
+		const std::string_view native{ location.native.view() };
+		{
+			std::shared_lock lock{ guard };
+			for (const auto &[protocol, root] : roots) {
+				const auto &prefix{ root->path };
+				if (location.root != nullptr && prefix.size() <= location.root->path.size()) continue;
+				if (native.size() > prefix.size() + 1 && native[prefix.size()] == '/' &&
+						native.compare(0, prefix.size(), prefix) == 0) {
+					location.root = root;
+				}
+			}
+		}
+		if (location.root == nullptr) return location;
+
+		if (const int fd{ location.root->open() }; fd >= 0) [[likely]] {
+			location.directory = fd;
+			location.offset = location.root->path.size() + 1;
+		} else {
+			location.root = nullptr;
+		}
+		return location;
+	}
+
+private:
+	mutable std::shared_mutex guard;
+	std::vector<std::pair<std::wstring, std::shared_ptr<const __unix_root>>> roots;
+};
+
+static __unix_root_directories __unix_roots;
+
+__unix_location __unix_at(const std::wstring_view path) {
+	return __unix_roots.locate(path);
+}
+
+/** Whether the call under the root of @p at failed because the root is gone. See reroot() */
+bool __unix_reroot(__unix_location &at) {
+	return (errno == ENOENT || errno == ESTALE) && __unix_roots.reroot(at);
+}
+
+/**
+ * Makes the *at() @p call, which reads @p at, and repeats it once through the full path if it failed
+ * because the root was removed behind our back. The later calls of the same location need no checks
+ */
+template<class Call>
+auto __unix_call_at(__unix_location &at, Call &&call) {
+	auto result{ call() };
+	if (result < 0 && __unix_reroot(at)) [[unlikely]] result = call();
+	return result;
+}
+
+/** Called by filesystem::associate with the new @p prefix of the @p protocol */
+void associate_root(const std::wstring_view protocol, const std::wstring_view prefix) {
+	__unix_roots.assign(protocol, prefix);
+}
+
 std::wstring __unix_get_home() {
 	const uid_t uid{ getuid() };
 
@@ -43,32 +244,62 @@ std::wstring cwd() {
 	return L"./";
 }
 
+/** fstatat() of @p path. Returns false if it failed */
+bool __unix_stat(const std::wstring_view path, struct stat &st) {
+	auto at{ __unix_at(path) };
+	return __unix_call_at(at, [&] {
+		count_syscalls();
+		return ::fstatat(at.directory, at.c_str(), &st, 0);
+	}) == 0;
+}
+
 bool exists(const std::wstring_view path) {
 	struct stat st;
-	return stat(filesystem::to_narrow(path).c_str(), &st) == 0;
+	return __unix_stat(path, st);
+}
+
+/** The device and the inode of the file, which are the same for its every path. Empty if it's missing */
+std::optional<std::pair<u64, u64>> file_id(const std::wstring_view path) {
+	if (struct stat st; __unix_stat(path, st)) {
+		return std::pair{ static_cast<u64>(st.st_dev), static_cast<u64>(st.st_ino) };
+	}
+	return std::nullopt;
 }
 
 bool is_file(const std::wstring_view path) {
-	const auto narrow_path{ filesystem::to_narrow(path) };
-	if (struct stat st; stat(narrow_path.c_str(), &st) == 0) {
+	if (struct stat st; __unix_stat(path, st)) {
 		return S_ISREG(st.st_mode);
 	}
 	return false;
 }
 
 bool is_directory(const std::wstring_view path) {
-	const auto narrow_path{ filesystem::to_narrow(path) };
-	if (struct stat st; stat(narrow_path.c_str(), &st) == 0) {
+	if (struct stat st; __unix_stat(path, st)) {
 		return S_ISDIR(st.st_mode);
 	}
 	return false;
 }
 
+entry_type type_of(const std::wstring_view path) {
+	struct stat st;
+	if (!__unix_stat(path, st)) return entry_type::missing;
+	if (S_ISREG(st.st_mode)) return entry_type::file;
+	return S_ISDIR(st.st_mode) ? entry_type::directory : entry_type::other;
+}
+
 std::vector<std::wstring> ls(const std::wstring_view path) {
 	std::vector<std::wstring> entries;
 
-	const auto dir_path{ filesystem::to_narrow(path) };
-	if (auto dir{ opendir(dir_path.c_str()) }; dir != nullptr) {
+	auto at{ __unix_at(path) };
+	const int fd{ __unix_call_at(at, [&at] {
+		count_syscalls();
+		return ::openat(at.directory, at.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	}) };
+	if (fd < 0) return entries;
+
+	count_syscalls(__unix_fdopendir_syscalls);
+	if (auto dir{ ::fdopendir(fd) }; dir != nullptr) {
+		count_syscalls(__unix_readdir_syscalls);
 		dirent* entry{ nullptr };
 		while ((entry = readdir(dir)) != nullptr) {
 			const std::string_view name{ entry->d_name };
@@ -77,21 +308,852 @@ std::vector<std::wstring> ls(const std::wstring_view path) {
 				entries.emplace_back(filesystem::to_wide(name));
 			}
 		}
+		count_syscalls();
 		closedir(dir);
+	} else {
+		count_syscalls();
+		::close(fd);
 	}
 	return entries;
 }
 
 bool mkdir(const std::wstring_view path) {
-	return ::mkdir(filesystem::to_narrow(path).c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH) == 0;
+	auto at{ __unix_at(path) };
+	return __unix_call_at(at, [&at] {
+		count_syscalls();
+		return ::mkdirat(at.directory, at.c_str(), __unix_directory_mode);
+	}) == 0;
+}
+
+/**
+ * Creates the directory and all missing parents. The leaf is tried first, so an existing or
+ * almost existing tree costs a single syscall. Only on ENOENT the path is walked upward until
+ * an existing ancestor is found, and the missing tail is created with mkdirat() relative to
+ * the parent's descriptor instead of resolving the whole path from the root again. Under an
+ * association root the walk stops at the root, which exists unless someone else has removed it.
+ * Then the root is replaced and the whole path is walked.
+ */
+bool make_directories(const std::wstring_view path) {
+	auto at{ __unix_at(path) };
+	if (at.native.empty()) [[unlikely]] return false;
+
+	const int made{ __unix_call_at(at, [&at] {
+		count_syscalls();
+		return ::mkdirat(at.directory, at.c_str(), __unix_directory_mode);
+	}) };
+	if (made == 0) [[likely]] return true;
+
+	// Offsets below are relative to the path after the root
+	auto &narrow{ at.native };
+	const auto first{ at.offset };
+	const auto relative = [&narrow, first](const usize begin) { return narrow.c_str() + first + begin; };
+
+	if (errno == EEXIST) {
+		struct stat st;
+		count_syscalls();
+		return ::fstatat(at.directory, at.c_str(), &st, 0) == 0 && S_ISDIR(st.st_mode);
+	}
+	if (errno != ENOENT) return false;
+
+	const std::string_view tail{ at.c_str() };
+	std::vector<usize> missing{ tail.size() }; // End offsets of the components to create
+	usize base_end{ 0 };
+	for (usize end{ tail.size() }; ; ) {
+		const auto slash{ tail.rfind('/', end - 1) };
+		if (slash == std::string::npos || slash == 0) {
+			base_end = slash == 0 ? 1 : 0;
+			break;
+		}
+
+		narrow[first + slash] = '\0';
+		count_syscalls();
+		const bool created{ ::mkdirat(at.directory, relative(0), __unix_directory_mode) == 0 };
+		const int status{ errno };
+		narrow[first + slash] = '/';
+
+		if (created || status == EEXIST) {
+			base_end = slash;
+			break;
+		}
+		if (status != ENOENT) return false;
+
+		missing.emplace_back(slash);
+		end = slash;
+	}
+
+	int parent{ at.directory };
+	if (base_end != 0) {
+		const char saved{ narrow[first + base_end] };
+		narrow[first + base_end] = '\0';
+		count_syscalls();
+		parent = ::openat(at.directory, relative(0), __unix_directory_flags);
+		narrow[first + base_end] = saved;
+		if (parent < 0) return false;
+	}
+
+	bool success{ true };
+	for (usize begin{ base_end }, index{ missing.size() }; index-- > 0; begin = missing[index]) {
+		const auto end{ missing[index] };
+		narrow[first + end] = '\0';
+		const auto name{ relative(tail[begin] == '/' ? begin + 1 : begin) };
+
+		count_syscalls();
+		if (::mkdirat(parent, name, __unix_directory_mode) != 0 && errno != EEXIST) {
+			success = false;
+			break;
+		}
+		if (index == 0) break;
+
+		count_syscalls();
+		const int child{ ::openat(parent, name, __unix_directory_flags) };
+		narrow[first + end] = '/';
+		if (parent != at.directory) {
+			count_syscalls();
+			::close(parent);
+		}
+		if ((parent = child) < 0) return false;
+	}
+
+	if (parent != at.directory) {
+		count_syscalls();
+		::close(parent);
+	}
+	return success;
+}
+
+bool __unix_write_all(const int fd, const void *data, usize size) {
+	auto begin{ static_cast<const char *>(data) };
+	while (size != 0) {
+		count_syscalls();
+		const auto written{ ::write(fd, begin, size) };
+		if (written < 0) {
+			if (errno == EINTR) continue;
+			return false;
+		}
+		begin += written;
+		size -= static_cast<usize>(written);
+	}
+	return true;
+}
+
+bool __unix_sync_data(const int fd) {
+	count_syscalls();
+#if defined(GXZN_OS_FS_MACOS)
+	// fsync on MacOS doesn't ask the drive to flush its cache
+	return ::fcntl(fd, F_FULLFSYNC) == 0 || ::fsync(fd) == 0;
+#else
+	return ::fdatasync(fd) == 0;
+#endif // defined(GXZN_OS_FS_MACOS)
+}
+
+/**
+ * Group commit of the directory flushes. Every writer which renamed a file into a directory joins
+ * the pending round of that directory. The first writer which finds no flush in progress takes
+ * the whole round and calls fsync() once for everyone who joined before it started.
+ */
+class __unix_directory_sync_group {
+public:
+	bool sync(const std::string &directory) {
+		std::unique_lock lock{ guard };
+		auto &state{ directories[directory] };
+		if (state.pending == nullptr) {
+			state.pending = std::make_shared<round>();
+		}
+		const auto mine{ state.pending };
+
+		while (!mine->done) {
+			if (state.syncing) {
+				flushed.wait(lock);
+				continue;
+			}
+
+			const auto current{ std::exchange(state.pending, nullptr) };
+			state.syncing = true;
+			lock.unlock();
+
+			bool success{ false };
+			count_syscalls();
+			if (const int fd{ ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC) }; fd >= 0) {
+				count_syscalls();
+				success = ::fsync(fd) == 0;
+				count_syscalls();
+				::close(fd);
+			}
+
+			lock.lock();
+			current->success = success;
+			current->done = true;
+			state.syncing = false;
+			flushed.notify_all();
+		}
+		return mine->success;
+	}
+
+private:
+	struct round {
+		bool done{ false };
+		bool success{ false };
+	};
+	struct directory_state {
+		std::shared_ptr<round> pending;
+		bool syncing{ false };
+	};
+
+	std::mutex guard;
+	std::condition_variable flushed;
+	std::unordered_map<std::string, directory_state> directories;
+};
+
+static __unix_directory_sync_group __unix_directory_syncs;
+
+bool write_atomically(const std::wstring_view path, const void *data, const usize size,
+		const filesystem::durability level) {
+	static std::atomic<usize> counter{ 0 };
+
+	auto at{ __unix_at(path) };
+	const std::string_view native{ at.native.view() };
+	const auto last_slash{ native.rfind('/') };
+	const std::string directory{ last_slash == 0 ? std::string_view{ "/" } : native.substr(0, last_slash) };
+
+	// The temporary file is created next to the destination, relative to the same directory
+	int fd{ -1 };
+	std::string temporary;
+	for (usize attempt{}; fd < 0 && attempt < 8; ++attempt) {
+		const auto suffix{ '.' + std::to_string(::getpid()) + '.' +
+			std::to_string(counter.fetch_add(1, std::memory_order_relaxed)) + ".tmp"
+		};
+		fd = __unix_call_at(at, [&] {
+			temporary = at.c_str() + suffix;
+			count_syscalls();
+			return ::openat(at.directory, temporary.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+		});
+		if (fd < 0 && errno != EEXIST) return false;
+	}
+	if (fd < 0) return false;
+	const auto destination{ at.c_str() };
+
+	// Keep the permissions of the file we're replacing
+	count_syscalls();
+	if (struct stat st; ::fstatat(at.directory, destination, &st, 0) == 0) {
+		count_syscalls();
+		::fchmod(fd, st.st_mode & 07777);
+	}
+
+	bool success{ __unix_write_all(fd, data, size) };
+	if (success && level != filesystem::durability::none) {
+		success = __unix_sync_data(fd);
+	}
+	count_syscalls();
+	success = (::close(fd) == 0) && success;
+
+	if (success) {
+		count_syscalls();
+		success = ::renameat(at.directory, temporary.c_str(), at.directory, destination) == 0;
+	}
+	if (!success) {
+		count_syscalls();
+		::unlinkat(at.directory, temporary.c_str(), 0);
+		return false;
+	}
+
+	if (level == filesystem::durability::full) {
+		return __unix_directory_syncs.sync(directory);
+	}
+	return true;
+}
+
+#if defined(IOV_MAX)
+static constexpr usize __unix_iov_max{ IOV_MAX };
+#else
+static constexpr usize __unix_iov_max{ 16 }; // _XOPEN_IOV_MAX, the least POSIX allows
+#endif // defined(IOV_MAX)
+
+/** writev() of every piece, IOV_MAX of them per call. Partial writes continue from the first unwritten byte */
+bool __unix_write_all(const int fd, const data_view<byte> *pieces, const usize count) {
+	std::array<iovec, __unix_iov_max> vectors;
+	for (usize next{}; next < count; ) {
+		usize used{};
+		for (; next < count && used < vectors.size(); ++next) {
+			if (pieces[next].size() == 0) continue;
+			vectors[used++] = iovec{ const_cast<byte *>(pieces[next].data()), pieces[next].size() };
+		}
+
+		for (auto first{ vectors.data() }, last{ first + used }; first != last; ) {
+			count_syscalls();
+			const auto written{ ::writev(fd, first, static_cast<int>(last - first)) };
+			if (written < 0) {
+				if (errno == EINTR) continue;
+				return false;
+			}
+			for (auto left{ static_cast<usize>(written) }; left != 0; ) {
+				if (left < first->iov_len) {
+					first->iov_base = static_cast<char *>(first->iov_base) + left;
+					first->iov_len -= left;
+					break;
+				}
+				left -= first->iov_len;
+				++first;
+			}
+			while (first != last && first->iov_len == 0) ++first;
+		}
+	}
+	return true;
+}
+
+filesystem::error_code write_gathered(const std::wstring_view path, const data_view<byte> *pieces,
+		const usize count, const bool append) {
+	auto at{ __unix_at(path) };
+	const int fd{ __unix_call_at(at, [&at, append] {
+		count_syscalls();
+		return ::openat(at.directory, at.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | (append ? O_APPEND : O_TRUNC), 0666);
+	}) };
+	if (fd < 0) return filesystem::error_code::open_failed;
+
+	const bool success{ __unix_write_all(fd, pieces, count) };
+	const int saved_errno{ errno };
+	count_syscalls();
+	::close(fd);
+	errno = saved_errno;
+	return success ? filesystem::error_code::ok : filesystem::error_code::write_failed;
+}
+
+// Implemented in platform/linux.inl and platform/macos.inl
+bool __unix_preallocate(const int fd, const usize size);
+
+/**
+ * Creates the segment of filesystem::segment_writer with @p size bytes reserved. The file gets its
+ * final size right away, so the appends don't change it. Returns -1 if the file exists or on failure
+ */
+std::intptr_t open_segment(const std::wstring_view path, const usize size) {
+	auto at{ __unix_at(path) };
+	const int fd{ __unix_call_at(at, [&at] {
+		count_syscalls();
+		return ::openat(at.directory, at.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+	}) };
+	if (fd < 0) return -1;
+
+	// A sparse file at least keeps the appends from updating the size
+	bool reserved{ __unix_preallocate(fd, size) };
+	if (!reserved) {
+		count_syscalls();
+		reserved = ::ftruncate(fd, static_cast<off_t>(size)) == 0;
+	}
+	if (!reserved) {
+		const int saved_errno{ errno };
+		count_syscalls();
+		::close(fd);
+		count_syscalls();
+		::unlinkat(at.directory, at.c_str(), 0);
+		errno = saved_errno;
+		return -1;
+	}
+	return fd;
+}
+
+bool write_at(const std::intptr_t file, usize offset, const void *data, usize size) {
+	auto begin{ static_cast<const char *>(data) };
+	while (size != 0) {
+		count_syscalls();
+		const auto written{ ::pwrite(static_cast<int>(file), begin, size, static_cast<off_t>(offset)) };
+		if (written < 0) {
+			if (errno == EINTR) continue;
+			return false;
+		}
+		begin += written;
+		offset += static_cast<usize>(written);
+		size -= static_cast<usize>(written);
+	}
+	return true;
+}
+
+/** Cuts the file at @p used bytes, e.g. the unused preallocation of a segment, and closes it */
+bool close_truncated(const std::intptr_t file, const usize used) {
+	const int fd{ static_cast<int>(file) };
+	count_syscalls();
+	const bool truncated{ ::ftruncate(fd, static_cast<off_t>(used)) == 0 };
+	const int saved_errno{ errno };
+	count_syscalls();
+	const bool closed{ ::close(fd) == 0 };
+	if (!truncated) errno = saved_errno;
+	return truncated && closed;
+}
+
+#if defined(F_OFD_SETLK)
+static constexpr int __unix_set_lock{ F_OFD_SETLK };
+static constexpr int __unix_set_lock_wait{ F_OFD_SETLKW };
+static constexpr int __unix_get_lock{ F_OFD_GETLK };
+#else
+// Only the process-wide locks are available, e.g. on MacOS
+static constexpr int __unix_set_lock{ F_SETLK };
+static constexpr int __unix_set_lock_wait{ F_SETLKW };
+static constexpr int __unix_get_lock{ F_GETLK };
+#endif // defined(F_OFD_SETLK)
+
+/** The range of fcntl. Its `l_pid` has to be zero for the open file description locks */
+struct flock __unix_lock_range(const short type, const usize offset, const usize size) noexcept {
+	struct flock range{};
+	range.l_type = type;
+	range.l_whence = SEEK_SET;
+	range.l_start = static_cast<off_t>(offset);
+	range.l_len = static_cast<off_t>(size);
+	return range;
+}
+
+/** Opens the file for reading and writing, creating it if it's missing. Returns -1 on failure */
+std::intptr_t open_read_write(const std::wstring_view path) {
+	auto at{ __unix_at(path) };
+	return __unix_call_at(at, [&at] {
+		count_syscalls();
+		return ::openat(at.directory, at.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+	});
+}
+
+/** Without @p wait it fails at once if the range is busy, see range_busy_error() */
+bool lock_range(const std::intptr_t file, const usize offset, const usize size, const bool exclusive,
+		const bool wait) {
+	auto range{ __unix_lock_range(exclusive ? F_WRLCK : F_RDLCK, offset, size) };
+	while (true) {
+		count_syscalls();
+		if (::fcntl(static_cast<int>(file), wait ? __unix_set_lock_wait : __unix_set_lock, &range) == 0) return true;
+		if (errno != EINTR) return false;
+	}
+}
+
+/** The last failed lock_range() was refused because someone else holds the range */
+bool range_busy_error() noexcept {
+	return errno == EAGAIN || errno == EACCES;
+}
+
+bool unlock_range(const std::intptr_t file, const usize offset, const usize size) {
+	auto range{ __unix_lock_range(F_UNLCK, offset, size) };
+	count_syscalls();
+	return ::fcntl(static_cast<int>(file), __unix_set_lock, &range) == 0;
+}
+
+void close_file(const std::intptr_t file) noexcept {
+	count_syscalls();
+	::close(static_cast<int>(file));
+}
+
+bool sync_file(const std::intptr_t file) {
+	return __unix_sync_data(static_cast<int>(file));
+}
+
+usize process_id() noexcept {
+	return static_cast<usize>(::getpid());
+}
+
+/** Checks if a lock of the range would conflict with somebody else's one. Missing file isn't locked */
+bool is_range_locked(const std::wstring_view path, const usize offset, const usize size, const bool exclusive) {
+	auto at{ __unix_at(path) };
+	const int fd{ __unix_call_at(at, [&at] {
+		count_syscalls();
+		return ::openat(at.directory, at.c_str(), O_RDONLY | O_CLOEXEC);
+	}) };
+	if (fd < 0) return false;
+
+	auto range{ __unix_lock_range(exclusive ? F_WRLCK : F_RDLCK, offset, size) };
+	count_syscalls();
+	const bool locked{ ::fcntl(fd, __unix_get_lock, &range) == 0 && range.l_type != F_UNLCK };
+	count_syscalls();
+	::close(fd);
+	return locked;
+}
+
+/** Whether both are the same file, e.g. reached through a link, a bind mount or another association */
+bool __unix_same_file(const struct stat &left, const struct stat &right) noexcept {
+	return left.st_dev == right.st_dev && left.st_ino == right.st_ino;
+}
+
+/** Last resort copy through the user space. Continues from the current offsets of both files */
+bool __unix_copy_buffered(const int from, const int to) {
+	static constexpr usize buffer_size{ 128 * 1024 };
+	const auto buffer{ std::make_unique<char[]>(buffer_size) };
+
+	while (true) {
+		count_syscalls();
+		const auto count{ ::read(from, buffer.get(), buffer_size) };
+		if (count == 0) return true;
+		if (count < 0) {
+			if (errno == EINTR) continue;
+			return false;
+		}
+		if (!__unix_write_all(to, buffer.get(), static_cast<usize>(count))) return false;
+	}
+}
+
+// Implemented in platform/linux.inl and platform/macos.inl
+bool copy_file(const std::wstring_view from, const std::wstring_view to);
+
+bool move_file(const std::wstring_view from, const std::wstring_view to) {
+	auto source{ __unix_at(from) };
+	auto destination{ __unix_at(to) };
+	const auto rename = [&source, &destination] {
+		count_syscalls();
+		return ::renameat(source.directory, source.c_str(), destination.directory, destination.c_str());
+	};
+	// Either root could be gone
+	int renamed{ __unix_call_at(source, rename) };
+	if (renamed != 0 && __unix_reroot(destination)) [[unlikely]] renamed = rename();
+	if (renamed == 0) [[likely]] return true;
+	if (errno != EXDEV) return false;
+
+	if (!copy_file(from, to)) return false;
+	// The copy could have taken long enough for the source root to be removed
+	return __unix_call_at(source, [&source] {
+		count_syscalls();
+		return ::unlinkat(source.directory, source.c_str(), 0);
+	}) == 0;
+}
+
+template<class Callback>
+bool __unix_walk(const int directory_fd, std::wstring &relative, Callback &on_entry) {
+	count_syscalls(__unix_fdopendir_syscalls);
+	const auto dir{ ::fdopendir(directory_fd) };
+	if (dir == nullptr) {
+		count_syscalls();
+		::close(directory_fd);
+		return false;
+	}
+
+	bool success{ true };
+	const auto relative_size{ relative.size() };
+	count_syscalls(__unix_readdir_syscalls);
+	while (const auto entry{ ::readdir(dir) }) {
+		const std::string_view name{ entry->d_name };
+		if (name == "." || name == "..") continue;
+
+		if (entry->d_type == DT_LNK) continue;
+
+		bool is_directory{ entry->d_type == DT_DIR };
+		usize size{};
+		if (!is_directory) {
+			// Regular files need their size anyway; DT_UNKNOWN needs its real type
+			struct stat st;
+			count_syscalls();
+			if (::fstatat(::dirfd(dir), entry->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0) continue;
+			if (!S_ISDIR(st.st_mode) && !S_ISREG(st.st_mode)) continue;
+			is_directory = S_ISDIR(st.st_mode);
+			size = static_cast<usize>(st.st_size);
+		}
+
+		relative.resize(relative_size);
+		if (!relative.empty()) relative += filesystem::separator;
+		relative += filesystem::to_wide(name);
+		on_entry(std::wstring_view{ relative }, is_directory, size);
+
+		if (is_directory) {
+			count_syscalls();
+			// The entry could have been replaced by a link since readdir()
+			const int child{ ::openat(::dirfd(dir), entry->d_name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC) };
+			if (child < 0 || !__unix_walk(child, relative, on_entry)) {
+				success = false;
+				break;
+			}
+		}
+	}
+	relative.resize(relative_size);
+	count_syscalls();
+	::closedir(dir);
+	return success;
+}
+
+/**
+ * Visits every directory and regular file under @p root exactly once. Directories are visited
+ * before their content. The callback receives the path relative to @p root, the directory flag
+ * and the file size. Symbolic links are skipped, so a link to an ancestor can't loop the walk.
+ */
+template<class Callback>
+bool walk(const std::wstring_view root, Callback &&on_entry) {
+	auto at{ __unix_at(root) };
+	const int fd{ __unix_call_at(at, [&at] {
+		count_syscalls();
+		return ::openat(at.directory, at.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	}) };
+	if (fd < 0) return false;
+
+	std::wstring relative;
+	return __unix_walk(fd, relative, on_entry);
 }
 
+/** Reads until @p size bytes are read or the end of file is reached. Returns the amount or -1 */
+ssize_t __unix_read_all(const int fd, void *destination, const usize size, const off_t offset) {
+	usize total{};
+	while (total < size) {
+		count_syscalls();
+		const auto count{ ::pread(fd, static_cast<char *>(destination) + total, size - total,
+			offset + static_cast<off_t>(total))
+		};
+		if (count == 0) break;
+		if (count < 0) {
+			if (errno == EINTR) continue;
+			return -1;
+		}
+		total += static_cast<usize>(count);
+	}
+	return static_cast<ssize_t>(total);
+}
+
+/** Switches the descriptor back to the page cache, so the unaligned reads are accepted again */
+bool __unix_disable_direct([[maybe_unused]] const int fd) {
+#if defined(O_DIRECT)
+	count_syscalls();
+	const int flags{ ::fcntl(fd, F_GETFL) };
+	if (flags < 0) return false;
+	count_syscalls();
+	return ::fcntl(fd, F_SETFL, flags & ~O_DIRECT) == 0;
+#elif defined(F_NOCACHE)
+	count_syscalls();
+	return ::fcntl(fd, F_NOCACHE, 0) == 0;
+#else
+	return true;
+#endif // defined(O_DIRECT)
+}
+
+/**
+ * Direct I/O requires the file offset, the length and the memory to be aligned, so the range is
+ * read through an aligned bounce buffer. If the filesystem refuses direct I/O in the middle of
+ * reading (EINVAL), the rest is read through the page cache.
+ */
+std::optional<usize> __unix_read_direct(const int fd, char *destination, const usize offset,
+		const usize size, const usize alignment) {
+	static constexpr usize max_chunk_size{ 8 * 1024 * 1024 };
+
+	const auto begin{ offset & ~(alignment - 1) };
+	const auto end{ (offset + size + alignment - 1) & ~(alignment - 1) };
+	const auto chunk_size{ std::min(max_chunk_size, end - begin) };
+
+	void *memory{ nullptr };
+	if (::posix_memalign(&memory, alignment, chunk_size) != 0) return std::nullopt;
+	const std::unique_ptr<char, decltype(&std::free)> bounce{ static_cast<char *>(memory), &std::free };
+
+	usize copied{};
+	for (usize position{ begin }; copied < size; ) {
+		const auto length{ std::min(chunk_size, end - position) };
+		const auto count{ __unix_read_all(fd, bounce.get(), length, static_cast<off_t>(position)) };
+		if (count < 0) {
+			if (errno != EINVAL || !__unix_disable_direct(fd)) return std::nullopt;
+			const auto rest{ __unix_read_all(fd, destination + copied, size - copied,
+				static_cast<off_t>(offset + copied))
+			};
+			if (rest < 0) return std::nullopt;
+			return copied + static_cast<usize>(rest);
+		}
+
+		const auto skip{ offset + copied - position };
+		if (static_cast<usize>(count) <= skip) break;
+
+		const auto available{ std::min(static_cast<usize>(count) - skip, size - copied) };
+		std::memcpy(destination + copied, bounce.get() + skip, available);
+		copied += available;
+		position += static_cast<usize>(count);
+
+		if (static_cast<usize>(count) < length) break; // End of file
+	}
+	return copied;
+}
+
+/**
+ * Reads the [offset, offset + size) range of the file (clipped by the file size) into the memory
+ * returned by @p allocate(size). Returns the number of bytes read or std::nullopt on failure.
+ */
+template<class Allocate>
+std::optional<usize> read_file(const std::wstring_view path, const usize offset, usize size,
+		const filesystem::read_mode mode, Allocate &&allocate) {
+	auto at{ __unix_at(path) };
+	const auto open = [&at](const int flags) {
+		return __unix_call_at(at, [&at, flags] {
+			count_syscalls();
+			return ::openat(at.directory, at.c_str(), flags);
+		});
+	};
+
+	int fd{ -1 };
+	bool direct{ mode == filesystem::read_mode::direct };
+#if defined(O_DIRECT)
+	if (direct) {
+		// Not every filesystem supports O_DIRECT (tmpfs, some FUSE filesystems)
+		if (fd = open(O_RDONLY | O_CLOEXEC | O_DIRECT); fd < 0) direct = false;
+	}
+#endif // defined(O_DIRECT)
+	if (fd < 0) {
+		fd = open(O_RDONLY | O_CLOEXEC);
+	}
+	if (fd < 0) return std::nullopt;
+
+#if defined(F_NOCACHE)
+	if (direct) {
+		count_syscalls();
+		direct = ::fcntl(fd, F_NOCACHE, 1) == 0;
+	}
+#endif // defined(F_NOCACHE)
+
+	std::optional<usize> result;
+	count_syscalls();
+	if (struct stat st; ::fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+		const auto file_size{ static_cast<usize>(st.st_size) };
+		size = offset < file_size ? std::min(size, file_size - offset) : 0;
+
+		const auto destination{ static_cast<char *>(allocate(size)) };
+		if (size == 0) {
+			result = 0;
+		} else if (direct) {
+			// 4096 covers both 512 and 4K sector devices. Some filesystems want a larger block
+			const auto block{ static_cast<usize>(st.st_blksize) };
+			const bool power_of_two{ block != 0 && (block & (block - 1)) == 0 };
+			const auto alignment{ power_of_two ? std::clamp<usize>(block, 4096, 64 * 1024) : usize{ 4096 } };
+			result = __unix_read_direct(fd, destination, offset, size, alignment);
+		} else if (const auto count{ __unix_read_all(fd, destination, size, static_cast<off_t>(offset)) }; count >= 0) {
+			result = static_cast<usize>(count);
+		}
+	}
+
+	count_syscalls();
+	::close(fd);
+	return result;
+}
+
+/** Maps the whole file for reading. An empty file gives a successful empty mapping */
+bool map_file(const std::wstring_view path, const void *&data, usize &size) {
+	auto at{ __unix_at(path) };
+	const int fd{ __unix_call_at(at, [&at] {
+		count_syscalls();
+		return ::openat(at.directory, at.c_str(), O_RDONLY | O_CLOEXEC);
+	}) };
+	if (fd < 0) return false;
+
+	bool mapped{ false };
+	count_syscalls();
+	if (struct stat st; ::fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+		size = static_cast<usize>(st.st_size);
+		data = nullptr;
+		if (size == 0) {
+			mapped = true;
+		} else {
+			count_syscalls();
+			const auto mapping{ ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) };
+			mapped = mapping != MAP_FAILED;
+			if (mapped) data = mapping;
+		}
+	}
+	count_syscalls();
+	::close(fd);
+	return mapped;
+}
+
+void unmap_file(const void *data, const usize size) noexcept {
+	if (data == nullptr) return;
+	count_syscalls();
+	::munmap(const_cast<void *>(data), size);
+}
+
+/** Number of bytes of the [offset, offset + size) range which are in the page cache right now */
+usize __unix_resident_bytes(const int fd, const usize offset, const usize size) {
+	if (size == 0) return 0;
+
+	static const auto page{ static_cast<usize>(::sysconf(_SC_PAGESIZE)) };
+	const auto begin{ offset & ~(page - 1) };
+	const auto length{ offset + size - begin };
+
+	count_syscalls();
+	const auto mapping{ ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, static_cast<off_t>(begin)) };
+	if (mapping == MAP_FAILED) return 0;
+
+#if defined(GXZN_OS_FS_MACOS)
+	std::vector<char> pages((length + page - 1) / page);
+#else
+	std::vector<unsigned char> pages((length + page - 1) / page);
+#endif // defined(GXZN_OS_FS_MACOS)
+
+	usize resident{};
+	count_syscalls();
+	if (::mincore(mapping, length, pages.data()) == 0) {
+		for (usize i{}; i < pages.size(); ++i) {
+			if ((pages[i] & 1) == 0) continue;
+			const auto page_begin{ std::max(begin + i * page, offset) };
+			const auto page_end{ std::min(begin + (i + 1) * page, offset + size) };
+			resident += page_end - page_begin;
+		}
+	}
+	count_syscalls();
+	::munmap(mapping, length);
+	return resident;
+}
+
+/** Opens the file and clips the range by its size. Returns -1 if it's not a readable regular file */
+int __unix_open_range(const std::wstring_view path, const usize offset, usize &size) {
+	auto at{ __unix_at(path) };
+	const int fd{ __unix_call_at(at, [&at] {
+		count_syscalls();
+		return ::openat(at.directory, at.c_str(), O_RDONLY | O_CLOEXEC);
+	}) };
+	if (fd < 0) return -1;
+
+	count_syscalls();
+	if (struct stat st; ::fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+		const auto file_size{ static_cast<usize>(st.st_size) };
+		size = offset < file_size ? std::min(size, file_size - offset) : 0;
+		return fd;
+	}
+	count_syscalls();
+	::close(fd);
+	return -1;
+}
+
+// Implemented in platform/linux.inl and platform/macos.inl
+usize prefetch_file(const std::wstring_view path, const usize offset, usize size);
+usize evict_file(const std::wstring_view path, const usize offset, usize size);
+
 bool rmdir(const std::wstring_view path) {
-	return ::rmdir(filesystem::to_narrow(path).c_str()) == 0;
+	auto at{ __unix_at(path) };
+	const int removed{ __unix_call_at(at, [&at] {
+		count_syscalls();
+		return ::unlinkat(at.directory, at.c_str(), AT_REMOVEDIR);
+	}) };
+	if (removed != 0) return false;
+	__unix_roots.forget(path);
+	return true;
 }
 
 bool rmfile(const std::wstring_view path) {
-	return ::unlink(filesystem::to_narrow(path).c_str()) == 0;
+	auto at{ __unix_at(path) };
+	return __unix_call_at(at, [&at] {
+		count_syscalls();
+		return ::unlinkat(at.directory, at.c_str(), 0);
+	}) == 0;
+}
+
+/** The error of the last failed call */
+int last_error() noexcept {
+	return errno;
+}
+
+/** The last failed call was refused because the file exists */
+bool file_exists_error() noexcept {
+	return errno == EEXIST;
+}
+
+// strerror_r is either XSI (returns int) or GNU (returns the message) depending on the feature macros
+const char *__unix_strerror(const int result, const char *buffer) noexcept {
+	return result == 0 ? buffer : nullptr;
+}
+
+const char *__unix_strerror(const char *result, const char *) noexcept {
+	return result;
+}
+
+/** Writes at most @p capacity characters of the system message of @p code. Returns their number */
+template<class Char>
+usize system_message(const int code, Char *buffer, const usize capacity) noexcept {
+	char text[256]{};
+	const auto message{ __unix_strerror(::strerror_r(code, text, sizeof(text)), text) };
+	if (message == nullptr) return 0;
+
+	usize length{};
+	for (; length < capacity && message[length] != '\0'; ++length) {
+		buffer[length] = static_cast<Char>(static_cast<unsigned char>(message[length]));
+	}
+	return length;
 }
 
 } // namespace golxzn::os::details
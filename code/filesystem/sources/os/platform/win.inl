@@ -3,6 +3,10 @@
 #define WIN32_LEAN_AND_MEAN
 #endif // !defined(WIN32_LEAN_AND_MEAN)
 
+#include <atomic>
+#include <memory>
+#include <optional>
+
 #include <windows.h>
 #include <winerror.h>
 #include <stringapiset.h>
@@ -36,23 +40,48 @@ std::wstring cwd() {
 	return L"./";
 }
 
+/** Called by filesystem::associate. Windows resolves the full paths, so there's nothing to open */
+void associate_root(const std::wstring_view, const std::wstring_view) noexcept {}
+
 bool exists(const std::wstring_view path) {
+	count_syscalls();
 	const auto attributes{ GetFileAttributesW(path.data()) };
 	return attributes != INVALID_FILE_ATTRIBUTES;
 }
 
 bool is_file(const std::wstring_view path) {
+	count_syscalls();
 	const auto attributes{ GetFileAttributesW(path.data()) };
 	return (attributes != INVALID_FILE_ATTRIBUTES)
 		&& ((attributes & FILE_ATTRIBUTE_DIRECTORY) == 0);
 }
 
 bool is_directory(const std::wstring_view path) {
+	count_syscalls();
 	const auto attributes{ GetFileAttributesW(path.data()) };
 	return (attributes != INVALID_FILE_ATTRIBUTES)
 		&& ((attributes & FILE_ATTRIBUTE_DIRECTORY) != 0);
 }
 
+entry_type type_of(const std::wstring_view path) {
+	count_syscalls();
+	const auto attributes{ GetFileAttributesW(path.data()) };
+	if (attributes == INVALID_FILE_ATTRIBUTES) return entry_type::missing;
+	return (attributes & FILE_ATTRIBUTE_DIRECTORY) != 0 ? entry_type::directory : entry_type::file;
+}
+
+/**
+ * Changes made behind the back of the metadata cache. ReadDirectoryChangesW needs a pending
+ * request per directory, so nothing is watched and the cached results just expire.
+ */
+class change_watcher {
+public:
+	template<class Callback>
+	bool start(Callback &&) noexcept { return false; }
+	void watch(const std::wstring_view) noexcept {}
+	void stop() noexcept {}
+};
+
 std::vector<std::wstring> ls(const std::wstring_view path) {
 	static constexpr std::wstring_view current_directory{ L"." };
 	static constexpr std::wstring_view parent_directory{ L".." };
@@ -62,6 +91,7 @@ std::vector<std::wstring> ls(const std::wstring_view path) {
 
 	const auto pattern{ std::wstring{ path } + L"\\*" };
 	WIN32_FIND_DATAW found;
+	count_syscalls();
 	HANDLE iterator{ FindFirstFileW(pattern.data(), &found) };
 
 	if (iterator != INVALID_HANDLE_VALUE) {
@@ -72,23 +102,584 @@ std::vector<std::wstring> ls(const std::wstring_view path) {
 			if (name != current_directory && name != parent_directory) {
 				entries.emplace_back(name);
 			}
+			count_syscalls();
 		} while (FindNextFileW(iterator, &found));
 
+		count_syscalls();
 		FindClose(iterator);
 	}
 	return entries;
 }
 
 bool mkdir(const std::wstring_view path) {
+	count_syscalls();
 	return CreateDirectoryW(path.data(), nullptr) != FALSE;
 }
 
+/**
+ * Creates the directory and all missing parents. The leaf is tried first and the path is walked
+ * upward only when the parent is missing (ERROR_PATH_NOT_FOUND).
+ */
+bool make_directories(const std::wstring_view path) {
+	if (path.empty()) [[unlikely]] return false;
+
+	std::wstring native{ path };
+	count_syscalls();
+	if (CreateDirectoryW(native.c_str(), nullptr) != FALSE) [[likely]] return true;
+	if (GetLastError() == ERROR_ALREADY_EXISTS) return is_directory(native);
+	if (GetLastError() != ERROR_PATH_NOT_FOUND) return false;
+
+	std::vector<size_t> missing{ native.size() }; // End offsets of the components to create
+	for (size_t end{ native.size() }; ; ) {
+		const auto slash{ native.find_last_of(L"/\\", end - 1) };
+		if (slash == std::wstring::npos || slash == 0 || native[slash - 1] == L':') break;
+
+		native[slash] = L'\0';
+		count_syscalls();
+		const bool created{ CreateDirectoryW(native.c_str(), nullptr) != FALSE };
+		const auto status{ GetLastError() };
+		native[slash] = L'/';
+
+		if (created || status == ERROR_ALREADY_EXISTS) break;
+		if (status != ERROR_PATH_NOT_FOUND) return false;
+
+		missing.emplace_back(slash);
+		end = slash;
+	}
+
+	for (auto end{ std::rbegin(missing) }; end != std::rend(missing); ++end) {
+		const auto saved{ native[*end] };
+		native[*end] = L'\0';
+		count_syscalls();
+		const bool created{ CreateDirectoryW(native.c_str(), nullptr) != FALSE };
+		const auto status{ GetLastError() };
+		native[*end] = saved;
+
+		if (!created && status != ERROR_ALREADY_EXISTS) return false;
+	}
+	return true;
+}
+
+bool write_atomically(const std::wstring_view path, const void *data, const size_t size,
+		const filesystem::durability level) {
+	static std::atomic<size_t> counter{ 0 };
+
+	const std::wstring destination{ path };
+	std::wstring temporary;
+	HANDLE file{ INVALID_HANDLE_VALUE };
+	for (size_t attempt{}; file == INVALID_HANDLE_VALUE && attempt < 8; ++attempt) {
+		temporary = destination + L'.' + std::to_wstring(GetCurrentProcessId()) + L'.' +
+			std::to_wstring(counter.fetch_add(1, std::memory_order_relaxed)) + L".tmp";
+		count_syscalls();
+		file = CreateFileW(temporary.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_NEW,
+			FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE && GetLastError() != ERROR_FILE_EXISTS) return false;
+	}
+	if (file == INVALID_HANDLE_VALUE) return false;
+
+	bool success{ true };
+	for (auto begin{ static_cast<const char *>(data) }, end{ begin + size }; success && begin != end; ) {
+		const auto chunk{ static_cast<DWORD>(std::min<size_t>(end - begin, MAXDWORD)) };
+		DWORD written{};
+		count_syscalls();
+		success = WriteFile(file, begin, chunk, &written, nullptr) != FALSE;
+		begin += written;
+	}
+	if (success && level != filesystem::durability::none) {
+		count_syscalls();
+		success = FlushFileBuffers(file) != FALSE;
+	}
+	count_syscalls();
+	success = (CloseHandle(file) != FALSE) && success;
+
+	const DWORD flags{ MOVEFILE_REPLACE_EXISTING |
+		(level == filesystem::durability::full ? MOVEFILE_WRITE_THROUGH : 0ul)
+	};
+	if (success) {
+		count_syscalls();
+		success = MoveFileExW(temporary.c_str(), destination.c_str(), flags) != FALSE;
+	}
+	if (!success) {
+		count_syscalls();
+		DeleteFileW(temporary.c_str());
+		return false;
+	}
+	return true;
+}
+
+filesystem::error_code write_gathered(const std::wstring_view path, const data_view<byte> *pieces,
+		const size_t count, const bool append) {
+	const std::wstring native{ path };
+	count_syscalls();
+	HANDLE file{ CreateFileW(native.c_str(), append ? FILE_APPEND_DATA : GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+		append ? OPEN_ALWAYS : CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr)
+	};
+	if (file == INVALID_HANDLE_VALUE) return filesystem::error_code::open_failed;
+
+	// WriteFileGather needs FILE_FLAG_NO_BUFFERING and page-aligned pieces, so the pieces go one by one
+	bool success{ true };
+	for (size_t i{}; success && i < count; ++i) {
+		for (auto begin{ reinterpret_cast<const char *>(pieces[i].data()) }, end{ begin + pieces[i].size() };
+				success && begin != end; ) {
+			const auto chunk{ static_cast<DWORD>(std::min<size_t>(end - begin, MAXDWORD)) };
+			DWORD written{};
+			count_syscalls();
+			success = WriteFile(file, begin, chunk, &written, nullptr) != FALSE;
+			begin += written;
+		}
+	}
+	const auto saved_error{ GetLastError() };
+	count_syscalls();
+	CloseHandle(file);
+	SetLastError(saved_error);
+	return success ? filesystem::error_code::ok : filesystem::error_code::write_failed;
+}
+
+/**
+ * Creates the segment of filesystem::segment_writer with @p size bytes reserved. The file gets its
+ * final size right away, so the appends don't change it. Returns -1 if the file exists or on failure
+ */
+std::intptr_t open_segment(const std::wstring_view path, const size_t size) {
+	const std::wstring native{ path };
+	count_syscalls();
+	HANDLE file{ CreateFileW(native.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_NEW,
+		FILE_ATTRIBUTE_NORMAL, nullptr)
+	};
+	if (file == INVALID_HANDLE_VALUE) return -1;
+
+	FILE_ALLOCATION_INFO allocation{};
+	allocation.AllocationSize.QuadPart = static_cast<LONGLONG>(size);
+	FILE_END_OF_FILE_INFO end_of_file{};
+	end_of_file.EndOfFile.QuadPart = static_cast<LONGLONG>(size);
+
+	// The allocation is only a hint, the size is what keeps the appends from growing the file
+	count_syscalls();
+	SetFileInformationByHandle(file, FileAllocationInfo, &allocation, sizeof(allocation));
+	count_syscalls();
+	if (SetFileInformationByHandle(file, FileEndOfFileInfo, &end_of_file, sizeof(end_of_file)) == FALSE) {
+		const auto saved_error{ GetLastError() };
+		count_syscalls();
+		CloseHandle(file);
+		count_syscalls();
+		DeleteFileW(native.c_str());
+		SetLastError(saved_error);
+		return -1;
+	}
+	return reinterpret_cast<std::intptr_t>(file);
+}
+
+bool write_at(const std::intptr_t handle, size_t offset, const void *data, const size_t size) {
+	const auto file{ reinterpret_cast<HANDLE>(handle) };
+	for (auto begin{ static_cast<const char *>(data) }, end{ begin + size }; begin != end; ) {
+		OVERLAPPED position{};
+		position.Offset = static_cast<DWORD>(offset);
+		position.OffsetHigh = static_cast<DWORD>(static_cast<u64>(offset) >> 32);
+		const auto chunk{ static_cast<DWORD>(std::min<size_t>(end - begin, MAXDWORD)) };
+		DWORD written{};
+		count_syscalls();
+		if (WriteFile(file, begin, chunk, &written, &position) == FALSE) return false;
+		begin += written;
+		offset += written;
+	}
+	return true;
+}
+
+/** Cuts the file at @p used bytes, e.g. the unused preallocation of a segment, and closes it */
+bool close_truncated(const std::intptr_t handle, const size_t used) {
+	const auto file{ reinterpret_cast<HANDLE>(handle) };
+	FILE_END_OF_FILE_INFO end_of_file{};
+	end_of_file.EndOfFile.QuadPart = static_cast<LONGLONG>(used);
+
+	count_syscalls();
+	const bool truncated{ SetFileInformationByHandle(file, FileEndOfFileInfo, &end_of_file, sizeof(end_of_file)) != FALSE };
+	const auto saved_error{ GetLastError() };
+	count_syscalls();
+	const bool closed{ CloseHandle(file) != FALSE };
+	if (!truncated) SetLastError(saved_error);
+	return truncated && closed;
+}
+
+/** Opens the file for reading and writing, creating it if it's missing. Returns -1 on failure */
+std::intptr_t open_read_write(const std::wstring_view path) {
+	const std::wstring native{ path };
+	count_syscalls();
+	HANDLE file{ CreateFileW(native.c_str(), GENERIC_READ | GENERIC_WRITE,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr)
+	};
+	return file == INVALID_HANDLE_VALUE ? -1 : reinterpret_cast<std::intptr_t>(file);
+}
+
+/** The zero size locks up to the largest offset, like fcntl does */
+OVERLAPPED __win_lock_position(const size_t offset, const size_t size, DWORD &low, DWORD &high) noexcept {
+	const auto length{ size == 0 ? ~u64{} : static_cast<u64>(size) };
+	low = static_cast<DWORD>(length);
+	high = static_cast<DWORD>(length >> 32);
+
+	OVERLAPPED position{};
+	position.Offset = static_cast<DWORD>(offset);
+	position.OffsetHigh = static_cast<DWORD>(static_cast<u64>(offset) >> 32);
+	return position;
+}
+
+/** Without @p wait it fails at once if the range is busy, see range_busy_error() */
+bool lock_range(const std::intptr_t file, const size_t offset, const size_t size, const bool exclusive,
+		const bool wait) {
+	DWORD low{}, high{};
+	auto position{ __win_lock_position(offset, size, low, high) };
+	const DWORD flags{ (exclusive ? LOCKFILE_EXCLUSIVE_LOCK : 0ul) | (wait ? 0ul : LOCKFILE_FAIL_IMMEDIATELY) };
+	count_syscalls();
+	return LockFileEx(reinterpret_cast<HANDLE>(file), flags, 0, low, high, &position) != FALSE;
+}
+
+/** The last failed lock_range() was refused because someone else holds the range */
+bool range_busy_error() noexcept {
+	return GetLastError() == ERROR_LOCK_VIOLATION;
+}
+
+bool unlock_range(const std::intptr_t file, const size_t offset, const size_t size) {
+	DWORD low{}, high{};
+	auto position{ __win_lock_position(offset, size, low, high) };
+	count_syscalls();
+	return UnlockFileEx(reinterpret_cast<HANDLE>(file), 0, low, high, &position) != FALSE;
+}
+
+void close_file(const std::intptr_t file) noexcept {
+	count_syscalls();
+	CloseHandle(reinterpret_cast<HANDLE>(file));
+}
+
+bool sync_file(const std::intptr_t file) {
+	count_syscalls();
+	return FlushFileBuffers(reinterpret_cast<HANDLE>(file)) != FALSE;
+}
+
+size_t process_id() noexcept {
+	return static_cast<size_t>(GetCurrentProcessId());
+}
+
+/** Windows can't query the locks, so the range is locked and unlocked right away. Missing file isn't locked */
+bool is_range_locked(const std::wstring_view path, const size_t offset, const size_t size, const bool exclusive) {
+	const std::wstring native{ path };
+	count_syscalls();
+	HANDLE file{ CreateFileW(native.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr)
+	};
+	if (file == INVALID_HANDLE_VALUE) return false;
+
+	const auto handle{ reinterpret_cast<std::intptr_t>(file) };
+	const bool locked{ !lock_range(handle, offset, size, exclusive, false) };
+	if (!locked) unlock_range(handle, offset, size);
+	close_file(handle);
+	return locked;
+}
+
+/** The volume and the index of the file, which are the same for its every path. Empty if it can't be opened */
+std::optional<std::pair<DWORD, u64>> __win_file_id(const std::wstring &native) {
+	count_syscalls();
+	HANDLE file{ CreateFileW(native.c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+		OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, nullptr) };
+	if (file == INVALID_HANDLE_VALUE) return std::nullopt;
+
+	std::optional<std::pair<DWORD, u64>> id;
+	BY_HANDLE_FILE_INFORMATION information;
+	count_syscalls();
+	if (GetFileInformationByHandle(file, &information) != FALSE) {
+		id.emplace(information.dwVolumeSerialNumber,
+			(static_cast<u64>(information.nFileIndexHigh) << 32) | information.nFileIndexLow);
+	}
+	count_syscalls();
+	CloseHandle(file);
+	return id;
+}
+
+/** The volume and the index of the file, which are the same for its every path. Empty if it's missing */
+std::optional<std::pair<u64, u64>> file_id(const std::wstring_view path) {
+	if (const auto id{ __win_file_id(std::wstring{ path }) }; id.has_value()) {
+		return std::pair{ static_cast<u64>(id->first), id->second };
+	}
+	return std::nullopt;
+}
+
+bool copy_file(const std::wstring_view from, const std::wstring_view to) {
+	const std::wstring native_from{ from };
+	const std::wstring native_to{ to };
+	// Overwriting the destination would empty the source if it's the same file, so there's nothing to copy
+	if (const auto source{ __win_file_id(native_from) }; source.has_value() && source == __win_file_id(native_to)) {
+		return true;
+	}
+	// CopyFileExW clones the blocks itself on ReFS and Dev Drive volumes
+	count_syscalls();
+	return CopyFileExW(native_from.c_str(), native_to.c_str(), nullptr, nullptr, nullptr, 0) != FALSE;
+}
+
+bool move_file(const std::wstring_view from, const std::wstring_view to) {
+	const std::wstring native_from{ from };
+	const std::wstring native_to{ to };
+	count_syscalls();
+	return MoveFileExW(native_from.c_str(), native_to.c_str(),
+		MOVEFILE_REPLACE_EXISTING | MOVEFILE_COPY_ALLOWED) != FALSE;
+}
+
+template<class Callback>
+bool __win_walk(const std::wstring &root, std::wstring &relative, Callback &on_entry) {
+	const auto pattern{ relative.empty() ? root + L"\\*" : root + L'/' + relative + L"\\*" };
+	WIN32_FIND_DATAW found;
+	count_syscalls();
+	HANDLE iterator{ FindFirstFileW(pattern.data(), &found) };
+	if (iterator == INVALID_HANDLE_VALUE) return false;
+
+	bool success{ true };
+	const auto relative_size{ relative.size() };
+	do {
+		const std::wstring_view name{ found.cFileName };
+		if (name == L"." || name == L"..") continue;
+		if ((found.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0) continue;
+
+		const bool is_directory{ (found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0 };
+		const auto size{ (static_cast<size_t>(found.nFileSizeHigh) << 32) | found.nFileSizeLow };
+
+		relative.resize(relative_size);
+		if (!relative.empty()) relative += L'/';
+		relative += name;
+		on_entry(std::wstring_view{ relative }, is_directory, is_directory ? size_t{} : size);
+
+		if (is_directory && !__win_walk(root, relative, on_entry)) {
+			success = false;
+			break;
+		}
+		count_syscalls();
+	} while (FindNextFileW(iterator, &found));
+
+	relative.resize(relative_size);
+	count_syscalls();
+	FindClose(iterator);
+	return success;
+}
+
+/**
+ * Visits every directory and file under @p root exactly once. Directories are visited before
+ * their content. The callback receives the path relative to @p root, the directory flag and the
+ * file size. Links and junctions are skipped, so a link to an ancestor can't loop the walk.
+ */
+template<class Callback>
+bool walk(const std::wstring_view root, Callback &&on_entry) {
+	const std::wstring native_root{ root };
+	std::wstring relative;
+	return __win_walk(native_root, relative, on_entry);
+}
+
+/** Reads until @p size bytes are read or the end of file is reached */
+std::optional<size_t> __win_read_all(HANDLE file, char *destination, const size_t size, const size_t offset) {
+	size_t total{};
+	while (total < size) {
+		OVERLAPPED position{};
+		position.Offset = static_cast<DWORD>((offset + total) & 0xFFFFFFFFull);
+		position.OffsetHigh = static_cast<DWORD>((offset + total) >> 32);
+
+		const auto chunk{ static_cast<DWORD>(std::min<size_t>(size - total, 0x40000000ull)) };
+		DWORD count{};
+		count_syscalls();
+		if (ReadFile(file, destination + total, chunk, &count, &position) == FALSE) {
+			if (GetLastError() == ERROR_HANDLE_EOF) break;
+			return std::nullopt;
+		}
+		if (count == 0) break;
+		total += count;
+	}
+	return total;
+}
+
+/**
+ * Reads the [offset, offset + size) range of the file (clipped by the file size) into the memory
+ * returned by @p allocate(size). Returns the number of bytes read or std::nullopt on failure.
+ * FILE_FLAG_NO_BUFFERING requires sector aligned offsets, lengths and memory, so the direct mode
+ * reads through an aligned bounce buffer.
+ */
+template<class Allocate>
+std::optional<size_t> read_file(const std::wstring_view path, const size_t offset, size_t size,
+		const filesystem::read_mode mode, Allocate &&allocate) {
+	static constexpr size_t alignment{ 4096 };
+	static constexpr size_t max_chunk_size{ 8 * 1024 * 1024 };
+
+	const std::wstring native{ path };
+	const auto open = [&native](const DWORD flags) {
+		count_syscalls();
+		return CreateFileW(native.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | flags, nullptr);
+	};
+
+	bool direct{ mode == filesystem::read_mode::direct };
+	HANDLE file{ direct ? open(FILE_FLAG_NO_BUFFERING) : INVALID_HANDLE_VALUE };
+	if (file == INVALID_HANDLE_VALUE) {
+		direct = false;
+		file = open(FILE_FLAG_SEQUENTIAL_SCAN);
+	}
+	if (file == INVALID_HANDLE_VALUE) return std::nullopt;
+
+	std::optional<size_t> result;
+	count_syscalls();
+	if (LARGE_INTEGER file_size; GetFileSizeEx(file, &file_size) != FALSE) {
+		const auto length{ static_cast<size_t>(file_size.QuadPart) };
+		size = offset < length ? std::min(size, length - offset) : 0;
+
+		const auto destination{ static_cast<char *>(allocate(size)) };
+		if (size == 0) {
+			result = 0;
+		} else if (!direct) {
+			result = __win_read_all(file, destination, size, offset);
+		} else {
+			const auto begin{ offset & ~(alignment - 1) };
+			const auto end{ (offset + size + alignment - 1) & ~(alignment - 1) };
+			const auto chunk_size{ std::min(max_chunk_size, end - begin) };
+			const std::unique_ptr<char, decltype(&_aligned_free)> bounce{
+				static_cast<char *>(_aligned_malloc(chunk_size, alignment)), &_aligned_free
+			};
+
+			size_t copied{};
+			bool failed{ bounce == nullptr };
+			for (size_t position{ begin }; !failed && copied < size; ) {
+				const auto chunk{ std::min(chunk_size, end - position) };
+				const auto count{ __win_read_all(file, bounce.get(), chunk, position) };
+				if (!count.has_value()) {
+					failed = true;
+					break;
+				}
+
+				const auto skip{ offset + copied - position };
+				if (*count <= skip) break;
+
+				const auto available{ std::min(*count - skip, size - copied) };
+				std::memcpy(destination + copied, bounce.get() + skip, available);
+				copied += available;
+				position += *count;
+				if (*count < chunk) break;
+			}
+			if (!failed) result = copied;
+		}
+	}
+
+	count_syscalls();
+	CloseHandle(file);
+	return result;
+}
+
+/**
+ * Maps the whole file for reading. The view keeps the mapping object alive, so both handles are
+ * closed right away. An empty file gives a successful empty mapping.
+ */
+bool map_file(const std::wstring_view path, const void *&data, size_t &size) {
+	const std::wstring native{ path };
+	count_syscalls();
+	HANDLE file{ CreateFileW(native.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr) };
+	if (file == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER file_size;
+	count_syscalls();
+	if (GetFileSizeEx(file, &file_size) == FALSE) {
+		count_syscalls();
+		CloseHandle(file);
+		return false;
+	}
+	size = static_cast<size_t>(file_size.QuadPart);
+	data = nullptr;
+	if (size == 0) {
+		count_syscalls();
+		CloseHandle(file);
+		return true;
+	}
+
+	count_syscalls();
+	HANDLE mapping{ CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr) };
+	count_syscalls();
+	CloseHandle(file);
+	if (mapping == nullptr) return false;
+
+	count_syscalls();
+	data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	count_syscalls();
+	CloseHandle(mapping);
+	return data != nullptr;
+}
+
+void unmap_file(const void *data, const size_t) noexcept {
+	if (data == nullptr) return;
+	count_syscalls();
+	UnmapViewOfFile(data);
+}
+
+/**
+ * Windows has no read-ahead hint for a file range, so the range is read through the cache
+ * manager. Returns the number of bytes read.
+ */
+size_t prefetch_file(const std::wstring_view path, const size_t offset, size_t size) {
+	static constexpr size_t chunk_size{ 1024 * 1024 };
+
+	const std::wstring native{ path };
+	count_syscalls();
+	HANDLE file{ CreateFileW(native.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr) };
+	if (file == INVALID_HANDLE_VALUE) return 0;
+
+	size_t warmed{};
+	count_syscalls();
+	if (LARGE_INTEGER file_size; GetFileSizeEx(file, &file_size) != FALSE) {
+		const auto length{ static_cast<size_t>(file_size.QuadPart) };
+		size = offset < length ? std::min(size, length - offset) : 0;
+
+		const auto buffer{ std::make_unique<char[]>(std::min(chunk_size, size)) };
+		while (warmed < size) {
+			const auto count{ __win_read_all(file, buffer.get(), std::min(chunk_size, size - warmed), offset + warmed) };
+			if (!count.has_value() || *count == 0) break;
+			warmed += *count;
+		}
+	}
+	count_syscalls();
+	CloseHandle(file);
+	return warmed;
+}
+
+/** Windows has no way to drop the cached pages of a single file */
+size_t evict_file(const std::wstring_view, const size_t, size_t) {
+	return 0;
+}
+
 bool rmdir(const std::wstring_view path) {
+	count_syscalls();
 	return RemoveDirectoryW(path.data()) != FALSE;
 }
 
 bool rmfile(const std::wstring_view path) {
+	count_syscalls();
 	return DeleteFileW(path.data()) != FALSE;
 }
 
+/** The error of the last failed call */
+int last_error() noexcept {
+	return static_cast<int>(GetLastError());
+}
+
+/** The last failed call was refused because the file exists */
+bool file_exists_error() noexcept {
+	const auto code{ GetLastError() };
+	return code == ERROR_FILE_EXISTS || code == ERROR_ALREADY_EXISTS;
+}
+
+/** Writes at most @p capacity characters of the system message of @p code. Returns their number */
+template<class Char>
+size_t system_message(const int code, Char *buffer, const size_t capacity) noexcept {
+	static constexpr DWORD flags{ FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS };
+	DWORD length{};
+	if constexpr (std::is_same_v<Char, wchar_t>) {
+		length = FormatMessageW(flags, nullptr, static_cast<DWORD>(code), 0, buffer, static_cast<DWORD>(capacity), nullptr);
+	} else {
+		length = FormatMessageA(flags, nullptr, static_cast<DWORD>(code), 0, buffer, static_cast<DWORD>(capacity), nullptr);
+	}
+	// The system messages end with ".\r\n"
+	while (length > 0 && (buffer[length - 1] == '\r' || buffer[length - 1] == '\n' || buffer[length - 1] == '.')) {
+		--length;
+	}
+	return length;
+}
+
 } // namespace golxzn::os::details
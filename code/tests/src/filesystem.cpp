@@ -2,6 +2,13 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/benchmark/catch_benchmark.hpp>
 
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <filesystem>
+
 #include <golxzn/os/filesystem.hpp>
 
 #define b(x) static_cast<gxzn::os::byte>(x)
@@ -32,13 +39,13 @@ TEST_CASE("filesystem", "[filesystem][filesystem]") {
 		static constexpr auto testdir{ "user://testdir" };
 
 		if (const auto status{ gxzn::os::fs::make_directory(testdir) }; status.has_error()) {
-			INFO("Make '" << testdir << "' error: " << gxzn::os::fs::to_narrow(status.message));
+			INFO("Make '" << testdir << "' error: " << gxzn::os::fs::to_narrow(status.message()));
 			REQUIRE_FALSE(status.has_error());
 			REQUIRE(gxzn::os::fs::exists(testdir));
 		}
 
 		if (const auto status{ gxzn::os::fs::remove_directory(testdir) }; status.has_error()) {
-			INFO("Remove '" << testdir << "' error: " << gxzn::os::fs::to_narrow(status.message));
+			INFO("Remove '" << testdir << "' error: " << gxzn::os::fs::to_narrow(status.message()));
 			REQUIRE_FALSE(status.has_error());
 			REQUIRE_FALSE(gxzn::os::fs::exists(testdir));
 		}
@@ -57,18 +64,416 @@ TEST_CASE("filesystem", "[filesystem][filesystem]") {
 		};
 		for (const auto &file : test_files) {
 			const auto status{ gxzn::os::fs::write_binary(file, content) };
-			INFO("Make file '" << file << "' error: " << gxzn::os::fs::to_narrow(status.message));
+			INFO("Make file '" << file << "' error: " << gxzn::os::fs::to_narrow(status.message()));
 			REQUIRE_FALSE(status.has_error());
 			REQUIRE(gxzn::os::fs::exists(file));
 		}
 
 		const auto recursively_remove_status{ gxzn::os::fs::remove(testdir) };
 		INFO("Remove recursively '" << testdir << "' error: " \
-			<< gxzn::os::fs::to_narrow(recursively_remove_status.message));
+			<< gxzn::os::fs::to_narrow(recursively_remove_status.message()));
 		REQUIRE_FALSE(recursively_remove_status.has_error());
 		REQUIRE_FALSE(gxzn::os::fs::exists(testdir));
 	}
 
+	SECTION("make_directory nested & cached parents") {
+		static constexpr auto testdir{ "user://nested" };
+		static constexpr auto deep_dir{ "user://nested/a/b/c/d" };
+		static constexpr auto deep_file{ "user://nested/a/b/c/d/e/file.bin" };
+		static constexpr std::initializer_list<gxzn::os::byte> content{ b(0xC0), b(0xFF), b(0xEE) };
+
+		REQUIRE_FALSE(gxzn::os::fs::make_directory(deep_dir).has_error());
+		REQUIRE(gxzn::os::fs::is_directory(deep_dir));
+		REQUIRE_FALSE(gxzn::os::fs::make_directory(deep_dir).has_error());
+
+		REQUIRE_FALSE(gxzn::os::fs::write_binary(deep_file, content).has_error());
+		REQUIRE(gxzn::os::fs::make_directory(deep_file).has_error());
+
+		// The parent is removed and written again, so a cached parent must not be trusted blindly
+		REQUIRE_FALSE(gxzn::os::fs::remove(testdir).has_error());
+		REQUIRE_FALSE(gxzn::os::fs::write_binary(deep_file, content).has_error());
+		REQUIRE(gxzn::os::fs::is_file(deep_file));
+
+		REQUIRE_FALSE(gxzn::os::fs::remove(testdir).has_error());
+		REQUIRE_FALSE(gxzn::os::fs::exists(testdir));
+	}
+
+	SECTION("association roots") {
+		using gxzn::os::fs;
+		static constexpr auto testdir{ "user://roots" };
+		static constexpr std::initializer_list<gxzn::os::byte> content{ b(0xAB), b(0xCD) };
+		const std::wstring user{ fs::get_association("user://") };
+
+		REQUIRE_FALSE(fs::make_directory("user://roots/first").has_error());
+		REQUIRE_FALSE(fs::make_directory("user://roots/second").has_error());
+
+		fs::associate(L"roots://", user + L"/roots/first");
+		REQUIRE_FALSE(fs::write_binary("roots://nested/file.bin", content).has_error());
+		REQUIRE(fs::is_file("user://roots/first/nested/file.bin"));
+
+		// Associating the protocol again replaces its open root
+		fs::associate(L"roots://", user + L"/roots/second");
+		REQUIRE_FALSE(fs::exists("roots://nested/file.bin"));
+		REQUIRE_FALSE(fs::write_binary("roots://nested/file.bin", content).has_error());
+		REQUIRE(fs::is_file("user://roots/second/nested/file.bin"));
+
+		// The removed root is opened again once it's created
+		REQUIRE_FALSE(fs::remove("user://roots/second").has_error());
+		REQUIRE_FALSE(fs::make_directory("roots://").has_error());
+		REQUIRE_FALSE(fs::write_binary("roots://file.bin", content).has_error());
+		REQUIRE(fs::read_binary("user://roots/second/file.bin") == std::vector<gxzn::os::byte>{ content });
+
+#if !defined(GXZN_OS_FS_WINDOWS)
+		// Removed by someone else, as `rm -rf` does. The first call which fails under it replaces the root
+		const auto root{ fs::to_narrow(user + L"/roots/second") };
+		const auto remove_root = [&root] {
+			REQUIRE(std::remove((root + "/file.bin").c_str()) == 0);
+			REQUIRE(std::remove(root.c_str()) == 0);
+		};
+		remove_root();
+		REQUIRE_FALSE(fs::exists("roots://file.bin"));
+		REQUIRE_FALSE(fs::write_binary("roots://file.bin", content).has_error());
+		REQUIRE(fs::read_binary("user://roots/second/file.bin") == std::vector<gxzn::os::byte>{ content });
+
+		remove_root();
+		REQUIRE_FALSE(fs::make_directory("roots://nested/deeper").has_error());
+		REQUIRE(fs::is_directory("user://roots/second/nested/deeper"));
+#endif // !defined(GXZN_OS_FS_WINDOWS)
+
+		REQUIRE_FALSE(fs::remove(testdir).has_error());
+	}
+
+	SECTION("metadata cache") {
+		using gxzn::os::fs;
+		static constexpr auto testdir{ "user://metadata" };
+		static constexpr auto file{ "user://metadata/override.bin" };
+		static constexpr std::initializer_list<gxzn::os::byte> content{ b(0x01), b(0x02) };
+		const auto native{ fs::to_narrow(fs::resolve(L"user://metadata/external.bin")) };
+
+		REQUIRE_FALSE(fs::make_directory(testdir).has_error());
+		fs::enable_metadata_cache(std::chrono::hours{ 1 });
+		REQUIRE(fs::is_caching_metadata());
+
+		// The library's own changes drop the cached results
+		REQUIRE_FALSE(fs::exists(file));
+		REQUIRE_FALSE(fs::write_binary(file, content).has_error());
+		REQUIRE(fs::is_file(file));
+		REQUIRE_FALSE(fs::remove_file(file).has_error());
+		REQUIRE_FALSE(fs::exists(file));
+		REQUIRE_FALSE(fs::make_directory("user://metadata/nested/deeper").has_error());
+		REQUIRE(fs::is_directory("user://metadata/nested"));
+		REQUIRE_FALSE(fs::make_directory("user://metadata/nested").has_error());
+
+		// Changes made behind the library's back
+		REQUIRE_FALSE(fs::exists("user://metadata/external.bin"));
+		{ std::ofstream external{ native, std::ios::binary }; external << 'x'; }
+		fs::invalidate_metadata("user://metadata");
+		REQUIRE(fs::is_file("user://metadata/external.bin"));
+
+#if defined(GXZN_OS_FS_LINUX)
+		// inotify drops the result without any help
+		REQUIRE(std::remove(native.c_str()) == 0);
+		bool removed{ false };
+		for (int attempt{}; attempt < 200 && !removed; ++attempt) {
+			removed = !fs::exists("user://metadata/external.bin");
+			if (!removed) std::this_thread::sleep_for(std::chrono::milliseconds{ 10 });
+		}
+		REQUIRE(removed);
+#endif // defined(GXZN_OS_FS_LINUX)
+
+		fs::disable_metadata_cache();
+		REQUIRE_FALSE(fs::is_caching_metadata());
+		REQUIRE_FALSE(fs::remove(testdir).has_error());
+		REQUIRE_FALSE(fs::exists(testdir));
+	}
+
+	SECTION("copy_file & move_file") {
+		static constexpr auto testdir{ "user://copy_move" };
+		static constexpr auto copy{ "user://copy_move/copies/test.bin" };
+		static constexpr auto moved{ "user://copy_move/moved/test.bin" };
+
+		const auto original{ gxzn::os::fs::read_binary("res://test.bin") };
+
+		REQUIRE(gxzn::os::fs::copy_file("res://nonexisfile.bin", copy).has_error());
+		REQUIRE(gxzn::os::fs::copy_file("res://", copy).has_error());
+
+		if (const auto status{ gxzn::os::fs::copy_file("res://test.bin", copy) }; status.has_error()) {
+			INFO("Copy error: " << gxzn::os::fs::to_narrow(status.message()));
+			REQUIRE_FALSE(status.has_error());
+		}
+		REQUIRE(gxzn::os::fs::read_binary(copy) == original);
+
+		// Copying over an existing file replaces its content
+		REQUIRE_FALSE(gxzn::os::fs::write_text(copy, std::string_view{ "garbage which is longer" }).has_error());
+		REQUIRE_FALSE(gxzn::os::fs::copy_file("res://test.bin", copy).has_error());
+		REQUIRE(gxzn::os::fs::read_binary(copy) == original);
+
+		if (const auto status{ gxzn::os::fs::move_file(copy, moved) }; status.has_error()) {
+			INFO("Move error: " << gxzn::os::fs::to_narrow(status.message()));
+			REQUIRE_FALSE(status.has_error());
+		}
+		REQUIRE_FALSE(gxzn::os::fs::exists(copy));
+		REQUIRE(gxzn::os::fs::read_binary(moved) == original);
+
+		// The same file through another path is left as it is instead of being truncated
+		const auto native = [](const std::string_view path) {
+			return std::filesystem::path{ gxzn::os::fs::resolve(gxzn::os::fs::to_wide(path)) };
+		};
+		static constexpr auto hard_link{ "user://copy_move/moved/hard_link.bin" };
+		std::filesystem::create_hard_link(native(moved), native(hard_link));
+		REQUIRE_FALSE(gxzn::os::fs::copy_file(moved, hard_link).has_error());
+		REQUIRE(gxzn::os::fs::read_binary(moved) == original);
+
+#if !defined(GXZN_OS_FS_WINDOWS)
+		std::filesystem::create_directory_symlink(native("user://copy_move/moved"), native("user://copy_move/linked"));
+		gxzn::os::fs::associate(L"linked://", gxzn::os::fs::resolve(L"user://copy_move/linked"));
+		REQUIRE_FALSE(gxzn::os::fs::copy_file(moved, "linked://test.bin").has_error());
+		REQUIRE(gxzn::os::fs::read_binary(moved) == original);
+		REQUIRE(std::filesystem::remove(native("user://copy_move/linked")));
+#endif // !defined(GXZN_OS_FS_WINDOWS)
+
+		REQUIRE_FALSE(gxzn::os::fs::remove(testdir).has_error());
+	}
+
+	SECTION("copy_directory") {
+		static constexpr auto source{ "user://copy_tree_source" };
+		static constexpr auto destination{ "user://copy_tree_destination" };
+		static constexpr std::initializer_list<std::string_view> test_files{
+			"a.txt", "b/c.txt", "b/d/e.txt", "f/g/h/i.txt", "f/j.txt",
+		};
+
+		for (const auto &file : test_files) {
+			const auto path{ gxzn::os::fs::join(source, file) };
+			REQUIRE_FALSE(gxzn::os::fs::write_text(path, file).has_error());
+		}
+		REQUIRE_FALSE(gxzn::os::fs::make_directory("user://copy_tree_source/empty").has_error());
+
+		std::vector<gxzn::os::fs::copy_progress> reports;
+		const auto status{ gxzn::os::fs::copy_directory(source, destination,
+			[&reports](const auto &progress) { reports.push_back(progress); }, 3)
+		};
+		INFO("Copy error: " << gxzn::os::fs::to_narrow(status.message()));
+		REQUIRE_FALSE(status.has_error());
+
+		for (const auto &file : test_files) {
+			REQUIRE(gxzn::os::fs::read_text(gxzn::os::fs::join(destination, file)) == file);
+		}
+		REQUIRE(gxzn::os::fs::is_directory("user://copy_tree_destination/empty"));
+
+		REQUIRE_FALSE(reports.empty());
+		REQUIRE(reports.back().files_total == test_files.size());
+		REQUIRE(reports.back().files_copied == test_files.size());
+		REQUIRE(reports.back().bytes_copied == reports.back().bytes_total);
+
+		REQUIRE(gxzn::os::fs::copy_directory(source, "user://copy_tree_source/inside").has_error());
+		REQUIRE_FALSE(gxzn::os::fs::exists("user://copy_tree_source/inside"));
+
+#if !defined(GXZN_OS_FS_WINDOWS)
+		// Links are skipped, so a link to an ancestor neither loops the copy nor hides the source
+		const auto native = [](const std::string_view path) {
+			return std::filesystem::path{ gxzn::os::fs::resolve(gxzn::os::fs::to_wide(path)) };
+		};
+		std::filesystem::create_directory_symlink(native(source), native("user://copy_tree_source/b/loop"));
+		std::filesystem::create_directory_symlink(native("user://copy_tree_source/f"), native("user://copy_tree_link"));
+
+		REQUIRE_FALSE(gxzn::os::fs::remove(destination).has_error());
+		REQUIRE_FALSE(gxzn::os::fs::copy_directory(source, destination).has_error());
+		REQUIRE(gxzn::os::fs::read_text("user://copy_tree_destination/b/d/e.txt") == "b/d/e.txt");
+		REQUIRE_FALSE(gxzn::os::fs::exists("user://copy_tree_destination/b/loop"));
+
+		REQUIRE(gxzn::os::fs::copy_directory(source, "user://copy_tree_link/inside").has_error());
+		REQUIRE_FALSE(gxzn::os::fs::exists("user://copy_tree_source/f/inside"));
+		REQUIRE(std::filesystem::remove(native("user://copy_tree_link")));
+		REQUIRE(std::filesystem::remove(native("user://copy_tree_source/b/loop")));
+#endif // !defined(GXZN_OS_FS_WINDOWS)
+
+		REQUIRE_FALSE(gxzn::os::fs::remove(source).has_error());
+		REQUIRE_FALSE(gxzn::os::fs::remove(destination).has_error());
+	}
+
+	SECTION("prefetch & evict") {
+		const auto size{
+			gxzn::os::fs::read_binary("res://test.bin").size() + gxzn::os::fs::read_text("res://test.txt").size()
+		};
+
+		auto warmed{ gxzn::os::fs::prefetch({ L"res://test.bin", L"res://test.txt", L"res://nonexisfile.txt" }) };
+		REQUIRE(warmed.get() == size);
+
+		auto evicted{ gxzn::os::fs::evict({ "res://test.bin", "res://test.txt" }) };
+		REQUIRE(evicted.get() <= size);
+
+		REQUIRE(gxzn::os::fs::prefetch(std::vector<std::wstring>{}).get() == 0);
+		REQUIRE(gxzn::os::fs::prefetch({ "res://test.bin", "res://test.txt" }).get() <= size);
+
+		// The paths are resolved when the request is made, not when the workers get to it
+		// Read first, so the whole file is cached whatever the readahead does
+		const auto cached{ gxzn::os::fs::read_binary("res://test.bin").size() };
+		gxzn::os::fs::associate(L"prefetched://", std::wstring{ gxzn::os::fs::get_association(L"res://") });
+		auto resolved{ gxzn::os::fs::prefetch({ L"prefetched://test.bin" }) };
+		gxzn::os::fs::associate(L"prefetched://", std::wstring{ gxzn::os::fs::get_association(L"user://") });
+		REQUIRE(resolved.get() == cached);
+
+		// Just written and flushed, so the whole file is in the page cache until it's evicted
+		static constexpr std::wstring_view written{ L"user://prefetch.bin" };
+		const std::vector<gxzn::os::byte> content(3 * 4096 + 123, static_cast<gxzn::os::byte>(7));
+		REQUIRE_FALSE(gxzn::os::fs::write_binary_atomic(written, content).has_error());
+		REQUIRE(gxzn::os::fs::prefetch({ written }).get() == content.size());
+#if defined(GXZN_OS_FS_LINUX)
+		REQUIRE(gxzn::os::fs::evict({ written }).get() == content.size());
+#endif // defined(GXZN_OS_FS_LINUX)
+		REQUIRE_FALSE(gxzn::os::fs::remove_file(written).has_error());
+	}
+
+	SECTION("access trace") {
+		REQUIRE_FALSE(gxzn::os::fs::is_tracing());
+		REQUIRE_FALSE(gxzn::os::fs::stop_trace("user://trace.bin"));
+
+		gxzn::os::fs::start_trace();
+		REQUIRE(gxzn::os::fs::is_tracing());
+		REQUIRE(gxzn::os::fs::read_binary("res://test.bin").size() == 10);
+		REQUIRE(gxzn::os::fs::read_text("res://test.txt", 7, 5) == "world");
+		REQUIRE(gxzn::os::fs::read_binary("res://test.bin").size() == 10);
+		REQUIRE(gxzn::os::fs::read_text("res://nonexisfile.txt").empty());
+		REQUIRE(gxzn::os::fs::stop_trace("user://trace.bin"));
+		REQUIRE_FALSE(gxzn::os::fs::is_tracing());
+
+		// The whole test.bin and 5 bytes of test.txt, both read just now. The repeated read is recorded once
+		REQUIRE(gxzn::os::fs::replay_trace("user://trace.bin").get() == 15);
+
+		const auto trace{ gxzn::os::fs::read_binary("user://trace.bin") };
+		REQUIRE(gxzn::os::fs::write_binary("user://truncated_trace.bin",
+			gxzn::os::details::data_view<std::byte>{ std::begin(trace), std::prev(std::end(trace), 3) }));
+		REQUIRE(gxzn::os::fs::replay_trace("user://truncated_trace.bin").get() == 10); // test.txt record is cut
+
+		REQUIRE(gxzn::os::fs::replay_trace("user://nonexistent_trace.bin").get() == 0);
+		REQUIRE(gxzn::os::fs::write_text("user://trace.bin", "not a trace"));
+		REQUIRE(gxzn::os::fs::replay_trace("user://trace.bin").get() == 0);
+
+		REQUIRE(gxzn::os::fs::remove("user://trace.bin"));
+		REQUIRE(gxzn::os::fs::remove("user://truncated_trace.bin"));
+	}
+
+#if defined(GXZN_OS_FS_STATISTICS)
+	SECTION("I/O statistics") {
+		using gxzn::os::fs;
+		const auto index = [](const fs::io_operation operation) { return static_cast<size_t>(operation); };
+
+		fs::reset_stats();
+		REQUIRE(fs::read_binary("res://test.bin").size() == 10);
+		REQUIRE(fs::read_binary("res://nonexisfile.bin").empty());
+		REQUIRE_FALSE(fs::write_text("user://stats/stats.txt", std::string_view{ "stats" }).has_error());
+		size_t text_size{};
+		std::thread{ [&text_size] { text_size = fs::read_text("res://test.txt").size(); } }.join();
+		REQUIRE(text_size == 13);
+
+		const auto stats{ fs::stats() };
+		const auto &read{ stats.at(L"res://")[index(fs::io_operation::read)] };
+		REQUIRE(read.calls == 3);
+		REQUIRE(read.errors == 1);
+		REQUIRE(read.bytes_read == 23);
+		REQUIRE(read.syscalls >= 3);
+		REQUIRE(std::accumulate(std::begin(read.latency), std::end(read.latency), uint64_t{}) == read.calls);
+
+		const auto &user{ stats.at(L"user://") };
+		REQUIRE(user[index(fs::io_operation::write)].calls == 1);
+		REQUIRE(user[index(fs::io_operation::write)].bytes_written == 5);
+		REQUIRE(user[index(fs::io_operation::make_directory)].calls == 0); // Nested in write_text
+
+		REQUIRE_FALSE(fs::remove("user://stats").has_error());
+		fs::reset_stats();
+		for (const auto &[protocol, operations] : fs::stats()) {
+			for (const auto &operation : operations) {
+				REQUIRE(operation.calls == 0);
+				REQUIRE(operation.bytes_written == 0);
+			}
+		}
+
+#if defined(GXZN_OS_FS_LINUX)
+		// At least openat, fstat, pread and close for the file. The missing one stops earlier, the exact
+		// sequence is left to the platform layer
+		const auto read_syscalls = [&index] {
+			return fs::stats().at(L"res://")[index(fs::io_operation::read)].syscalls;
+		};
+		REQUIRE(fs::read_binary("res://test.bin").size() == 10);
+		const auto existing{ read_syscalls() };
+		REQUIRE(existing >= 4);
+		fs::reset_stats();
+		REQUIRE(fs::read_binary("res://nonexisfile.bin").empty());
+		REQUIRE(read_syscalls() >= 1);
+		REQUIRE(read_syscalls() < existing);
+		fs::reset_stats();
+#endif // defined(GXZN_OS_FS_LINUX)
+	}
+#endif // defined(GXZN_OS_FS_STATISTICS)
+
+	SECTION("tracing") {
+		struct counting_sink final : gxzn::os::fs::trace_sink {
+			std::vector<std::string> begun;
+			std::vector<gxzn::os::fs::span> ended;
+
+			void begin(const gxzn::os::fs::span &call) noexcept override { begun.emplace_back(call.name); }
+			void end(const gxzn::os::fs::span &call) noexcept override { ended.push_back(call); }
+		} sink;
+
+		REQUIRE(gxzn::os::fs::get_trace_sink() == nullptr);
+		gxzn::os::fs::set_trace_sink(&sink);
+		REQUIRE(gxzn::os::fs::read_binary("res://test.bin").size() == 10);
+		REQUIRE(gxzn::os::fs::read_text("res://nonexisfile.txt").empty());
+		gxzn::os::fs::set_trace_sink(nullptr);
+		REQUIRE(gxzn::os::fs::read_binary("res://test.bin").size() == 10);
+
+		REQUIRE(sink.begun == std::vector<std::string>{ "read_binary", "read_text" });
+		REQUIRE(sink.ended.size() == 2);
+		REQUIRE(sink.ended[0].size == 10);
+		REQUIRE_FALSE(sink.ended[0].failed);
+		REQUIRE(sink.ended[0].end >= sink.ended[0].begin);
+		REQUIRE(sink.ended[1].failed);
+		REQUIRE(sink.ended[0].thread == sink.ended[1].thread);
+
+		gxzn::os::fs::chrome_trace_sink chrome;
+		gxzn::os::fs::set_trace_sink(&chrome);
+		REQUIRE_FALSE(gxzn::os::fs::write_text("user://traced/file.txt", std::string_view{ "traced" }).has_error());
+		REQUIRE_FALSE(gxzn::os::fs::remove_directory("user://traced").has_error());
+		gxzn::os::fs::set_trace_sink(nullptr);
+
+		REQUIRE_FALSE(chrome.save("user://trace.json").has_error());
+		const auto json{ gxzn::os::fs::read_text("user://trace.json") };
+		REQUIRE(json.rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0) == 0);
+		REQUIRE(json.find("\"name\":\"write_text\"") != std::string::npos);
+		REQUIRE(json.find("\"name\":\"make_directory\"") != std::string::npos);
+		REQUIRE(json.find("\"name\":\"remove_directory\"") != std::string::npos);
+		REQUIRE(json.find("\"path\":\"user://traced/file.txt\",\"size\":6") != std::string::npos);
+		REQUIRE_FALSE(gxzn::os::fs::remove("user://trace.json").has_error());
+	}
+
+	SECTION("errors") {
+		using gxzn::os::fs;
+		static_assert(!fs::OK.has_error());
+
+		const auto empty{ fs::remove_file(L"") };
+		REQUIRE(empty.has_error());
+		REQUIRE_FALSE(empty);
+		REQUIRE(empty.code == fs::error_code::empty_path);
+		REQUIRE(empty.message() == L"[filesystem::remove_file] Empty path");
+
+		// The parent is a file, so the system error is captured as well
+		REQUIRE_FALSE(fs::write_text("user://errors/file.txt", std::string_view{ "file" }).has_error());
+		const auto status{ fs::write_text("user://errors/file.txt/nested.txt", std::string_view{ "nested" }) };
+		REQUIRE(status.code == fs::error_code::path_is_file);
+		REQUIRE(status.system != 0);
+		INFO("Message: " << fs::to_narrow(status.message()));
+		REQUIRE(status.message().rfind(L"[filesystem::make_directory] Path is a file: ", 0) == 0);
+
+		char small[16];
+		REQUIRE(status.message(small, sizeof(small)) == sizeof(small) - 1);
+		REQUIRE(std::string_view{ small } == "[filesystem::ma");
+
+		wchar_t none[4]{ L'x' };
+		REQUIRE(fs::OK.message(none, std::size(none)) == 0);
+		REQUIRE(none[0] == L'\0');
+		REQUIRE_FALSE(fs::remove(L"user://errors").has_error());
+	}
+
 	SECTION("entries") {
 		const auto entries{ gxzn::os::fs::entries("res://") };
 		REQUIRE_FALSE(entries.empty());
@@ -29,7 +29,7 @@ TEST_CASE("filesystem", "[filesystem][initialization]") {
 
 	const auto error{ gxzn::os::fs::initialize(L"filesystem_tests") };
 	SECTION("Initialization") {
-		INFO("gxzn::os::fs::initialize: " << gxzn::os::fs::to_narrow(error.message));
+		INFO("gxzn::os::fs::initialize: " << gxzn::os::fs::to_narrow(error.message()));
 		REQUIRE_FALSE(error.has_error());
 	} // SECTION("Initialization")
 
@@ -56,7 +56,7 @@ TEST_CASE("filesystem", "[filesystem][initialization]") {
 		if (const auto status{ gxzn::os::fs::initialize(L"filesystem_tests", absolute_res_dir) }; status) {
 			INFO("gxzn::os::fs::initialize(L\"filesystem_tests\", " \
 				<< gxzn::os::fs::to_narrow(absolute_res_dir) << "): " \
-				<< gxzn::os::fs::to_narrow(status.message));
+				<< gxzn::os::fs::to_narrow(status.message()));
 			REQUIRE_FALSE(status.has_error());
 		}
 		if (const auto resources_dir{ gxzn::os::fs::assets_directory() }; true) {
@@ -67,7 +67,7 @@ TEST_CASE("filesystem", "[filesystem][initialization]") {
 
 		if (const auto status{ gxzn::os::fs::initialize(L"filesystem_tests", L"../../res") }; status) {
 			INFO("gxzn::os::fs::initialize(L\"filesystem_tests\", L\"../../res\"): " \
-				<< gxzn::os::fs::to_narrow(status.message));
+				<< gxzn::os::fs::to_narrow(status.message()));
 			REQUIRE_FALSE(status.has_error());
 		}
 		if (const auto res_dir{ gxzn::os::fs::assets_directory() }; true) {
@@ -1,3 +1,5 @@
+#include <vector>
+#include <algorithm>
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/benchmark/catch_benchmark.hpp>
@@ -43,6 +45,11 @@ TEST_CASE("filesystem", "[filesystem][path manipulation]") {
 			{ L"/./Hello world/./how\\..\\lol\\..\\..\\../"sv,            L"/"sv },
 			{ L"/Hello world/how\\..\\lol\\.\\kek/"sv,                    L"/Hello world/lol/kek"sv },
 			{ L"////how\\..\\lol\\.\\kek/"sv,                             L"/lol/kek"sv },
+			{ L"relative/path"sv,                                         L"/relative/path"sv },
+			{ L"C:relative"sv,                                            L"C:/relative"sv },
+			{ L":colon\\first"sv,                                         L"/:colon/first"sv },
+			{ L"   "sv,                                                   L""sv },
+			{ L"/already/normalized/path/with/enough/components.txt"sv,   L"/already/normalized/path/with/enough/components.txt"sv },
 		};
 
 		for (const auto [from, to] : tests) {
@@ -50,6 +57,99 @@ TEST_CASE("filesystem", "[filesystem][path manipulation]") {
 				"' to '" << gxzn::os::fs::to_narrow(to) << "'");
 			INFO("Actual result: '" << gxzn::os::fs::to_narrow(gxzn::os::fs::normalize(from)) << "'");
 			REQUIRE(gxzn::os::fs::normalize(from) == to);
+
+			std::wstring in_place{ from };
+			gxzn::os::fs::normalize(in_place);
+			REQUIRE(in_place == to);
+
+			std::vector<wchar_t> buffer(from.size() + 2, L'x');
+			const auto length{ gxzn::os::fs::normalize(from, buffer.data(), buffer.size()) };
+			REQUIRE(std::wstring_view{ buffer.data(), length } == to);
+			REQUIRE(buffer[length] == L'\0');
+
+			std::copy(std::begin(from), std::end(from), std::begin(buffer));
+			const std::wstring_view same_buffer{ buffer.data(), from.size() };
+			REQUIRE(std::wstring_view{ buffer.data(), gxzn::os::fs::normalize(same_buffer, buffer.data(), buffer.size()) } == to);
+
+			std::string narrow{ gxzn::os::fs::to_narrow(from) };
+			gxzn::os::fs::normalize(narrow);
+			REQUIRE(narrow == gxzn::os::fs::to_narrow(to));
 		}
+
+		wchar_t small[4];
+		REQUIRE(gxzn::os::fs::normalize(L"/a/b", small, std::size(small)) == std::wstring_view::npos);
 	} // SECTION("normalize")
-}
\ No newline at end of file
+
+	SECTION("path_buffer") {
+		using gxzn::os::fs;
+
+		fs::path_buffer path{ L"res://" };
+		REQUIRE(path.is_inline());
+		REQUIRE(path.view() == L"res://");
+		REQUIRE(path.c_str()[path.size()] == L'\0');
+
+		fs::join(path, L"/textures\\..\\models/hero.obj");
+		fs::normalize(path);
+		REQUIRE(path == fs::normalize(fs::join(std::wstring_view{ L"res://" }, L"/textures\\..\\models/hero.obj")));
+
+		fs::parent_directory(path);
+		REQUIRE(path == L"/res:/models");
+
+		fs::resolve(L"res://models/hero.obj", path);
+		REQUIRE(path == fs::resolve(L"res://models/hero.obj"));
+		REQUIRE(path.is_inline());
+
+		const std::wstring long_path(fs::path_buffer::inline_capacity * 2, L'a');
+		fs::path_buffer spilled{ L"/" };
+		fs::join(spilled, long_path);
+		REQUIRE_FALSE(spilled.is_inline());
+		REQUIRE(spilled.size() == long_path.size() + 1);
+		REQUIRE(spilled.c_str()[spilled.size()] == L'\0');
+
+		const auto moved{ std::move(spilled) };
+		REQUIRE(moved.view().substr(1) == long_path);
+		REQUIRE(spilled.empty());
+
+		fs::path_buffer_narrow narrow{ "a\\b\\..\\c" };
+		fs::normalize(narrow);
+		REQUIRE(narrow == "/a/c");
+		fs::join(narrow, "d");
+		REQUIRE(narrow == "/a/c/d");
+		fs::parent_directory(narrow);
+		REQUIRE(narrow == "/a/c");
+	} // SECTION("path_buffer")
+
+	SECTION("literal_path") {
+		using gxzn::os::fs;
+
+		static constexpr fs::literal_path texture{ L"res://textures\\\\characters/./../models//hero.png  " };
+		static_assert(texture.path() == L"res://textures/models/hero.png");
+		static_assert(texture.protocol() == L"res://");
+		static_assert(texture.relative() == L"textures/models/hero.png");
+		static_assert(texture.parent() == L"res://textures/models");
+
+		static constexpr fs::literal_path narrow{ "user://saves/../slot.bin" };
+		static_assert(narrow.path() == L"user://slot.bin");
+		static_assert(narrow.parent() == L"user://");
+
+		static constexpr fs::literal_path root{ L"temp://" };
+		static_assert(root.relative().empty());
+
+		fs::path_buffer native;
+		fs::resolve(texture, native);
+		REQUIRE(native == fs::resolve(L"res://textures\\\\characters/./../models//hero.png  "));
+		fs::resolve(narrow, native);
+		REQUIRE(native == fs::resolve(L"user://saves/../slot.bin"));
+		fs::resolve(root, native);
+		REQUIRE(native == fs::resolve(L"temp://"));
+
+		// Declared constexpr, these don't compile
+		REQUIRE_THROWS_AS(fs::literal_path{ L"textures/hero.png" }, std::invalid_argument);
+		REQUIRE_THROWS_AS(fs::literal_path{ L"://hero.png" }, std::invalid_argument);
+		REQUIRE_THROWS_AS(fs::literal_path{ L"r/s://hero.png" }, std::invalid_argument);
+		REQUIRE_THROWS_AS(fs::literal_path{ L"res://../hero.png" }, std::invalid_argument);
+		REQUIRE_THROWS_AS(fs::literal_path{ L"res://a/../../hero.png" }, std::invalid_argument);
+		REQUIRE_THROWS_AS(fs::literal_path{ L"res://hero?.png" }, std::invalid_argument);
+		REQUIRE_THROWS_AS(fs::literal_path{ L"res://hero /a.png" }, std::invalid_argument);
+	} // SECTION("literal_path")
+}
@@ -1,3 +1,5 @@
+#include <array>
+#include <thread>
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
@@ -58,10 +60,140 @@ TEST_CASE("filesystem", "[filesystem][read_write]") {
 		// BENCHMARK("Read res://test.txt") { return gxzn::os::fs::read_binary(path); };
 	}
 
+	SECTION("Read ranges of res://test.bin") {
+		static constexpr std::wstring_view path{ L"res://test.bin" };
+		using gxzn::os::fs;
+
+		const auto middle{ fs::read_binary(path, 2, 5) };
+		REQUIRE(middle.size() == 5);
+		REQUIRE(std::equal(std::begin(middle), std::end(middle), std::next(std::begin(expected_content), 2)));
+
+		REQUIRE(fs::read_binary(path, 8, 100).size() == 2);
+		REQUIRE(fs::read_binary(path, 100, 1).empty());
+		REQUIRE(fs::read_text(L"res://test.txt", 7, 5) == "world");
+	}
+
+	SECTION("Direct reads") {
+		using gxzn::os::fs;
+		REQUIRE(fs::read_binary(L"res://test.bin", fs::read_mode::direct) == fs::read_binary(L"res://test.bin"));
+		REQUIRE(fs::read_text(L"res://test.txt", fs::read_mode::direct) == "Hello, world!");
+
+		// Bigger than the alignment and the bounce buffer with odd boundaries
+		static constexpr std::wstring_view path{ L"user://direct.bin" };
+		std::vector<gxzn::os::byte> data(9 * 1024 * 1024 + 123);
+		for (size_t i{}; i < data.size(); ++i) data[i] = static_cast<gxzn::os::byte>(i * 31 + i / 4096);
+		REQUIRE_FALSE(fs::write_binary(path, data).has_error());
+
+		REQUIRE(fs::read_binary(path, fs::read_mode::direct) == data);
+
+		const auto range{ fs::read_binary(path, 4093, 8 * 1024 * 1024 + 17, fs::read_mode::direct) };
+		REQUIRE(range.size() == 8 * 1024 * 1024 + 17);
+		REQUIRE(std::equal(std::begin(range), std::end(range), std::next(std::begin(data), 4093)));
+
+		REQUIRE_FALSE(fs::remove_file(path).has_error());
+	}
+
+#if defined(GXZN_OS_FS_PMR)
+	SECTION("Read into a memory resource") {
+		using gxzn::os::fs;
+
+		// Both the content and the resolved path have to fit into the arena, nothing goes upstream
+		std::array<std::byte, 4096> buffer{};
+		std::pmr::monotonic_buffer_resource arena{ buffer.data(), buffer.size(), std::pmr::null_memory_resource() };
+		const auto in_arena = [&buffer](const void *pointer) {
+			const auto address{ static_cast<const std::byte *>(pointer) };
+			return address >= buffer.data() && address < buffer.data() + buffer.size();
+		};
+
+		const auto binary{ fs::read_binary(L"res://test.bin", &arena) };
+		REQUIRE(binary.size() == expected_content.size());
+		REQUIRE(std::equal(std::begin(binary), std::end(binary), std::begin(expected_content)));
+		REQUIRE(in_arena(binary.data()));
+
+		const auto text{ fs::read_text("res://test.txt", 7, 5, &arena) };
+		REQUIRE(text == "world");
+		REQUIRE(text.get_allocator().resource() == &arena);
+
+		REQUIRE(fs::read_binary(L"res://missing.bin", &arena).empty());
+		REQUIRE(fs::read_text(L"res://test.txt", nullptr) == "Hello, world!");
+	}
+#endif // defined(GXZN_OS_FS_PMR)
+
+	SECTION("Read by asset_id") {
+		using gxzn::os::fs;
+
+		static constexpr fs::asset_id id{ L"res://test.bin" };
+		static_assert(id.protocol() == L"res://");
+		static_assert(id.relative() == L"test.bin");
+		static_assert(id.hash() == fs::asset_id_narrow{ "res://test.bin" }.hash());
+		static_assert(id == fs::asset_id{ L"res://\\test.bin/" });
+		static_assert(id != fs::asset_id{ L"user://test.bin" });
+		static_assert(fs::asset_id_narrow{ "res://a\\b" } == fs::asset_id_narrow{ "res:///a//b/" });
+		static_assert(fs::asset_id_narrow{ "res://a/b" } != fs::asset_id_narrow{ "res://ab" });
+
+		const auto check = [] {
+			const auto content{ fs::read_binary(id) };
+			REQUIRE(content.size() == expected_content.size());
+			REQUIRE(std::equal(std::begin(content), std::end(content), std::begin(expected_content)));
+			REQUIRE(fs::read_text(fs::asset_id_narrow{ "res://test.txt" }) == "Hello, world!");
+			REQUIRE(fs::exists(id));
+			REQUIRE_FALSE(fs::exists(fs::asset_id{ L"res://missing.bin" }));
+		};
+
+		check(); // Resolved as usual
+		REQUIRE_FALSE(fs::build_index(L"res").has_error());
+		check(); // Found in the index
+		REQUIRE(fs::exists(fs::asset_id{ L"res://\\test.bin/" })); // The same indexed file
+		REQUIRE(fs::exists(fs::asset_id_narrow{ "res://\\test.bin/" }));
+#if defined(GXZN_OS_FS_STATISTICS)
+		fs::reset_stats();
+		REQUIRE(fs::read_binary(fs::asset_id_narrow{ "res://test.bin" }).size() == expected_content.size());
+		REQUIRE(fs::stats().at(L"res://")[static_cast<size_t>(fs::io_operation::read)].calls == 1);
+		fs::reset_stats();
+#endif // defined(GXZN_OS_FS_STATISTICS)
+		REQUIRE(fs::build_index(L"unknown://").code == fs::error_code::missing_protocol);
+
+		REQUIRE_FALSE(fs::make_directory(L"temp://asset_id").has_error());
+		REQUIRE_FALSE(fs::build_index("temp://").has_error());
+		static constexpr fs::asset_id created{ L"temp://asset_id/created.bin" };
+		REQUIRE_FALSE(fs::exists(created));
+		REQUIRE_FALSE(fs::write_binary(created.path(), expected_content).has_error());
+		REQUIRE(fs::exists(created)); // Created after the index was built
+		REQUIRE(fs::read_binary(created).size() == expected_content.size());
+		REQUIRE_FALSE(fs::remove(L"temp://asset_id").has_error());
+		REQUIRE_FALSE(fs::exists(created));
+
+		fs::drop_index(L"res://");
+		fs::drop_index(L"temp://");
+		check();
+	}
+
+	SECTION("Read and write by literal_path") {
+		using gxzn::os::fs;
+
+		static constexpr fs::literal_path source{ L"res://./test.bin" };
+		const auto content{ fs::read_binary(source) };
+		REQUIRE(content.size() == expected_content.size());
+		REQUIRE(std::equal(std::begin(content), std::end(content), std::begin(expected_content)));
+		REQUIRE(fs::read_text(fs::literal_path{ "res://test.txt" }) == "Hello, world!");
+		REQUIRE(fs::exists(source));
+
+		static constexpr fs::literal_path written{ L"temp://literal/nested/../written.bin" };
+		static constexpr fs::literal_path text{ "temp://literal.txt" };
+		REQUIRE_FALSE(fs::write_binary(written, content).has_error());
+		REQUIRE_FALSE(fs::write_text(text, "literal").has_error());
+		REQUIRE(fs::read_binary(L"temp://literal/written.bin").size() == content.size());
+		REQUIRE(fs::read_text(text) == "literal");
+
+		REQUIRE_FALSE(fs::remove(L"temp://literal").has_error());
+		REQUIRE_FALSE(fs::remove(text.path()).has_error());
+		REQUIRE_FALSE(fs::exists(written));
+	}
+
 	SECTION("Write user://write.bin") {
 		static constexpr std::wstring_view path{ L"user://write.bin" };
 		const auto status{ gxzn::os::fs::write_binary(path, expected_content) };
-		INFO("Status: " << gxzn::os::fs::to_narrow(status.message));
+		INFO("Status: " << gxzn::os::fs::to_narrow(status.message()));
 		REQUIRE_FALSE(status.has_error());
 
 		const auto content{ gxzn::os::fs::read_binary(path) };
@@ -71,6 +203,290 @@ TEST_CASE("filesystem", "[filesystem][read_write]") {
 
 		// BENCHMARK("Write user://write.bin") { return gxzn::os::fs::write_binary(path, expected_content); };
 	}
+
+	SECTION("Scatter-gather write user://gather.bin") {
+		static constexpr std::wstring_view path{ L"user://gather/gather.bin" };
+		const std::vector<gxzn::os::byte> content{ expected_content };
+		const gxzn::os::details::data_view<gxzn::os::byte> header{ content.data(), 3 };
+		const gxzn::os::details::data_view<gxzn::os::byte> empty{};
+		const gxzn::os::details::data_view<gxzn::os::byte> payload{ content.data() + 3, content.size() - 3 };
+
+		REQUIRE_FALSE(gxzn::os::fs::write_binary(path, { header, empty, payload }).has_error());
+		REQUIRE(gxzn::os::fs::read_binary(path) == content);
+
+		REQUIRE_FALSE(gxzn::os::fs::append_binary(path, { payload, header }).has_error());
+		auto appended{ content };
+		appended.insert(std::end(appended), std::begin(content) + 3, std::end(content));
+		appended.insert(std::end(appended), std::begin(content), std::begin(content) + 3);
+		REQUIRE(gxzn::os::fs::read_binary(path) == appended);
+
+		REQUIRE(gxzn::os::fs::write_binary(path, { empty, empty }).code == gxzn::os::fs::error_code::invalid_argument);
+
+		// More pieces than IOV_MAX (1024 on Linux), so writev is called in batches
+		std::vector<gxzn::os::byte> many(3000);
+		for (size_t i{}; i < many.size(); ++i) many[i] = static_cast<gxzn::os::byte>(i * 7);
+		std::vector<gxzn::os::details::data_view<gxzn::os::byte>> pieces;
+		for (size_t i{}; i < many.size(); ++i) {
+			pieces.emplace_back(many.data() + i, 1);
+			if (i % 100 == 0) pieces.push_back(empty);
+		}
+		REQUIRE_FALSE(gxzn::os::fs::write_binary(path, pieces).has_error());
+		REQUIRE(gxzn::os::fs::read_binary(path) == many);
+
+		REQUIRE_FALSE(gxzn::os::fs::append_binary("user://gather/gather.bin", pieces).has_error());
+		const auto twice{ gxzn::os::fs::read_binary(path) };
+		REQUIRE(twice.size() == 2 * many.size());
+		REQUIRE(std::equal(std::begin(many), std::end(many), std::begin(twice) + many.size()));
+		REQUIRE_FALSE(gxzn::os::fs::remove(L"user://gather").has_error());
+	}
+
+	SECTION("Delta write user://delta.bin") {
+		using gxzn::os::fs;
+		static constexpr std::wstring_view path{ L"user://delta/delta.bin" };
+		static constexpr gxzn::os::usize block{ 16 };
+
+		std::vector<gxzn::os::byte> content(block * 8);
+		for (size_t i{}; i < content.size(); ++i) content[i] = static_cast<gxzn::os::byte>(i);
+
+#if defined(GXZN_OS_FS_STATISTICS)
+		// Bytes written by the last write_delta
+		const auto written = [] {
+			const auto bytes{ fs::stats().at(L"user://")[static_cast<size_t>(fs::io_operation::write_delta)].bytes_written };
+			fs::reset_stats();
+			return bytes;
+		};
+		fs::reset_stats();
+#endif // defined(GXZN_OS_FS_STATISTICS)
+
+		REQUIRE_FALSE(fs::write_delta(path, content, fs::delta_mode::in_place, block).has_error());
+		REQUIRE(fs::read_binary(path) == content);
+#if defined(GXZN_OS_FS_STATISTICS)
+		REQUIRE(written() == content.size());
+#endif // defined(GXZN_OS_FS_STATISTICS)
+		REQUIRE_FALSE(fs::write_delta(path, content, fs::delta_mode::in_place, block).has_error());
+		REQUIRE(fs::read_binary(path) == content);
+#if defined(GXZN_OS_FS_STATISTICS)
+		REQUIRE(written() == 0);
+#endif // defined(GXZN_OS_FS_STATISTICS)
+
+		content[block * 3 + 5] = b(0xFF);
+		content[block * 7] = b(0xEE);
+		REQUIRE_FALSE(fs::write_delta(path, content, fs::delta_mode::in_place, block).has_error());
+		REQUIRE(fs::read_binary(path) == content);
+#if defined(GXZN_OS_FS_STATISTICS)
+		REQUIRE(written() == 2 * block);
+#endif // defined(GXZN_OS_FS_STATISTICS)
+
+		content.resize(block * 5 + 3);
+		REQUIRE_FALSE(fs::write_delta(path, content, fs::delta_mode::in_place, block).has_error());
+		REQUIRE(fs::read_binary(path) == content);
+
+		content.resize(block * 10, b(0xAB));
+		REQUIRE_FALSE(fs::write_delta(path, content, fs::delta_mode::atomic, block).has_error());
+		REQUIRE(fs::read_binary(path) == content);
+
+		content[0] = b(0x42);
+		content.resize(block * 2);
+#if defined(GXZN_OS_FS_STATISTICS)
+		fs::reset_stats();
+#endif // defined(GXZN_OS_FS_STATISTICS)
+		REQUIRE_FALSE(fs::write_delta(path, content, fs::delta_mode::atomic, block).has_error());
+		REQUIRE(fs::read_binary(path) == content);
+#if defined(GXZN_OS_FS_STATISTICS)
+		REQUIRE(written() == block); // Only the first block of the clone
+#endif // defined(GXZN_OS_FS_STATISTICS)
+		REQUIRE(fs::entries(L"user://delta").size() == 1);
+
+		REQUIRE(fs::write_delta(path, content, fs::delta_mode::in_place, 0).code
+			== fs::error_code::invalid_argument);
+		REQUIRE(fs::write_delta(L"delta.bin", content).has_error());
+		REQUIRE_FALSE(fs::remove(L"user://delta").has_error());
+	}
+
+	SECTION("Write-behind queue") {
+		using gxzn::os::fs;
+		static constexpr std::wstring_view save{ L"user://behind/save.txt" };
+		static constexpr std::wstring_view log{ L"user://behind/log.txt" };
+
+		fs::enable_write_behind(64);
+		REQUIRE(fs::is_writing_behind());
+
+		REQUIRE_FALSE(fs::write_text(save, std::string_view{ "first" }).has_error());
+		REQUIRE_FALSE(fs::write_text(save, std::string_view{ "second" }).has_error());
+		REQUIRE_FALSE(fs::append_text(save, std::string_view{ " third" }).has_error());
+		REQUIRE_FALSE(fs::flush().has_error());
+		REQUIRE(fs::read_text(save) == "second third");
+
+		// Much more than the limit, so the writers wait for the worker now and then
+		const std::string line(40, 'a');
+		for (int i{}; i < 100; ++i) {
+			REQUIRE_FALSE(fs::append_text(log, std::string_view{ line }).has_error());
+		}
+		const std::string large(1024, 'b');
+		REQUIRE_FALSE(fs::write_text(save, std::string_view{ large }).has_error());
+		REQUIRE_FALSE(fs::drain().has_error());
+		REQUIRE(fs::read_text(log).size() == line.size() * 100);
+		REQUIRE(fs::read_text(save) == large);
+
+		// A directory cannot be opened as a file, but it's found out only in background
+		REQUIRE_FALSE(fs::make_directory(L"user://behind/directory").has_error());
+		REQUIRE_FALSE(fs::write_text(L"user://behind/directory", std::string_view{ "lost" }).has_error());
+		REQUIRE(fs::flush().code == fs::error_code::open_failed);
+
+		const auto failures{ fs::take_write_failures() };
+		REQUIRE(failures.size() == 1);
+		REQUIRE(failures.front().path == fs::resolve(L"user://behind/directory"));
+		REQUIRE(fs::take_write_failures().empty());
+
+		REQUIRE_FALSE(fs::disable_write_behind().has_error());
+		REQUIRE_FALSE(fs::is_writing_behind());
+		REQUIRE_FALSE(fs::remove(L"user://behind").has_error());
+	}
+
+	SECTION("Segment writer") {
+		using gxzn::os::fs;
+		static constexpr std::wstring_view directory{ L"user://segments" };
+		const std::string record(30, 'r');
+
+		{
+			fs::segment_writer log{ L"user://segments/game.log", 64 };
+			REQUIRE_FALSE(log.is_open());
+			REQUIRE_FALSE(log.append_text(record).has_error());
+			REQUIRE_FALSE(log.append_text(record).has_error());
+			REQUIRE(log.segment() == 0);
+			REQUIRE(log.size() == 60);
+			// The segment has its final size from the beginning
+			REQUIRE(fs::read_text(log.segment_path()).size() == 64);
+
+			REQUIRE_FALSE(log.append_text(record).has_error());
+			REQUIRE(log.segment() == 1);
+			REQUIRE(fs::read_text(L"user://segments/game.log.000000") == record + record);
+
+			const std::string large(100, 'l');
+			REQUIRE_FALSE(log.append_text(large).has_error());
+			REQUIRE(log.segment() == 2);
+			REQUIRE_FALSE(log.close().has_error());
+			REQUIRE(fs::read_text(L"user://segments/game.log.000001") == record);
+			REQUIRE(fs::read_text(L"user://segments/game.log.000002") == large);
+		}
+
+		// The next writer continues after the existing segments
+		fs::segment_writer next{ "user://segments/game.log", 64 };
+		REQUIRE_FALSE(next.append_text(record).has_error());
+		REQUIRE(next.segment() == 3);
+		next = fs::segment_writer{};
+		REQUIRE(fs::read_text(L"user://segments/game.log.000003") == record);
+		REQUIRE(fs::entries(directory).size() == 4);
+
+		REQUIRE(fs::segment_writer{ L"segments/game.log" }.append_text(record).code == fs::error_code::missing_protocol);
+		REQUIRE_FALSE(fs::remove(directory).has_error());
+	}
+
+	SECTION("Byte-range locks") {
+		using gxzn::os::fs;
+		using namespace std::chrono_literals;
+		static constexpr std::wstring_view path{ L"user://locks/data.bin" };
+
+		fs::file_lock header;
+		REQUIRE_FALSE(fs::lock(path, header, 0, 16).has_error());
+		REQUIRE(header.is_locked());
+		REQUIRE(fs::is_file(path));
+		REQUIRE(fs::is_unlocked(path, 16, 16));
+
+		fs::file_lock body;
+		REQUIRE_FALSE(fs::try_lock(path, body, 16, 16).has_error());
+
+		// Both regions are written at once through their locks
+		const std::vector<gxzn::os::byte> content{ expected_content };
+		REQUIRE_FALSE(header.write(0, content).has_error());
+		REQUIRE_FALSE(body.write(16, content).has_error());
+		const auto written{ fs::read_binary(path) };
+		REQUIRE(written.size() == 16 + content.size());
+		REQUIRE(std::equal(std::begin(content), std::end(content), std::begin(written)));
+		REQUIRE(std::equal(std::begin(content), std::end(content), std::begin(written) + 16));
+
+		fs::file_lock readers[2];
+		REQUIRE_FALSE(fs::lock(path, readers[0], 32, 8, fs::lock_mode::shared).has_error());
+		REQUIRE_FALSE(fs::try_lock(path, readers[1], 32, 8, fs::lock_mode::shared).has_error());
+		REQUIRE_FALSE(fs::is_locked(path, 32, 8, fs::lock_mode::shared));
+
+#if !defined(GXZN_OS_FS_MACOS)
+		// The process-wide locks of MacOS don't conflict within the process
+		REQUIRE(fs::is_locked(path, 0, 16));
+		REQUIRE(fs::is_locked(path, 0, 0));
+		REQUIRE(fs::is_locked(path, 32, 8, fs::lock_mode::exclusive));
+
+		fs::file_lock overlapping;
+		REQUIRE(fs::try_lock(path, overlapping, 8, 16).code == fs::error_code::locked);
+		REQUIRE_FALSE(overlapping.is_locked());
+
+		const auto started{ std::chrono::steady_clock::now() };
+		REQUIRE(fs::lock(path, overlapping, 0, 8, fs::lock_mode::shared, 20ms).code == fs::error_code::locked);
+		REQUIRE(std::chrono::steady_clock::now() - started >= 20ms);
+
+		// The waiting lock gets the range once the holder releases it
+		fs::error waited;
+		std::thread waiter{ [&overlapping, &waited] { waited = fs::lock(path, overlapping, 0, 16); } };
+		std::this_thread::sleep_for(20ms);
+		REQUIRE_FALSE(fs::unlock(header).has_error());
+		waiter.join();
+		REQUIRE_FALSE(waited.has_error());
+		REQUIRE(overlapping.is_locked());
+
+		header = std::move(overlapping);
+		REQUIRE(header.is_locked());
+		REQUIRE_FALSE(overlapping.is_locked());
+#endif // !defined(GXZN_OS_FS_MACOS)
+
+		REQUIRE_FALSE(header.unlock().has_error());
+		REQUIRE_FALSE(body.unlock().has_error());
+		for (auto &reader : readers) REQUIRE_FALSE(reader.unlock().has_error());
+		REQUIRE(fs::is_unlocked(path));
+		REQUIRE_FALSE(fs::remove(L"user://locks").has_error());
+	}
+
+	SECTION("Atomic write user://atomic.bin") {
+		static constexpr std::wstring_view path{ L"user://atomic/atomic.bin" };
+		REQUIRE_FALSE(gxzn::os::fs::write_text_atomic(path, std::string_view{ "old content" }).has_error());
+
+		for (const auto level : { gxzn::os::fs::durability::none, gxzn::os::fs::durability::data,
+				gxzn::os::fs::durability::full }) {
+			const auto status{ gxzn::os::fs::write_binary_atomic(path, expected_content, level) };
+			INFO("Status: " << gxzn::os::fs::to_narrow(status.message()));
+			REQUIRE_FALSE(status.has_error());
+
+			const auto content{ gxzn::os::fs::read_binary(path) };
+			REQUIRE(content.size() == expected_content.size());
+			REQUIRE(std::equal(std::begin(content), std::end(content), std::begin(expected_content)));
+		}
+
+		// Only the destination file has to be left in the directory
+		REQUIRE(gxzn::os::fs::entries(L"user://atomic").size() == 1);
+		REQUIRE_FALSE(gxzn::os::fs::remove(L"user://atomic").has_error());
+	}
+
+	SECTION("Concurrent atomic writes with full durability") {
+		static constexpr size_t threads_count{ 8 };
+
+		std::vector<std::thread> threads;
+		std::vector<gxzn::os::fs::error> statuses(threads_count, gxzn::os::fs::OK);
+		for (size_t i{}; i < threads_count; ++i) {
+			threads.emplace_back([i, &statuses] {
+				const auto path{ "user://atomic/concurrent_" + std::to_string(i) + ".txt" };
+				statuses[i] = gxzn::os::fs::write_text_atomic(path, std::string_view{ path },
+					gxzn::os::fs::durability::full);
+			});
+		}
+		for (auto &thread : threads) thread.join();
+
+		for (size_t i{}; i < threads_count; ++i) {
+			const auto path{ "user://atomic/concurrent_" + std::to_string(i) + ".txt" };
+			INFO("Status: " << gxzn::os::fs::to_narrow(statuses[i].message()));
+			REQUIRE_FALSE(statuses[i].has_error());
+			REQUIRE(gxzn::os::fs::read_text(path) == path);
+		}
+		REQUIRE_FALSE(gxzn::os::fs::remove(L"user://atomic").has_error());
+	}
 }
 
 struct CustomResource {
@@ -81,6 +497,58 @@ struct CustomResource {
 	std::vector<gxzn::os::byte> data;
 };
 
+/** Decodes right from the mapped bytes */
+struct ViewResource {
+	explicit ViewResource(const gxzn::os::details::data_view<gxzn::os::byte> bytes)
+		: data{ std::begin(bytes), std::end(bytes) } {}
+
+	std::vector<gxzn::os::byte> data;
+};
+
+/** Keeps the mapping instead of a copy */
+struct MappedResource {
+	explicit MappedResource(gxzn::os::mapped_file &&file) noexcept : mapping{ std::move(file) } {}
+
+	gxzn::os::mapped_file mapping;
+};
+
+/** Tells where to read by the member */
+struct InPlaceResource {
+	gxzn::os::byte *load_destination(const gxzn::os::usize size) {
+		data.resize(size);
+		return data.data();
+	}
+
+	std::vector<gxzn::os::byte> data;
+};
+
+/** Tells where to read by loader_traits */
+struct TraitsResource {
+	std::vector<gxzn::os::byte> pixels;
+};
+
+/** Any container converts to data_view, so the view has to be chosen over the copy */
+template<>
+struct gxzn::os::loader_traits<ViewResource> {
+	static constexpr load_strategy strategy{ load_strategy::view };
+};
+
+template<>
+struct gxzn::os::loader_traits<TraitsResource> {
+	static constexpr load_strategy strategy{ load_strategy::in_place };
+
+	static byte *destination(TraitsResource &resource, const usize size) {
+		resource.pixels.resize(size);
+		return resource.pixels.data();
+	}
+};
+
+static_assert(gxzn::os::loader_traits<CustomResource>::strategy == gxzn::os::load_strategy::vector);
+static_assert(gxzn::os::loader_traits<ViewResource>::strategy == gxzn::os::load_strategy::view);
+static_assert(gxzn::os::loader_traits<MappedResource>::strategy == gxzn::os::load_strategy::mapping);
+static_assert(gxzn::os::loader_traits<InPlaceResource>::strategy == gxzn::os::load_strategy::in_place);
+static_assert(gxzn::os::details::default_load_strategy<ViewResource>() == gxzn::os::load_strategy::vector);
+
 TEST_CASE("filesystem", "[filesystem][read_write custom]") {
 	static constexpr std::string_view expected_text{ "custom" };
 	static constexpr std::initializer_list<gxzn::os::byte> expected_data{
@@ -133,4 +601,56 @@ TEST_CASE("filesystem", "[filesystem][read_write custom]") {
 		REQUIRE(res->text.size() == expected_text.size());
 		REQUIRE(res->text == expected_text);
 	}
-}
\ No newline at end of file
+
+	SECTION("Load custom resources by every strategy") {
+		using gxzn::os::fs;
+		const auto matches = [](const auto &content) {
+			return std::equal(std::begin(content), std::end(content), std::begin(expected_data), std::end(expected_data));
+		};
+
+		REQUIRE(matches(fs::read_binary<ViewResource>(L"res://custom.bin").data));
+		REQUIRE(matches(fs::read_binary<ViewResource>(L"res://custom.bin", fs::read_mode::direct).data));
+		REQUIRE(matches(fs::read_unique_binary<MappedResource>(L"res://custom.bin")->mapping));
+		REQUIRE(matches(fs::read_shared_binary<InPlaceResource>("res://custom.bin")->data));
+
+		REQUIRE(matches(fs::read_binary<TraitsResource>(L"res://custom.bin").pixels));
+
+		REQUIRE(fs::read_binary<MappedResource>(L"res://missing.bin").mapping.empty());
+		REQUIRE(fs::read_binary<InPlaceResource>(L"res://missing.bin").data.empty());
+
+		InPlaceResource resource;
+		REQUIRE_FALSE(fs::load_into(L"res://custom.bin", resource).has_error());
+		REQUIRE(matches(resource.data));
+		REQUIRE(fs::load_into("res://missing.bin", resource).has_error());
+		REQUIRE(fs::load_into(L"custom.bin", resource).code == fs::error_code::missing_protocol);
+	}
+
+	SECTION("Map and read into the caller's memory") {
+		using gxzn::os::fs;
+
+		auto mapping{ fs::map(L"res://custom.bin") };
+		REQUIRE(mapping.size() == expected_data.size());
+		REQUIRE(std::equal(std::begin(mapping), std::end(mapping), std::begin(expected_data)));
+
+		auto moved{ std::move(mapping) };
+		REQUIRE(mapping.empty());
+		REQUIRE(mapping.data() == nullptr);
+		REQUIRE(moved.size() == expected_data.size());
+		moved.reset();
+		REQUIRE(moved.empty());
+
+		std::array<gxzn::os::byte, 16> buffer{};
+		gxzn::os::usize requested{};
+		const auto status{ fs::read_into(L"res://custom.bin", [&](const gxzn::os::usize size) {
+			requested = size;
+			return buffer.data();
+		}) };
+		REQUIRE_FALSE(status.has_error());
+		REQUIRE(requested == expected_data.size());
+		REQUIRE(std::equal(std::begin(expected_data), std::end(expected_data), std::begin(buffer)));
+
+		REQUIRE(fs::read_into(L"res://missing.bin", [&](gxzn::os::usize) { return buffer.data(); }).code == fs::error_code::open_failed);
+		REQUIRE(fs::read_into(L"custom.bin", [&](gxzn::os::usize) { return buffer.data(); }).code == fs::error_code::missing_protocol);
+		REQUIRE_THROWS_AS(fs::map(L"custom.bin"), std::invalid_argument);
+	}
+}